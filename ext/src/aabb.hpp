@@ -21,6 +21,15 @@
  *
  *
  * Simple 2D Axis Aligned Bounding Box implementation.
+ *
+ * All tests are inline and noexcept. The ``*_unchecked`` variants skip input
+ * validation and are meant for native code that already guarantees valid
+ * input (e.g. the Quadtree). The validating constructor and
+ * ``split(x, y, q)`` are kept in aabb.cpp for the Python API.
+ *
+ * ``Box`` stores the same bounds as min/max edges. It is the representation
+ * used internally by spatial queries: edges don't need to be recomputed and
+ * the overlap test is four comparisons without branches.
  */
 
 #ifndef AABB_HPP
@@ -35,27 +44,141 @@ namespace tools {
         BL,
         BR
     };
+
+    class AABB;
+
+    struct Box {
+        constexpr Box() noexcept
+            : min_x(-1.0), min_y(-1.0), max_x(1.0), max_y(1.0) {}
+        constexpr Box(double _min_x, double _min_y, double _max_x,
+                      double _max_y) noexcept
+            : min_x(_min_x), min_y(_min_y), max_x(_max_x), max_y(_max_y) {}
+        explicit constexpr Box(const AABB& aabb) noexcept;
+
+        constexpr bool overlap(const Box& o) const noexcept {
+            return (min_x <= o.max_x) & (o.min_x <= max_x)
+                 & (min_y <= o.max_y) & (o.min_y <= max_y);
+        }
+        constexpr bool inside(const Box& o) const noexcept {
+            return (min_x <= o.min_x) & (o.max_x <= max_x)
+                 & (min_y <= o.min_y) & (o.max_y <= max_y);
+        }
+        constexpr bool inside(double x, double y) const noexcept {
+            return (min_x <= x) & (x <= max_x) & (min_y <= y) & (y <= max_y);
+        }
+        constexpr double center_x() const noexcept {
+            return (min_x + max_x) * 0.5;
+        }
+        constexpr double center_y() const noexcept {
+            return (min_y + max_y) * 0.5;
+        }
+
+        /**
+         * Box grown by ``dx``/``dy`` on every side.
+         */
+        constexpr Box grown(double dx, double dy) const noexcept {
+            return Box(min_x - dx, min_y - dy, max_x + dx, max_y + dy);
+        }
+
+        /**
+         * Returns the quadrant in which ``x`` and ``y`` lie. Does not check
+         * whether the point lies inside the bounds of this Box.
+         */
+        constexpr Quadrant find_quadrant(double x, double y) const noexcept {
+            return static_cast<Quadrant>((x < center_x() ? 0 : 1)
+                                         | (y < center_y() ? 0 : 2));
+        }
+
+        /**
+         * Quadrant ``q`` of this, split at the center.
+         */
+        constexpr Box quadrant(Quadrant q) const noexcept {
+            return Box((q & 1) ? center_x() : min_x,
+                       (q & 2) ? center_y() : min_y,
+                       (q & 1) ? max_x : center_x(),
+                       (q & 2) ? max_y : center_y());
+        }
+
+        double min_x, min_y, max_x, max_y;
+    };
+
     class AABB {
     public:
-        AABB();
+        struct Unchecked {};
+
+        constexpr AABB() noexcept : x(0.0), y(0.0), hw(1.0), hh(1.0) {}
         AABB(double _x, double _y, double _hw, double _hh);
+        constexpr AABB(double _x, double _y, double _hw, double _hh,
+                       Unchecked) noexcept
+            : x(_x), y(_y), hw(_hw), hh(_hh) {}
+        explicit constexpr AABB(const Box& b) noexcept
+            : x(b.min_x + (b.max_x - b.min_x) * 0.5),
+              y(b.min_y + (b.max_y - b.min_y) * 0.5),
+              hw((b.max_x - b.min_x) * 0.5), hh((b.max_y - b.min_y) * 0.5) {}
+
+        constexpr Box box() const noexcept {
+            return Box(x - hw, y - hh, x + hw, y + hh);
+        }
+
+        constexpr bool inside(const AABB& aabb) const noexcept {
+            return x - hw <= aabb.x - aabb.hw && x + hw >= aabb.x + aabb.hw
+                && y - hh <= aabb.y - aabb.hh && y + hh >= aabb.y + aabb.hh;
+        }
+        constexpr bool inside(double _x, double _y) const noexcept {
+            return x - hw <= _x && x + hw >= _x && y - hh <= _y && y + hh >= _y;
+        }
+        constexpr bool overlap(const AABB& aabb) const noexcept {
+            return box().overlap(aabb.box());
+        }
+        AABB split(double _x, double _y, Quadrant _q) const;
+        AABB split(Quadrant _q) const noexcept {
+            return split_unchecked(_q);
+        }
+
+        /**
+         * Quadrant ``_q`` of this, split at the center.
+         */
+        constexpr AABB split_unchecked(Quadrant _q) const noexcept {
+            return AABB(x + ((_q & 1) ? hw : -hw) / 2.0,
+                        y + ((_q & 2) ? hh : -hh) / 2.0,
+                        hw / 2.0, hh / 2.0, Unchecked());
+        }
 
-        bool inside(const AABB& aabb);
-        bool inside(double _x, double _y);
-        bool overlap(const AABB& aabb);
-        AABB split(Quadrant _q);
-        AABB split(double _x, double _y, Quadrant _q);
-        Quadrant find_quadrant(double _x, double _y);
+        /**
+         * Quadrant ``_q`` of this, split at ``_x/_y``, which must lie inside.
+         */
+        constexpr AABB split_unchecked(double _x, double _y,
+                                       Quadrant _q) const noexcept {
+            return AABB(
+                (_q & 1) ? (_x + (x + hw)) / 2.0 : ((x - hw) + _x) / 2.0,
+                (_q & 2) ? (_y + (y + hh)) / 2.0 : ((y - hh) + _y) / 2.0,
+                (_q & 1) ? ((x + hw) - _x) / 2.0 : (_x - (x - hw)) / 2.0,
+                (_q & 2) ? ((y + hh) - _y) / 2.0 : (_y - (y - hh)) / 2.0,
+                Unchecked());
+        }
+
+        /**
+         * Returns the quadrant in which ``_x`` and ``_y`` lie. Does not check
+         * whether the point lies inside the bounds of this AABB.
+         */
+        constexpr Quadrant find_quadrant(double _x, double _y) const noexcept {
+            return static_cast<Quadrant>((_x < x ? 0 : 1) | (_y < y ? 0 : 2));
+        }
 
-        bool operator==(const AABB& rhs) {
+        constexpr bool operator==(const AABB& rhs) const noexcept {
             return (x == rhs.x && y == rhs.y && hw == rhs.hw && hh == rhs.hh);
         }
-        bool operator!=(const AABB& rhs) {
+        constexpr bool operator!=(const AABB& rhs) const noexcept {
             return (x != rhs.x || y != rhs.y || hw != rhs.hw || hh != rhs.hh);
         }
 
         double x, y, hw, hh;
     };
+
+    constexpr Box::
+    Box(const AABB& aabb) noexcept
+        : min_x(aabb.x - aabb.hw), min_y(aabb.y - aabb.hh),
+          max_x(aabb.x + aabb.hw), max_y(aabb.y + aabb.hh) {}
 }  // namespace tools
 }  // namespace foolysh
 
@@ -38,6 +38,31 @@ AnimationData(){
     _ref_count = 1;
 }
 
+// AnimationDeleter
+
+/**
+ * Call the destructor and hand the storage back to the slab.
+ */
+void AnimationDeleter::
+operator()(AnimationBase* p) const {
+    if (slab == nullptr) {
+        delete p;
+        return;
+    }
+    p->~AnimationBase();
+    slab->deallocate(static_cast<void*>(p));
+}
+
+// AnimationPools
+
+/**
+ * The object slab uses one size class, large enough for all playable types.
+ */
+AnimationPools::
+AnimationPools()
+    : objects(std::max(sizeof(Interval),
+                       std::max(sizeof(Animation), sizeof(Sequence)))) {}
+
 // AnimationBase
 
 /**
@@ -59,7 +84,7 @@ step(const double dt, ActiveAnimationMap& aam) {
 /**
  * Retrieve a copy of the Animation. Needs to be overridden in subclasses.
  */
-std::unique_ptr<AnimationBase> AnimationBase::
+AnimationPtr AnimationBase::
 get_copy() {
     throw std::runtime_error("Cannot be called from AnimationBase class.");
 }
@@ -77,13 +102,12 @@ loop(const bool l) {
 // AnimationType Rule of 5
 
 /**
- * Default Constructor: Create a new AnimationData instance.
+ * Constructor: Create a new AnimationData instance in the pool of ``pools``.
  */
 AnimationType::
-AnimationType() {
-    _animation_id = AnimationData::_ad.insert(new AnimationData());
-    AnimationData::_ad[_animation_id]->animation_id = _animation_id;
-
+AnimationType(AnimationPools& pools) : AnimationBase(pools) {
+    _animation_id = _pools->data.insert();
+    _pools->data[_animation_id].animation_id = _animation_id;
 }
 
 /**
@@ -96,7 +120,7 @@ AnimationType::
         AnimationData& ad = _get_animation_data(_animation_id);
         if (ad._ref_count == 1) {
             /* If ours is the last reference, delete the AnimationData */
-            AnimationData::_ad.erase(_animation_id);
+            _pools->data.erase(_animation_id);
         }
         else {
             --ad._ref_count;
@@ -109,7 +133,7 @@ AnimationType::
  * the same AnimationData instance.
  */
 AnimationType::
-AnimationType(const AnimationType& other) {
+AnimationType(const AnimationType& other) : AnimationBase(*other._pools) {
     _animation_id = other._animation_id;
     AnimationData& ad = _get_animation_data(_animation_id);
     ++ad._ref_count;
@@ -119,7 +143,8 @@ AnimationType(const AnimationType& other) {
  * Move Constructor. Invalidates ``other``.
  */
 AnimationType::
-AnimationType(AnimationType&& other) noexcept {
+AnimationType(AnimationType&& other) noexcept
+    : AnimationBase(*other._pools) {
     _animation_id = other._animation_id;
     other._animation_id = -1;
 }
@@ -130,10 +155,11 @@ AnimationType(AnimationType&& other) noexcept {
  */
 AnimationType& AnimationType::
 operator=(const AnimationType& other) {
-    if (AnimationData::_ad.active(_animation_id)) {
+    if (_pools->data.active(_animation_id)) {
         AnimationData& ad = _get_animation_data(_animation_id);
         --ad._ref_count;
     }
+    _pools = other._pools;
     _animation_id = other._animation_id;
     AnimationData& ad = _get_animation_data(_animation_id);
     ++ad._ref_count;
@@ -145,10 +171,11 @@ operator=(const AnimationType& other) {
  */
 AnimationType& AnimationType::
 operator=(AnimationType&& other) noexcept {
-    if (AnimationData::_ad.active(_animation_id)) {
+    if (_pools->data.active(_animation_id)) {
         AnimationData& ad = _get_animation_data(_animation_id);
         --ad._ref_count;
     }
+    _pools = other._pools;
     _animation_id = other._animation_id;
     other._animation_id = -1;
     return *this;
@@ -509,10 +536,10 @@ node_id() {
  */
 AnimationData& AnimationType::
 _get_animation_data(const int animation_id) {
-    if (!AnimationData::_ad.active(animation_id)) {
+    if (!_pools->data.active(animation_id)) {
         throw std::logic_error("Tried to access invalid AnimationData");
     }
-    return *AnimationData::_ad[animation_id];
+    return _pools->data[animation_id];
 }
 
 
@@ -581,22 +608,20 @@ _update(const double prog) {
     AnimationData& ad = _get_animation_data(_animation_id);
     // position
     if (ad.pos.active) {
-		Vec2 v = Vec2(
-				(ad.pos.end - ad.pos.start) * prog + ad.pos.start);
+        const Vec2d v = tools::lerp(ad.pos.start, ad.pos.end, prog);
         if (ad.pos.relative_node) {
-            ad.node->set_pos(*ad.pos.relative_node, v);
+            ad.node->set_pos(*ad.pos.relative_node, v.x, v.y);
         }
         else {
-            ad.node->set_pos(v);
+            ad.node->set_pos(v.x, v.y);
         }
     }
 
     // rotation_center
     if (ad.center_pos.active) {
-		Vec2 v = Vec2(
-				(ad.center_pos.end - ad.center_pos.start) * prog
-				+ ad.center_pos.start);
-        ad.node->set_rotation_center(v);
+        const Vec2d v = tools::lerp(ad.center_pos.start, ad.center_pos.end,
+                                    prog);
+        ad.node->set_rotation_center(v.x, v.y);
     }
 
     // scale
@@ -640,10 +665,10 @@ _update(const double prog) {
 /**
  *
  */
-std::unique_ptr<AnimationBase> Interval::
+AnimationPtr Interval::
 get_copy() {
-    std::unique_ptr<Interval> ptr;
-    ptr.reset(new Interval());
+    AnimationPtr base = _pools->create<Interval>();
+    Interval* ptr = static_cast<Interval*>(base.get());
     AnimationData& ad = _get_animation_data(_animation_id);
     AnimationData& ptr_ad = ptr->_get_animation_data(ptr->_animation_id);
 
@@ -698,7 +723,7 @@ get_copy() {
     }
     ptr_ad.depth.active = ad.depth.active;
     ptr_ad.depth.has_start = ad.depth.has_start;
-    return std::move(ptr);
+    return base;
 }
 
 /**
@@ -784,7 +809,8 @@ reset() {
             throw std::logic_error("Position animation specified without "
                                    "speed");
         }
-        double tmp_d = (ad.pos.end - ad.pos.start).length() / ad.pos_speed;
+        double tmp_d = tools::length(ad.pos.end - ad.pos.start)
+                       / ad.pos_speed;
         ad.dur_pos = tmp_d;
         if (tmp_d > ad.duration) {
             ad.duration = tmp_d;
@@ -796,7 +822,7 @@ reset() {
             throw std::logic_error("Rotation center animation specified "
 								   "without speed");
         }
-        double tmp_d = (ad.center_pos.end - ad.center_pos.start).length()
+        double tmp_d = tools::length(ad.center_pos.end - ad.center_pos.start)
                        / ad.rotation_center_speed;
         ad.dur_center_pos = tmp_d;
         if (tmp_d > ad.duration) {
@@ -882,27 +908,27 @@ step(const double dt, ActiveAnimationMap& aam) {
 
     // position
     if (ad.pos.active) {
-        Vec2 p = (ad.pos.relative_node)
+        const Vec2d p = (ad.pos.relative_node)
                         ? ad.node->get_pos(*ad.pos.relative_node)
                         : ad.node->get_pos();
         if (p != ad.pos.end) {
             if (ad.playback_pos >= ad.dur_pos) {
                 if (ad.pos.relative_node) {
-                    ad.node->set_pos(*ad.pos.relative_node, ad.pos.end);
+                    ad.node->set_pos(*ad.pos.relative_node, ad.pos.end.x,
+                                     ad.pos.end.y);
                 }
                 else {
-                    ad.node->set_pos(ad.pos.end);
+                    ad.node->set_pos(ad.pos.end.x, ad.pos.end.y);
                 }
             }
             else {
                 double prog = lerp(ad.playback_pos, ad.dur_pos, ad.blend);
-				Vec2 v = Vec2((ad.pos.end - ad.pos.start)
-						* prog + ad.pos.start);
+                const Vec2d v = tools::lerp(ad.pos.start, ad.pos.end, prog);
                 if (ad.pos.relative_node) {
-                    ad.node->set_pos(*ad.pos.relative_node, v);
+                    ad.node->set_pos(*ad.pos.relative_node, v.x, v.y);
                 }
                 else {
-                    ad.node->set_pos(v);
+                    ad.node->set_pos(v.x, v.y);
                 }
             }
         }
@@ -910,18 +936,18 @@ step(const double dt, ActiveAnimationMap& aam) {
 
     // rotation_center
     if (ad.center_pos.active) {
-        Vec2 p = ad.node->get_rotation_center();
+        const Vec2d p = ad.node->get_rotation_center();
         if (p != ad.center_pos.end) {
             if (ad.playback_pos >= ad.dur_center_pos) {
-                ad.node->set_rotation_center(ad.center_pos.end);
+                ad.node->set_rotation_center(ad.center_pos.end.x,
+                                             ad.center_pos.end.y);
             }
             else {
                 double prog = lerp(ad.playback_pos, ad.dur_center_pos,
                     ad.blend);
-				Vec2 v = Vec2(
-						(ad.center_pos.end - ad.center_pos.start) * prog
-						+ ad.center_pos.start);
-                ad.node->set_rotation_center(v);
+                const Vec2d v = tools::lerp(ad.center_pos.start,
+                                            ad.center_pos.end, prog);
+                ad.node->set_rotation_center(v.x, v.y);
             }
         }
     }
@@ -1031,10 +1057,10 @@ step(const double dt, ActiveAnimationMap& aam) {
 /**
  *
  */
-std::unique_ptr<AnimationBase> Animation::
+AnimationPtr Animation::
 get_copy() {
-    std::unique_ptr<Animation> ptr;
-    ptr.reset(new Animation());
+    AnimationPtr base = _pools->create<Animation>();
+    Animation* ptr = static_cast<Animation*>(base.get());
     AnimationData& ad = _get_animation_data(_animation_id);
     AnimationData& ptr_ad = ptr->_get_animation_data(ptr->_animation_id);
 
@@ -1089,7 +1115,7 @@ get_copy() {
     }
     ptr_ad.depth.active = ad.depth.active;
     ptr_ad.depth.has_start = ad.depth.has_start;
-    return std::move(ptr);
+    return base;
 }
 
 /**
@@ -1126,7 +1152,7 @@ active_animations() {
  *
  */
 void Sequence::
-append(std::unique_ptr<AnimationBase>& a) {
+append(AnimationPtr& a) {
     _v.push_back(a->get_copy());
 
     // Make sure no sequences with loop = true are appended.
@@ -1188,10 +1214,9 @@ loop(const bool l) {
 /**
  *
  */
-std::unique_ptr<AnimationBase> Sequence::
+AnimationPtr Sequence::
 get_copy() {
-    std::unique_ptr<AnimationBase> ptr;
-    ptr.reset(new Sequence());
+    AnimationPtr ptr = _pools->create<Sequence>();
     Sequence& sq = static_cast<Sequence&>(*ptr);
     for (auto it = _v.begin(); it != _v.end(); ++it) {
         sq.append(*it);
@@ -1207,7 +1232,7 @@ get_copy() {
 int AnimationManager::
 new_interval() {
     ++_max_anim;
-    _anims[_max_anim] = std::unique_ptr<AnimationBase>(new Interval());
+    _anims[_max_anim] = _pools.create<Interval>();
     _anim_status[_max_anim] = 0;
     return _max_anim;
 }
@@ -1218,7 +1243,7 @@ new_interval() {
 int AnimationManager::
 new_animation() {
     ++_max_anim;
-    _anims[_max_anim] = std::unique_ptr<AnimationBase>(new Animation());
+    _anims[_max_anim] = _pools.create<Animation>();
     _anim_status[_max_anim] = 0;
     return _max_anim;
 }
@@ -1229,7 +1254,7 @@ new_animation() {
 int AnimationManager::
 new_sequence() {
     ++_max_anim;
-    _anims[_max_anim] = std::unique_ptr<AnimationBase>(new Sequence());
+    _anims[_max_anim] = _pools.create<Sequence>();
     _anim_status[_max_anim] = 0;
     return _max_anim;
 }
@@ -1270,7 +1295,7 @@ get_sequence(const int s_id) {
 /**
  * Return a AnimationBase unique_ptr reference for the specified id.
  */
-std::unique_ptr<AnimationBase>& AnimationManager::
+AnimationPtr& AnimationManager::
 get_animation_base_ptr(const int i_id) {
     if (_anims.find(i_id) == _anims.end()) {
         throw std::range_error("Specified id is not an active Interval");
@@ -1574,6 +1599,19 @@ animate(const double dt) {
 	}
 }
 
+/**
+ * Live and allocated slots of the pools backing this AnimationManager.
+ */
+PoolStats AnimationManager::
+pool_stats() const {
+    PoolStats s;
+    s.data_size = _pools.data.range();
+    s.data_capacity = _pools.data.capacity();
+    s.object_size = _pools.objects.size();
+    s.object_capacity = _pools.objects.capacity();
+    return s;
+}
+
 
 }  // namespace animation
 }  // namespace foolysh
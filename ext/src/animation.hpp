@@ -53,7 +53,7 @@
 #ifndef ANIMATION_HPP
 #define ANIMATION_HPP
 
-#include "list_t.hpp"
+#include "pool.hpp"
 #include "vec2.hpp"
 #include "node.hpp"
 #include <utility>
@@ -65,9 +65,11 @@
 namespace foolysh {
 namespace animation {
     typedef foolysh::tools::Vec2 Vec2;
+    typedef foolysh::tools::Vec2d Vec2d;
     typedef foolysh::scene::Node Node;
     typedef foolysh::scene::Scale Scale;
-    using foolysh::tools::ExtFreeList;
+    using foolysh::tools::Pool;
+    using foolysh::tools::Slab;
 
     enum BlendType {
         NO_BLEND,
@@ -115,7 +117,7 @@ namespace animation {
      * Hold information for a positional animation.
      */
     struct PositionData {
-        Vec2 start, end;
+        Vec2d start, end;
         std::unique_ptr<Node> relative_node;
         bool active = false, has_start = false;
     };
@@ -152,7 +154,6 @@ namespace animation {
      */
     struct AnimationData {
         AnimationData();
-        ~AnimationData();
 
         double duration, playback_pos = -1.0;
         double pos_speed = -1.0, scale_speed = -1.0, rotation_speed = 0.0,
@@ -166,22 +167,54 @@ namespace animation {
         AngleData angle;                // flags: 8
         DepthData depth;                // flags: 16
         int _ref_count, animation_id;
-
-        static ExtFreeList<AnimationData*> _ad;
     };
-    ExtFreeList<AnimationData*> AnimationData::_ad;
 
     typedef std::map<int, char> ActiveAnimationMap;
 
+    class AnimationBase;
+    struct AnimationPools;
+
+    /**
+     * Destroys an AnimationBase object and returns its storage to the object
+     * slab of the AnimationPools it was created from.
+     */
+    struct AnimationDeleter {
+        AnimationDeleter() : slab(nullptr) {}
+        AnimationDeleter(Slab* s) : slab(s) {}
+        void operator()(AnimationBase* p) const;
+        Slab* slab;
+    };
+
+    typedef std::unique_ptr<AnimationBase, AnimationDeleter> AnimationPtr;
+
+    /**
+     * Storage for AnimationData and for Interval, Animation and Sequence
+     * objects, owned by an AnimationManager.
+     */
+    struct AnimationPools {
+        AnimationPools();
+
+        template <class T>
+        AnimationPtr create();
+
+        Pool<AnimationData> data;
+        Slab objects;
+    };
+
     /**
      * Base class for Animation, Interval and Sequence (playable objects).
      */
     class AnimationBase {
     public:
+        AnimationBase(AnimationPools& pools) : _pools(&pools) {}
+        virtual ~AnimationBase() {}
         virtual void reset();
         virtual double step(const double dt, ActiveAnimationMap& aam);
-        virtual std::unique_ptr<AnimationBase> get_copy();
+        virtual AnimationPtr get_copy();
         virtual void loop(const bool l);
+
+    protected:
+        AnimationPools* _pools;
     };
 
     /**
@@ -190,7 +223,7 @@ namespace animation {
      */
     class AnimationType : public AnimationBase {
     public:
-        AnimationType();
+        AnimationType(AnimationPools& pools);
         ~AnimationType();
         AnimationType(const AnimationType& other);
         AnimationType(AnimationType&& other) noexcept;
@@ -244,11 +277,12 @@ namespace animation {
      */
     class Interval : public AnimationType {
     public:
+        Interval(AnimationPools& pools) : AnimationType(pools) {}
         void set_duration(const double d);
 
         void reset();
         double step(const double dt, ActiveAnimationMap& aam);
-        std::unique_ptr<AnimationBase> get_copy();
+        AnimationPtr get_copy();
 
     protected:
         char active_animations();
@@ -262,6 +296,7 @@ namespace animation {
      */
     class Animation : public AnimationType {
     public:
+        Animation(AnimationPools& pools) : AnimationType(pools) {}
         void set_pos_speed(const double s);
         void set_scale_speed(const double s);
         void set_rotation_speed(const double s);
@@ -270,7 +305,7 @@ namespace animation {
 
         void reset();
         double step(const double dt, ActiveAnimationMap& aam);
-        std::unique_ptr<AnimationBase> get_copy();
+        AnimationPtr get_copy();
 
     protected:
         char active_animations();
@@ -281,14 +316,15 @@ namespace animation {
      */
     class Sequence : public AnimationBase {
     public:
-        void append(std::unique_ptr<AnimationBase>& a);
+        Sequence(AnimationPools& pools) : AnimationBase(pools) {}
+        void append(AnimationPtr& a);
         void reset();
         double step(const double dt, ActiveAnimationMap& aam);
         void loop(const bool l);
-        std::unique_ptr<AnimationBase> get_copy();
+        AnimationPtr get_copy();
     private:
-        std::vector<std::unique_ptr<AnimationBase>> _v;
-        std::vector<std::unique_ptr<AnimationBase>>::size_type _active = 0;
+        std::vector<AnimationPtr> _v;
+        std::vector<AnimationPtr>::size_type _active = 0;
         bool _loop = false;
     };
 
@@ -310,7 +346,18 @@ namespace animation {
      *      4 = conflict
      */
     typedef ActiveAnimationMap AnimationStatusMap;
-    typedef std::map<int, std::unique_ptr<AnimationBase>, std::greater<int>> AnimationMap;
+    typedef std::map<int, AnimationPtr, std::greater<int>> AnimationMap;
+
+    /**
+     * Live and allocated slots of the AnimationData pool and of the object
+     * slab of an AnimationManager.
+     */
+    struct PoolStats {
+        int data_size;
+        int data_capacity;
+        size_t object_size;
+        size_t object_capacity;
+    };
 
     /**
      * Interface to control animation. Provides methods to create Interval,
@@ -324,7 +371,7 @@ namespace animation {
         Interval& get_interval(const int i_id);
         Animation& get_animation(const int a_id);
         Sequence& get_sequence(const int s_id);
-        std::unique_ptr<AnimationBase>& get_animation_base_ptr(const int i_id);
+        AnimationPtr& get_animation_base_ptr(const int i_id);
         void remove_interval(const int i_id);
         void remove_animation(const int a_id);
         void remove_sequence(const int s_id);
@@ -346,14 +393,38 @@ namespace animation {
         void append(const int s_id, const int a_id);
 
         void animate(const double dt);
+        PoolStats pool_stats() const;
 
     private:
+        AnimationPools _pools;  // Must outlive _anims
         ActiveAnimationMap _aam;
         AnimationMap _anims;
         AnimationStatusMap _anim_status;
         int _max_anim = -1;
     };
 
+
+/**
+ * Construct a new ``T`` (Interval, Animation or Sequence) in the object slab.
+ */
+template <class T>
+AnimationPtr AnimationPools::
+create() {
+    static_assert(std::is_base_of<AnimationBase, T>::value,
+                  "T must derive from AnimationBase");
+    if (sizeof(T) > objects.slot_size()) {
+        throw std::logic_error("Object does not fit into the slab.");
+    }
+    void* p = objects.allocate();
+    try {
+        return AnimationPtr(new (p) T(*this), AnimationDeleter(&objects));
+    }
+    catch (...) {
+        objects.deallocate(p);
+        throw;
+    }
+}
+
 }  // namespace animation
 }  // namespace foolysh
 
@@ -0,0 +1,339 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * Provides a linear per-frame arena for scratch data (traversal stacks, query
+ * results, ...) and an STL compatible allocator adapter. Allocations are a
+ * pointer bump, individual deallocations are ignored unless they release the
+ * most recent allocation. Memory is reclaimed in LIFO order through
+ * ``ArenaScope`` or all at once through ``reset()`` at the end of a frame.
+ */
+
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace foolysh {
+namespace tools {
+
+    /**
+     * Position in a FrameArena, as returned by ``mark()``.
+     */
+    struct ArenaMarker {
+        size_t block;
+        size_t offset;
+        size_t used;
+    };
+
+    class FrameArena {
+    public:
+        FrameArena(const size_t block_size = 64 * 1024);
+        ~FrameArena();
+        FrameArena(const FrameArena& other);
+        FrameArena& operator=(const FrameArena& other);
+
+        void* allocate(const size_t size,
+                       const size_t align = alignof(std::max_align_t));
+        void deallocate(void* p, const size_t size);
+        ArenaMarker mark() const;
+        void rewind(const ArenaMarker& m);
+        void reset();
+
+        size_t used() const;
+        size_t capacity() const;
+        size_t high_water_mark() const;
+        size_t block_count() const;
+
+    private:
+        struct Block {
+            char* data;
+            size_t size;
+        };
+        void _next_block(const size_t min_size);
+
+        std::vector<Block> _blocks;
+        size_t _block_size;
+        size_t _current;
+        size_t _offset;
+        size_t _used;
+        size_t _high_water;
+    };
+
+    /**
+     * RAII helper, rewinds the arena to the state at construction when it
+     * goes out of scope. Declare it before any container that allocates from
+     * the arena.
+     */
+    class ArenaScope {
+    public:
+        ArenaScope(FrameArena& arena) : _arena(arena), _m(arena.mark()) {}
+        ~ArenaScope() { _arena.rewind(_m); }
+        ArenaScope(const ArenaScope& other) = delete;
+        ArenaScope& operator=(const ArenaScope& other) = delete;
+
+    private:
+        FrameArena& _arena;
+        ArenaMarker _m;
+    };
+
+    /**
+     * STL compatible allocator adapter for FrameArena.
+     */
+    template <class T>
+    class ArenaAllocator {
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+        template <class U>
+        struct rebind {
+            typedef ArenaAllocator<U> other;
+        };
+
+        ArenaAllocator(FrameArena* arena) noexcept : _arena(arena) {}
+        template <class U>
+        ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+            : _arena(other.arena()) {}
+
+        T* allocate(const size_t n) {
+            return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+        }
+        void deallocate(T* p, const size_t n) noexcept {
+            _arena->deallocate(p, n * sizeof(T));
+        }
+        FrameArena* arena() const noexcept {
+            return _arena;
+        }
+
+    private:
+        FrameArena* _arena;
+    };
+
+    template <class T, class U>
+    inline bool operator==(const ArenaAllocator<T>& lhs,
+                           const ArenaAllocator<U>& rhs) {
+        return lhs.arena() == rhs.arena();
+    }
+
+    template <class T, class U>
+    inline bool operator!=(const ArenaAllocator<T>& lhs,
+                           const ArenaAllocator<U>& rhs) {
+        return lhs.arena() != rhs.arena();
+    }
+
+
+/**
+ * FrameArena
+ */
+
+/**
+ * Blocks are allocated lazily, ``block_size`` is the minimum size of a block.
+ */
+inline FrameArena::
+FrameArena(const size_t block_size)
+    : _block_size(block_size), _current(0), _offset(0), _used(0),
+      _high_water(0) {}
+
+/**
+ *
+ */
+inline FrameArena::
+~FrameArena() {
+    for (auto& b : _blocks) {
+        ::operator delete(b.data);
+    }
+}
+
+/**
+ * Scratch memory is never shared, a copy starts out empty.
+ */
+inline FrameArena::
+FrameArena(const FrameArena& other)
+    : _block_size(other._block_size), _current(0), _offset(0), _used(0),
+      _high_water(0) {}
+
+/**
+ * Keeps the own blocks, only the block size is taken over.
+ */
+inline FrameArena& FrameArena::
+operator=(const FrameArena& other) {
+    _block_size = other._block_size;
+    return *this;
+}
+
+/**
+ * Return ``size`` bytes aligned to ``align`` (power of two).
+ */
+inline void* FrameArena::
+allocate(const size_t size, const size_t align) {
+    if (_blocks.empty()) {
+        _next_block(size + align);
+    }
+    for (;;) {
+        Block& b = _blocks[_current];
+        const uintptr_t base = reinterpret_cast<uintptr_t>(b.data);
+        const uintptr_t top = base + _offset;
+        const uintptr_t aligned = (top + align - 1) & ~(uintptr_t) (align - 1);
+        const size_t end = static_cast<size_t>(aligned - base) + size;
+        if (end <= b.size) {
+            _used += end - _offset;
+            _offset = end;
+            if (_used > _high_water) {
+                _high_water = _used;
+            }
+            return reinterpret_cast<void*>(aligned);
+        }
+        _used += b.size - _offset;
+        _next_block(size + align);
+    }
+}
+
+/**
+ * Only reclaims memory if ``p`` is the most recent allocation.
+ */
+inline void FrameArena::
+deallocate(void* p, const size_t size) {
+    if (_blocks.empty() || p == nullptr) {
+        return;
+    }
+    char* top = _blocks[_current].data + _offset;
+    if (static_cast<char*>(p) + size == top) {
+        const size_t offset = static_cast<size_t>(
+            static_cast<char*>(p) - _blocks[_current].data);
+        _used -= _offset - offset;
+        _offset = offset;
+    }
+}
+
+/**
+ * Return the current position in the arena.
+ */
+inline ArenaMarker FrameArena::
+mark() const {
+    ArenaMarker m;
+    m.block = _current;
+    m.offset = _offset;
+    m.used = _used;
+    return m;
+}
+
+/**
+ * Release everything allocated after ``m`` was taken.
+ */
+inline void FrameArena::
+rewind(const ArenaMarker& m) {
+    _current = m.block;
+    _offset = m.offset;
+    _used = m.used;
+}
+
+/**
+ * Release all allocations. Must only be called when no scratch data is alive
+ * anymore, typically at the end of a frame. If the last frames required more
+ * than one block, the blocks are coalesced into a single block large enough
+ * for the high water mark, so subsequent frames don't hit the heap.
+ */
+inline void FrameArena::
+reset() {
+    if (_blocks.size() > 1) {
+        size_t total = 0;
+        for (auto& b : _blocks) {
+            total += b.size;
+            ::operator delete(b.data);
+        }
+        _blocks.clear();
+        Block b;
+        b.size = total;
+        b.data = static_cast<char*>(::operator new(total));
+        _blocks.push_back(b);
+    }
+    _current = 0;
+    _offset = 0;
+    _used = 0;
+}
+
+/**
+ * Bytes currently in use, including alignment padding.
+ */
+inline size_t FrameArena::
+used() const {
+    return _used;
+}
+
+/**
+ * Total bytes held by the arena.
+ */
+inline size_t FrameArena::
+capacity() const {
+    size_t total = 0;
+    for (auto& b : _blocks) {
+        total += b.size;
+    }
+    return total;
+}
+
+/**
+ * Maximum of ``used()`` since construction.
+ */
+inline size_t FrameArena::
+high_water_mark() const {
+    return _high_water;
+}
+
+/**
+ * Number of blocks currently held.
+ */
+inline size_t FrameArena::
+block_count() const {
+    return _blocks.size();
+}
+
+/**
+ * Advance to the next block that can hold ``min_size`` bytes, allocating a
+ * new one if necessary.
+ */
+inline void FrameArena::
+_next_block(const size_t min_size) {
+    const size_t next = _blocks.empty() ? 0 : _current + 1;
+    if (next < _blocks.size() && _blocks[next].size >= min_size) {
+        _current = next;
+        _offset = 0;
+        return;
+    }
+    Block b;
+    b.size = (min_size > _block_size) ? min_size : _block_size;
+    b.data = static_cast<char*>(::operator new(b.size));
+    _blocks.insert(_blocks.begin() + next, b);
+    _current = next;
+    _offset = 0;
+}
+
+
+}  // namespace tools
+}  // namespace foolysh
+
+#endif
@@ -0,0 +1,328 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "atlas.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+
+namespace foolysh {
+namespace tools {
+
+/**
+ * SkylinePacker
+ */
+
+/**
+ *
+ */
+SkylinePacker::
+SkylinePacker(const int width, const int height)
+    : _width(width), _height(height), _used(0) {
+    clear();
+}
+
+/**
+ * Place a ``w`` x ``h`` rectangle where its top edge ends up lowest, ties go
+ * to the narrowest segment. Returns false if it doesn't fit.
+ */
+bool SkylinePacker::
+insert(const int w, const int h, AtlasRect& out) {
+    if (w <= 0 || h <= 0) {
+        return false;
+    }
+    size_t best = _skyline.size();
+    int best_y = INT_MAX, best_w = INT_MAX;
+    for (size_t i = 0; i < _skyline.size(); ++i) {
+        int y;
+        if (!_fit(i, w, h, y)) {
+            continue;
+        }
+        if (y + h < best_y || (y + h == best_y && _skyline[i].w < best_w)) {
+            best = i;
+            best_y = y + h;
+            best_w = _skyline[i].w;
+        }
+    }
+    if (best == _skyline.size()) {
+        return false;
+    }
+    out.x = _skyline[best].x;
+    out.y = best_y - h;
+    out.w = w;
+    out.h = h;
+    _add(best, out);
+    _used += static_cast<long>(w) * h;
+    return true;
+}
+
+/**
+ *
+ */
+void SkylinePacker::
+clear() {
+    _skyline.clear();
+    _skyline.push_back({0, 0, _width});
+    _used = 0;
+}
+
+/**
+ * Extend the packing area to ``height``, placed rectangles keep their
+ * position.
+ */
+void SkylinePacker::
+grow(const int height) {
+    if (height > _height) {
+        _height = height;
+    }
+}
+
+/**
+ * Whether a rectangle starting at segment ``i`` fits, ``y`` receives the
+ * height it would be placed at.
+ */
+bool SkylinePacker::
+_fit(const size_t i, const int w, const int h, int& y) const {
+    if (_skyline[i].x + w > _width) {
+        return false;
+    }
+    int width_left = w;
+    y = _skyline[i].y;
+    for (size_t j = i; width_left > 0; ++j) {
+        y = std::max(y, _skyline[j].y);
+        if (y + h > _height) {
+            return false;
+        }
+        width_left -= _skyline[j].w;
+    }
+    return true;
+}
+
+/**
+ * Raise the skyline over ``r``, placed at segment ``i``.
+ */
+void SkylinePacker::
+_add(const size_t i, const AtlasRect& r) {
+    _skyline.insert(_skyline.begin() + i, {r.x, r.y + r.h, r.w});
+    size_t j = i + 1;
+    while (j < _skyline.size()) {
+        const Segment& prev = _skyline[j - 1];
+        Segment& cur = _skyline[j];
+        const int overlap = prev.x + prev.w - cur.x;
+        if (overlap <= 0) {
+            break;
+        }
+        if (cur.w <= overlap) {
+            _skyline.erase(_skyline.begin() + j);
+            continue;
+        }
+        cur.x += overlap;
+        cur.w -= overlap;
+        break;
+    }
+    j = 0;
+    while (j + 1 < _skyline.size()) {
+        if (_skyline[j].y == _skyline[j + 1].y) {
+            _skyline[j].w += _skyline[j + 1].w;
+            _skyline.erase(_skyline.begin() + j + 1);
+        }
+        else {
+            ++j;
+        }
+    }
+}
+
+
+/**
+ * TextureAtlas
+ */
+
+/**
+ *
+ */
+TextureAtlas::
+TextureAtlas(const int page_size, const int max_pages, const int padding)
+    : _page_size(page_size), _max_pages(max_pages), _padding(padding) {
+    if (page_size <= 0 || max_pages <= 0 || padding < 0) {
+        throw std::invalid_argument("Expected positive page_size/max_pages "
+                                    "and padding >= 0.");
+    }
+}
+
+/**
+ * Insert a ``w`` x ``h`` rectangle for ``key``. Tries existing pages first
+ * and opens a new one while below ``max_pages``. Returns false if there is
+ * no room, callers can then evict a page and retry.
+ */
+bool TextureAtlas::
+insert(const long key, const int w, const int h, AtlasEntry& out) {
+    if (_entries.count(key)) {
+        throw std::invalid_argument("Key already in atlas.");
+    }
+    const int pw = w + _padding, ph = h + _padding;
+    if (w <= 0 || h <= 0 || pw > _page_size || ph > _page_size) {
+        return false;
+    }
+    AtlasRect r;
+    int page = -1;
+    for (size_t i = 0; i < _pages.size(); ++i) {
+        if (_place(_pages[i], pw, ph, r)) {
+            page = static_cast<int>(i);
+            break;
+        }
+    }
+    if (page < 0) {
+        if (page_count() >= _max_pages) {
+            return false;
+        }
+        _pages.push_back({SkylinePacker(_page_size, _page_size), {}, 0});
+        page = page_count() - 1;
+        _place(_pages.back(), pw, ph, r);
+    }
+    _pages[page].live_area += static_cast<long>(pw) * ph;
+    out.page = page;
+    out.rect = {r.x, r.y, w, h};
+    _entries[key] = out;
+    return true;
+}
+
+/**
+ * Release the rectangle of ``key`` for reuse. A page without live entries is
+ * reset.
+ */
+bool TextureAtlas::
+remove(const long key) {
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        return false;
+    }
+    const AtlasEntry e = it->second;
+    _entries.erase(it);
+    Page& p = _pages[e.page];
+    const AtlasRect r = {e.rect.x, e.rect.y, e.rect.w + _padding,
+                         e.rect.h + _padding};
+    p.live_area -= static_cast<long>(r.w) * r.h;
+    if (p.live_area <= 0) {
+        p.packer.clear();
+        p.free_rects.clear();
+        p.live_area = 0;
+    }
+    else {
+        p.free_rects.push_back(r);
+    }
+    return true;
+}
+
+/**
+ *
+ */
+bool TextureAtlas::
+find(const long key, AtlasEntry& out) const {
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        return false;
+    }
+    out = it->second;
+    return true;
+}
+
+/**
+ * Remove all entries of ``page`` and reset it. Returns the evicted keys.
+ */
+std::vector<long> TextureAtlas::
+evict_page(const int page) {
+    if (page < 0 || page >= page_count()) {
+        throw std::range_error("Invalid page");
+    }
+    std::vector<long> keys;
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (it->second.page == page) {
+            keys.push_back(it->first);
+            it = _entries.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    Page& p = _pages[page];
+    p.packer.clear();
+    p.free_rects.clear();
+    p.live_area = 0;
+    return keys;
+}
+
+/**
+ *
+ */
+void TextureAtlas::
+clear() {
+    _pages.clear();
+    _entries.clear();
+}
+
+/**
+ * Fraction of ``page`` covered by live entries, including padding.
+ */
+double TextureAtlas::
+occupancy(const int page) const {
+    if (page < 0 || page >= page_count()) {
+        throw std::range_error("Invalid page");
+    }
+    return static_cast<double>(_pages[page].live_area)
+           / (static_cast<double>(_page_size) * _page_size);
+}
+
+/**
+ * Place in the smallest released rectangle that fits, splitting off the
+ * remainder, otherwise on the skyline.
+ */
+bool TextureAtlas::
+_place(Page& p, const int w, const int h, AtlasRect& out) {
+    size_t best = p.free_rects.size();
+    long best_area = LONG_MAX;
+    for (size_t i = 0; i < p.free_rects.size(); ++i) {
+        const AtlasRect& f = p.free_rects[i];
+        const long area = static_cast<long>(f.w) * f.h;
+        if (f.w >= w && f.h >= h && area < best_area) {
+            best = i;
+            best_area = area;
+        }
+    }
+    if (best == p.free_rects.size()) {
+        return p.packer.insert(w, h, out);
+    }
+    const AtlasRect f = p.free_rects[best];
+    p.free_rects.erase(p.free_rects.begin() + best);
+    out = {f.x, f.y, w, h};
+    if (f.w > w) {
+        p.free_rects.push_back({f.x + w, f.y, f.w - w, h});
+    }
+    if (f.h > h) {
+        p.free_rects.push_back({f.x, f.y + h, f.w, f.h - h});
+    }
+    return true;
+}
+
+
+}  // namespace tools
+}  // namespace foolysh
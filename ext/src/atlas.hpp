@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * Rectangle packing for texture atlases.
+ *
+ * ``SkylinePacker`` places rectangles bottom-left along a skyline (the upper
+ * contour of all placed rectangles), which is fast and packs sprites and
+ * glyphs of similar height tightly. ``TextureAtlas`` manages fixed size pages
+ * of those, maps keys to their page and rectangle and supports eviction:
+ * removed rectangles are reused for later inserts that fit, and a whole page
+ * can be reset at once.
+ */
+
+#ifndef ATLAS_HPP
+#define ATLAS_HPP
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace foolysh {
+namespace tools {
+    struct AtlasRect {
+        int x, y, w, h;
+    };
+
+    struct AtlasEntry {
+        int page;
+        AtlasRect rect;
+    };
+
+    class SkylinePacker {
+    public:
+        SkylinePacker(const int width = 1024, const int height = 1024);
+
+        bool insert(const int w, const int h, AtlasRect& out);
+        void clear();
+        void grow(const int height);
+
+        int width() const { return _width; }
+        int height() const { return _height; }
+        long used_area() const { return _used; }
+
+    private:
+        struct Segment {
+            int x, y, w;
+        };
+
+        bool _fit(const size_t i, const int w, const int h, int& y) const;
+        void _add(const size_t i, const AtlasRect& r);
+
+        std::vector<Segment> _skyline;
+        int _width, _height;
+        long _used;
+    };
+
+    class TextureAtlas {
+    public:
+        TextureAtlas(const int page_size = 1024, const int max_pages = 4,
+                     const int padding = 1);
+
+        bool insert(const long key, const int w, const int h, AtlasEntry& out);
+        bool remove(const long key);
+        bool find(const long key, AtlasEntry& out) const;
+        std::vector<long> evict_page(const int page);
+        void clear();
+
+        int page_size() const { return _page_size; }
+        int page_count() const { return static_cast<int>(_pages.size()); }
+        int max_pages() const { return _max_pages; }
+        size_t size() const { return _entries.size(); }
+        double occupancy(const int page) const;
+
+    private:
+        struct Page {
+            SkylinePacker packer;
+            std::vector<AtlasRect> free_rects;
+            long live_area;
+        };
+
+        bool _place(Page& p, const int w, const int h, AtlasRect& out);
+
+        std::vector<Page> _pages;
+        std::unordered_map<long, AtlasEntry> _entries;
+        int _page_size, _max_pages, _padding;
+    };
+}  // namespace tools
+}  // namespace foolysh
+
+#endif
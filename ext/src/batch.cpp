@@ -0,0 +1,585 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Batch kernels for arrays of Vec2d/AABB, see batch.hpp.
+ */
+
+#include "batch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "common.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define FOOLYSH_BATCH_AVX 1
+#include <immintrin.h>
+#define AVX_FN __attribute__((target("avx")))
+#endif
+
+namespace foolysh {
+namespace tools {
+namespace batch {
+
+static_assert(sizeof(AABB) == 4 * sizeof(double), "AABB must be 4 doubles");
+static_assert(sizeof(Vec2d) == 2 * sizeof(double), "Vec2d must be 2 doubles");
+
+namespace {
+
+/**
+ * Portable implementation.
+ */
+namespace scalar {
+
+void
+add(const double* a, const double* b, double* out, const size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = a[i] + b[i];
+    }
+}
+
+void
+scale(const double* a, const double s, double* out, const size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = a[i] * s;
+    }
+}
+
+void
+lerp(const double* a, const double* b, const double t, double* out,
+     const size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = a[i] + (b[i] - a[i]) * t;
+    }
+}
+
+void
+rotate(const Vec2d* a, const double sa, const double ca, const Vec2d& c,
+       Vec2d* out, const size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = rotated(a[i] - c, sa, ca) + c;
+    }
+}
+
+void
+normalize(const Vec2d* a, Vec2d* out, const size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        const double l = length(a[i]);
+        out[i] = (l > 0.0) ? a[i] * (1.0 / l) : a[i];
+    }
+}
+
+void
+sin_cos(const double* a, double* s, double* c, const size_t n) {
+    fast_sincos(a, s, c, n);
+}
+
+size_t
+overlap(const AABB* boxes, const AABB& q, uint8_t* out, const size_t n) {
+    size_t hits = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const AABB& b = boxes[i];
+        out[i] = std::fabs(b.x - q.x) <= b.hw + q.hw
+                 && std::fabs(b.y - q.y) <= b.hh + q.hh;
+        hits += out[i];
+    }
+    return hits;
+}
+
+size_t
+contains(const AABB* boxes, const Vec2d& p, uint8_t* out, const size_t n) {
+    size_t hits = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const AABB& b = boxes[i];
+        out[i] = std::fabs(p.x - b.x) <= b.hw && std::fabs(p.y - b.y) <= b.hh;
+        hits += out[i];
+    }
+    return hits;
+}
+
+void
+bounds(const AABB* boxes, const size_t n, double* lo, double* hi) {
+    for (size_t i = 0; i < n; ++i) {
+        lo[0] = std::min(lo[0], boxes[i].x - boxes[i].hw);
+        lo[1] = std::min(lo[1], boxes[i].y - boxes[i].hh);
+        hi[0] = std::max(hi[0], boxes[i].x + boxes[i].hw);
+        hi[1] = std::max(hi[1], boxes[i].y + boxes[i].hh);
+    }
+}
+
+}  // namespace scalar
+
+#ifdef FOOLYSH_BATCH_AVX
+/**
+ * AVX implementation. Points are processed two per register as interleaved
+ * x/y pairs, boxes four at a time after a 4x4 transpose into x/y/hw/hh rows.
+ * Remainders are handed to the scalar implementation.
+ */
+namespace avx {
+
+AVX_FN void
+add(const double* a, const double* b, double* out, const size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i),
+                                                _mm256_loadu_pd(b + i)));
+    }
+    scalar::add(a + i, b + i, out + i, n - i);
+}
+
+AVX_FN void
+scale(const double* a, const double s, double* out, const size_t n) {
+    const __m256d vs = _mm256_set1_pd(s);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), vs));
+    }
+    scalar::scale(a + i, s, out + i, n - i);
+}
+
+AVX_FN void
+lerp(const double* a, const double* b, const double t, double* out,
+     const size_t n) {
+    const __m256d vt = _mm256_set1_pd(t);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d va = _mm256_loadu_pd(a + i);
+        const __m256d d = _mm256_sub_pd(_mm256_loadu_pd(b + i), va);
+        _mm256_storeu_pd(out + i, _mm256_add_pd(va, _mm256_mul_pd(d, vt)));
+    }
+    scalar::lerp(a + i, b + i, t, out + i, n - i);
+}
+
+AVX_FN void
+rotate(const Vec2d* a, const double sa, const double ca, const Vec2d& c,
+       Vec2d* out, const size_t n) {
+    const double* src = &a[0].x;
+    double* dst = &out[0].x;
+    const __m256d vc = _mm256_setr_pd(c.x, c.y, c.x, c.y);
+    const __m256d vca = _mm256_set1_pd(ca);
+    const __m256d vsa = _mm256_setr_pd(-sa, sa, -sa, sa);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        const __m256d v = _mm256_sub_pd(_mm256_loadu_pd(src + 2 * i), vc);
+        const __m256d swapped = _mm256_permute_pd(v, 0x5);
+        const __m256d r = _mm256_add_pd(_mm256_mul_pd(v, vca),
+                                        _mm256_mul_pd(swapped, vsa));
+        _mm256_storeu_pd(dst + 2 * i, _mm256_add_pd(r, vc));
+    }
+    scalar::rotate(a + i, sa, ca, c, out + i, n - i);
+}
+
+AVX_FN void
+normalize(const Vec2d* a, Vec2d* out, const size_t n) {
+    const double* src = &a[0].x;
+    double* dst = &out[0].x;
+    const __m256d zero = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        const __m256d v = _mm256_loadu_pd(src + 2 * i);
+        const __m256d sq = _mm256_mul_pd(v, v);
+        const __m256d mag = _mm256_add_pd(sq, _mm256_permute_pd(sq, 0x5));
+        const __m256d l = _mm256_sqrt_pd(mag);
+        const __m256d nonzero = _mm256_cmp_pd(l, zero, _CMP_GT_OQ);
+        const __m256d r = _mm256_div_pd(v, l);
+        _mm256_storeu_pd(dst + 2 * i, _mm256_blendv_pd(v, r, nonzero));
+    }
+    scalar::normalize(a + i, out + i, n - i);
+}
+
+/**
+ * Widen four 32 bit lane masks to four 64 bit lane masks.
+ */
+AVX_FN inline __m256d
+widen_mask(const __m128i m) {
+    return _mm256_castsi256_pd(_mm256_insertf128_si256(
+        _mm256_castsi128_si256(_mm_unpacklo_epi32(m, m)),
+        _mm_unpackhi_epi32(m, m), 1));
+}
+
+AVX_FN void
+sin_cos(const double* a, double* s, double* c, const size_t n) {
+    const __m256d two_over_pi = _mm256_set1_pd(0.63661977236758134308);
+    const __m256d pio2_hi = _mm256_set1_pd(1.57079632679489655800e+00);
+    const __m256d pio2_lo = _mm256_set1_pd(6.12323399573676603587e-17);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d x = _mm256_loadu_pd(a + i);
+        const __m256d k = _mm256_round_pd(
+            _mm256_mul_pd(x, two_over_pi),
+            _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        const __m256d r = _mm256_sub_pd(
+            _mm256_sub_pd(x, _mm256_mul_pd(k, pio2_hi)),
+            _mm256_mul_pd(k, pio2_lo));
+        const __m256d r2 = _mm256_mul_pd(r, r);
+        __m256d ps = _mm256_add_pd(
+            _mm256_set1_pd(8.3321608736e-3),
+            _mm256_mul_pd(r2, _mm256_set1_pd(-1.9515295891e-4)));
+        ps = _mm256_add_pd(_mm256_set1_pd(-1.6666654611e-1),
+                           _mm256_mul_pd(r2, ps));
+        ps = _mm256_add_pd(r, _mm256_mul_pd(_mm256_mul_pd(r, r2), ps));
+        __m256d pc = _mm256_add_pd(
+            _mm256_set1_pd(-1.388731625493765e-3),
+            _mm256_mul_pd(r2, _mm256_set1_pd(2.443315711809948e-5)));
+        pc = _mm256_add_pd(_mm256_set1_pd(4.166664568298827e-2),
+                           _mm256_mul_pd(r2, pc));
+        pc = _mm256_add_pd(
+            _mm256_sub_pd(_mm256_set1_pd(1.0),
+                          _mm256_mul_pd(_mm256_set1_pd(0.5), r2)),
+            _mm256_mul_pd(_mm256_mul_pd(r2, r2), pc));
+        const __m128i q = _mm256_cvtpd_epi32(k);
+        const __m256d swap = widen_mask(
+            _mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+        const __m256d neg_s = widen_mask(
+            _mm_cmpeq_epi32(_mm_and_si128(q, two), two));
+        const __m256d neg_c = widen_mask(_mm_cmpeq_epi32(
+            _mm_and_si128(_mm_add_epi32(q, one), two), two));
+        const __m256d ss = _mm256_blendv_pd(ps, pc, swap);
+        const __m256d cc = _mm256_blendv_pd(pc, ps, swap);
+        _mm256_storeu_pd(s + i, _mm256_xor_pd(ss, _mm256_and_pd(neg_s, sign)));
+        _mm256_storeu_pd(c + i, _mm256_xor_pd(cc, _mm256_and_pd(neg_c, sign)));
+    }
+    scalar::sin_cos(a + i, s + i, c + i, n - i);
+}
+
+/**
+ * Load four boxes and transpose them into x, y, hw and hh rows.
+ */
+AVX_FN inline void
+load4(const AABB* b, __m256d& x, __m256d& y, __m256d& hw, __m256d& hh) {
+    const double* p = &b[0].x;
+    const __m256d r0 = _mm256_loadu_pd(p);
+    const __m256d r1 = _mm256_loadu_pd(p + 4);
+    const __m256d r2 = _mm256_loadu_pd(p + 8);
+    const __m256d r3 = _mm256_loadu_pd(p + 12);
+    const __m256d t0 = _mm256_unpacklo_pd(r0, r1);  // x0 x1 hw0 hw1
+    const __m256d t1 = _mm256_unpackhi_pd(r0, r1);  // y0 y1 hh0 hh1
+    const __m256d t2 = _mm256_unpacklo_pd(r2, r3);  // x2 x3 hw2 hw3
+    const __m256d t3 = _mm256_unpackhi_pd(r2, r3);  // y2 y3 hh2 hh3
+    x = _mm256_permute2f128_pd(t0, t2, 0x20);
+    y = _mm256_permute2f128_pd(t1, t3, 0x20);
+    hw = _mm256_permute2f128_pd(t0, t2, 0x31);
+    hh = _mm256_permute2f128_pd(t1, t3, 0x31);
+}
+
+AVX_FN inline __m256d
+abs4(const __m256d v) {
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+}
+
+AVX_FN inline size_t
+store_mask(const int mask, uint8_t* out) {
+    for (int k = 0; k < 4; ++k) {
+        out[k] = (mask >> k) & 1;
+    }
+    return __builtin_popcount(mask);
+}
+
+AVX_FN size_t
+overlap(const AABB* boxes, const AABB& q, uint8_t* out, const size_t n) {
+    const __m256d qx = _mm256_set1_pd(q.x), qy = _mm256_set1_pd(q.y);
+    const __m256d qhw = _mm256_set1_pd(q.hw), qhh = _mm256_set1_pd(q.hh);
+    size_t hits = 0, i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x, y, hw, hh;
+        load4(boxes + i, x, y, hw, hh);
+        const __m256d ox = _mm256_cmp_pd(abs4(_mm256_sub_pd(x, qx)),
+                                         _mm256_add_pd(hw, qhw), _CMP_LE_OQ);
+        const __m256d oy = _mm256_cmp_pd(abs4(_mm256_sub_pd(y, qy)),
+                                         _mm256_add_pd(hh, qhh), _CMP_LE_OQ);
+        hits += store_mask(_mm256_movemask_pd(_mm256_and_pd(ox, oy)),
+                           out + i);
+    }
+    return hits + scalar::overlap(boxes + i, q, out + i, n - i);
+}
+
+AVX_FN size_t
+contains(const AABB* boxes, const Vec2d& p, uint8_t* out, const size_t n) {
+    const __m256d px = _mm256_set1_pd(p.x), py = _mm256_set1_pd(p.y);
+    size_t hits = 0, i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x, y, hw, hh;
+        load4(boxes + i, x, y, hw, hh);
+        const __m256d ix = _mm256_cmp_pd(abs4(_mm256_sub_pd(px, x)), hw,
+                                         _CMP_LE_OQ);
+        const __m256d iy = _mm256_cmp_pd(abs4(_mm256_sub_pd(py, y)), hh,
+                                         _CMP_LE_OQ);
+        hits += store_mask(_mm256_movemask_pd(_mm256_and_pd(ix, iy)),
+                           out + i);
+    }
+    return hits + scalar::contains(boxes + i, p, out + i, n - i);
+}
+
+AVX_FN void
+bounds(const AABB* boxes, const size_t n, double* lo, double* hi) {
+    __m256d lx = _mm256_set1_pd(lo[0]), ly = _mm256_set1_pd(lo[1]);
+    __m256d hx = _mm256_set1_pd(hi[0]), hy = _mm256_set1_pd(hi[1]);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x, y, hw, hh;
+        load4(boxes + i, x, y, hw, hh);
+        lx = _mm256_min_pd(lx, _mm256_sub_pd(x, hw));
+        ly = _mm256_min_pd(ly, _mm256_sub_pd(y, hh));
+        hx = _mm256_max_pd(hx, _mm256_add_pd(x, hw));
+        hy = _mm256_max_pd(hy, _mm256_add_pd(y, hh));
+    }
+    double l_x[4], l_y[4], h_x[4], h_y[4];
+    _mm256_storeu_pd(l_x, lx);
+    _mm256_storeu_pd(l_y, ly);
+    _mm256_storeu_pd(h_x, hx);
+    _mm256_storeu_pd(h_y, hy);
+    for (int k = 0; k < 4; ++k) {
+        lo[0] = std::min(lo[0], l_x[k]);
+        lo[1] = std::min(lo[1], l_y[k]);
+        hi[0] = std::max(hi[0], h_x[k]);
+        hi[1] = std::max(hi[1], h_y[k]);
+    }
+    scalar::bounds(boxes + i, n - i, lo, hi);
+}
+
+}  // namespace avx
+#endif
+
+SimdLevel
+detect_simd_level() {
+#ifdef FOOLYSH_BATCH_AVX
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx")) {
+        return AVX;
+    }
+#endif
+    return SCALAR;
+}
+
+SimdLevel&
+active_level() {
+    static SimdLevel level = detect_simd_level();
+    return level;
+}
+
+inline bool
+use_avx() {
+#ifdef FOOLYSH_BATCH_AVX
+    return active_level() == AVX;
+#else
+    return false;
+#endif
+}
+
+template <class A, class B>
+inline void
+check_size(const Span<A>& a, const Span<B>& b) {
+    if (a.size() != b.size()) {
+        throw std::invalid_argument("Span sizes do not match.");
+    }
+}
+
+}  // namespace
+
+/**
+ * Return the SIMD level currently used by the kernels.
+ */
+SimdLevel
+simd_level() {
+    return active_level();
+}
+
+/**
+ * Select the SIMD level, ``level`` is capped at what the CPU supports. Mainly
+ * useful to compare implementations in tests/benchmarks.
+ */
+void
+set_simd_level(SimdLevel level) {
+    active_level() = std::min(level, detect_simd_level());
+}
+
+/**
+ * out = a + b
+ */
+void
+add(Span<const Vec2d> a, Span<const Vec2d> b, Span<Vec2d> out) {
+    check_size(a, b);
+    check_size(a, out);
+    if (!a.size()) {
+        return;
+    }
+#ifdef FOOLYSH_BATCH_AVX
+    if (use_avx()) {
+        return avx::add(&a[0].x, &b[0].x, &out[0].x, a.size() * 2);
+    }
+#endif
+    scalar::add(&a[0].x, &b[0].x, &out[0].x, a.size() * 2);
+}
+
+/**
+ * out = a * s
+ */
+void
+scale(Span<const Vec2d> a, const double s, Span<Vec2d> out) {
+    check_size(a, out);
+    if (!a.size()) {
+        return;
+    }
+#ifdef FOOLYSH_BATCH_AVX
+    if (use_avx()) {
+        return avx::scale(&a[0].x, s, &out[0].x, a.size() * 2);
+    }
+#endif
+    scalar::scale(&a[0].x, s, &out[0].x, a.size() * 2);
+}
+
+/**
+ * Rotate all points around ``center``, same convention as ``Vec2::rotate``.
+ */
+void
+rotate(Span<const Vec2d> a, double angle, const Vec2d& center,
+       Span<Vec2d> out, const bool radians) {
+    check_size(a, out);
+    if (!a.size()) {
+        return;
+    }
+    if (!radians) {
+        angle *= -to_rad;
+    }
+    const double sa = std::sin(angle), ca = std::cos(angle);
+#ifdef FOOLYSH_BATCH_AVX
+    if (use_avx()) {
+        return avx::rotate(a.data, sa, ca, center, out.data, a.size());
+    }
+#endif
+    scalar::rotate(a.data, sa, ca, center, out.data, a.size());
+}
+
+/**
+ * Normalize all points, points of zero length are copied unchanged.
+ */
+void
+normalize(Span<const Vec2d> a, Span<Vec2d> out) {
+    check_size(a, out);
+    if (!a.size()) {
+        return;
+    }
+#ifdef FOOLYSH_BATCH_AVX
+    if (use_avx()) {
+        return avx::normalize(a.data, out.data, a.size());
+    }
+#endif
+    scalar::normalize(a.data, out.data, a.size());
+}
+
+/**
+ * out = a + (b - a) * t
+ */
+void
+lerp(Span<const Vec2d> a, Span<const Vec2d> b, const double t,
+     Span<Vec2d> out) {
+    check_size(a, b);
+    check_size(a, out);
+    if (!a.size()) {
+        return;
+    }
+#ifdef FOOLYSH_BATCH_AVX
+    if (use_avx()) {
+        return avx::lerp(&a[0].x, &b[0].x, t, &out[0].x, a.size() * 2);
+    }
+#endif
+    scalar::lerp(&a[0].x, &b[0].x, t, &out[0].x, a.size() * 2);
+}
+
+/**
+ * Approximate sine and cosine of all angles ``a`` (radians).
+ */
+void
+sin_cos(Span<const double> a, Span<double> s, Span<double> c) {
+    check_size(a, s);
+    check_size(a, c);
+#ifdef FOOLYSH_BATCH_AVX
+    if (use_avx()) {
+        return avx::sin_cos(a.data, s.data, c.data, a.size());
+    }
+#endif
+    scalar::sin_cos(a.data, s.data, c.data, a.size());
+}
+
+/**
+ * Set ``out[i]`` to whether ``boxes[i]`` overlaps ``query`` and return the
+ * number of overlapping boxes.
+ */
+size_t
+overlap(Span<const AABB> boxes, const AABB& query, Span<uint8_t> out) {
+    check_size(boxes, out);
+#ifdef FOOLYSH_BATCH_AVX
+    if (use_avx()) {
+        return avx::overlap(boxes.data, query, out.data, boxes.size());
+    }
+#endif
+    return scalar::overlap(boxes.data, query, out.data, boxes.size());
+}
+
+/**
+ * Set ``out[i]`` to whether ``boxes[i]`` contains ``p`` and return the number
+ * of boxes containing the point.
+ */
+size_t
+contains(Span<const AABB> boxes, const Vec2d& p, Span<uint8_t> out) {
+    check_size(boxes, out);
+#ifdef FOOLYSH_BATCH_AVX
+    if (use_avx()) {
+        return avx::contains(boxes.data, p, out.data, boxes.size());
+    }
+#endif
+    return scalar::contains(boxes.data, p, out.data, boxes.size());
+}
+
+/**
+ * Return the smallest AABB enclosing all ``boxes``.
+ */
+AABB
+bounds_union(Span<const AABB> boxes) {
+    if (!boxes.size()) {
+        throw std::invalid_argument("Cannot compute the union of no boxes.");
+    }
+    double lo[2] = {std::numeric_limits<double>::infinity(),
+                    std::numeric_limits<double>::infinity()};
+    double hi[2] = {-lo[0], -lo[1]};
+#ifdef FOOLYSH_BATCH_AVX
+    if (use_avx()) {
+        avx::bounds(boxes.data, boxes.size(), lo, hi);
+    }
+    else {
+        scalar::bounds(boxes.data, boxes.size(), lo, hi);
+    }
+#else
+    scalar::bounds(boxes.data, boxes.size(), lo, hi);
+#endif
+    const double hw = (hi[0] - lo[0]) / 2.0, hh = (hi[1] - lo[1]) / 2.0;
+    return AABB(lo[0] + hw, lo[1] + hh, hw, hh, AABB::Unchecked());
+}
+
+}  // namespace batch
+}  // namespace tools
+}  // namespace foolysh
@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ *
+ * Provides batch kernels for contiguous arrays of points (``Vec2d``) and
+ * boxes (``AABB``). Arrays are passed as non owning spans, output spans may
+ * alias the input spans.
+ *
+ * On x86 built with GCC/clang an AVX implementation is selected at runtime
+ * when the CPU supports it, otherwise a portable implementation is used that
+ * the compiler is free to vectorize for the baseline instruction set (SSE2 on
+ * x86_64, NEON on aarch64). Boxes are tested with ``|d| <= h0 + h1`` per axis
+ * by both implementations, so results do not depend on the selected path.
+ * ``sin_cos`` uses the approximation from fastmath.hpp in both paths.
+ */
+
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "aabb.hpp"
+#include "fastmath.hpp"
+#include "soa.hpp"
+#include "vec2t.hpp"
+
+namespace foolysh {
+namespace tools {
+namespace batch {
+
+    template <class T>
+    using Span = ColumnView<T>;
+
+    enum SimdLevel {
+        SCALAR,
+        AVX
+    };
+
+    SimdLevel simd_level();
+    void set_simd_level(SimdLevel level);
+
+    // Points
+    void add(Span<const Vec2d> a, Span<const Vec2d> b, Span<Vec2d> out);
+    void scale(Span<const Vec2d> a, const double s, Span<Vec2d> out);
+    void rotate(Span<const Vec2d> a, const double angle, const Vec2d& center,
+                Span<Vec2d> out, const bool radians = false);
+    void normalize(Span<const Vec2d> a, Span<Vec2d> out);
+    void lerp(Span<const Vec2d> a, Span<const Vec2d> b, const double t,
+              Span<Vec2d> out);
+
+    // Angles
+    void sin_cos(Span<const double> a, Span<double> s, Span<double> c);
+
+    // Boxes
+    size_t overlap(Span<const AABB> boxes, const AABB& query,
+                   Span<uint8_t> out);
+    size_t contains(Span<const AABB> boxes, const Vec2d& p,
+                    Span<uint8_t> out);
+    AABB bounds_union(Span<const AABB> boxes);
+
+}  // namespace batch
+}  // namespace tools
+}  // namespace foolysh
+
+#endif
@@ -26,6 +26,8 @@
 #ifndef COMMON_HPP
 #define COMMON_HPP
 
+#include <cmath>
+
 constexpr double to_deg = 180.0 / 3.14159265358979323846;
 constexpr double to_rad = 3.14159265358979323846 / 180.0;
 
@@ -33,11 +35,12 @@ constexpr double to_rad = 3.14159265358979323846 / 180.0;
  * Return a clamped angle in the range [-180, 180].
  */
 inline double clamp_angle(double a) {
-    while (a > 180) {
-        a -= 360.0;
+    a = std::fmod(a, 360.0);
+    if (a > 180.0) {
+        return a - 360.0;
     }
-    while (a < -180) {
-        a += 360.0;
+    if (a < -180.0) {
+        return a + 360.0;
     }
     return a;
 }
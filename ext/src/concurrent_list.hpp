@@ -0,0 +1,269 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * Provides a lock-free indexed free list. Like ``FreeList`` indices stay valid
+ * until they are erased, but ``insert()`` and ``erase()`` may be called from
+ * multiple threads concurrently. T must be trivially constructible and
+ * destructible. Concurrent access to the same element must be synchronized by
+ * the caller.
+ *
+ * Storage is allocated in fixed size chunks that are never moved or released
+ * before destruction, so references to elements remain valid while other
+ * threads insert. Released slots are kept on a Treiber stack whose head
+ * carries a tag that is incremented on every update, which prevents the ABA
+ * problem when a slot is popped, reused and pushed again between the load and
+ * the compare-and-swap of another thread.
+ */
+
+#ifndef CONCURRENT_LIST_HPP
+#define CONCURRENT_LIST_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+namespace foolysh {
+namespace tools {
+
+    template <class T>
+    class ConcurrentFreeList {
+        static_assert(std::is_trivially_default_constructible<T>::value
+                      && std::is_trivially_destructible<T>::value,
+                      "ConcurrentFreeList requires a trivial element type.");
+
+    public:
+        static const int CHUNK_SIZE = 1024;
+        static const int MAX_CHUNKS = 4096;
+
+        ConcurrentFreeList();
+        ~ConcurrentFreeList();
+        ConcurrentFreeList(const ConcurrentFreeList<T>& other) = delete;
+        ConcurrentFreeList<T>& operator=(
+            const ConcurrentFreeList<T>& other) = delete;
+
+        int insert(const T& element);
+        bool erase(int n);
+        int range() const;
+        bool active(int n) const;
+        T& operator[](int n);
+        const T& operator[](int n) const;
+
+    private:
+        struct Slot {
+            T element;
+            std::atomic<uint32_t> next;
+            std::atomic<bool> live;
+        };
+
+        Slot& _slot(int n) const;
+        Slot& _ensure_chunk(int n);
+
+        // Low 32 bits: index + 1 of the first free slot (0 = empty),
+        // high 32 bits: tag.
+        std::atomic<uint64_t> _free_head;
+        std::atomic<int> _next_unused;
+        std::atomic<Slot*> _chunks[MAX_CHUNKS];
+    };
+
+
+/**
+ * ConcurrentFreeList
+ */
+
+template <class T>
+const int ConcurrentFreeList<T>::CHUNK_SIZE;
+
+template <class T>
+const int ConcurrentFreeList<T>::MAX_CHUNKS;
+
+/**
+ *
+ */
+template <class T>
+ConcurrentFreeList<T>::ConcurrentFreeList()
+    : _free_head(0), _next_unused(0) {
+    for (int i = 0; i < MAX_CHUNKS; ++i) {
+        _chunks[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Not thread-safe, no other thread may access the list anymore.
+ */
+template <class T>
+ConcurrentFreeList<T>::~ConcurrentFreeList() {
+    for (int i = 0; i < MAX_CHUNKS; ++i) {
+        delete[] _chunks[i].load(std::memory_order_acquire);
+    }
+}
+
+/**
+ * Insert ``element`` and return its index. Reuses released slots first.
+ */
+template <class T>
+int ConcurrentFreeList<T>::
+insert(const T& element) {
+    uint64_t head = _free_head.load(std::memory_order_acquire);
+    while (head & 0xffffffffu) {
+        const int index = static_cast<int>(head & 0xffffffffu) - 1;
+        const uint64_t next =
+            _slot(index).next.load(std::memory_order_relaxed);
+        const uint64_t tag = (head >> 32) + 1;
+        if (_free_head.compare_exchange_weak(head, (tag << 32) | next,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+            Slot& s = _slot(index);
+            s.element = element;
+            s.live.store(true, std::memory_order_release);
+            return index;
+        }
+    }
+    const int index = _next_unused.fetch_add(1, std::memory_order_relaxed);
+    if (index >= CHUNK_SIZE * MAX_CHUNKS) {
+        _next_unused.fetch_sub(1, std::memory_order_relaxed);
+        throw std::length_error("ConcurrentFreeList capacity exceeded.");
+    }
+    Slot& s = _ensure_chunk(index);
+    s.element = element;
+    s.live.store(true, std::memory_order_release);
+    return index;
+}
+
+/**
+ * Release the slot at index ``n`` for reuse. Returns false and leaves the
+ * list untouched if ``n`` holds no value, e.g. when it was already released,
+ * as pushing a slot twice would link the free stack into a cycle.
+ */
+template <class T>
+bool ConcurrentFreeList<T>::
+erase(int n) {
+    if (n < 0 || n >= range()) {
+        return false;
+    }
+    Slot* chunk = _chunks[n / CHUNK_SIZE].load(std::memory_order_acquire);
+    if (chunk == nullptr) {
+        return false;
+    }
+    Slot& s = chunk[n % CHUNK_SIZE];
+    if (!s.live.exchange(false, std::memory_order_acq_rel)) {
+        return false;
+    }
+    uint64_t head = _free_head.load(std::memory_order_relaxed);
+    uint64_t desired;
+    do {
+        s.next.store(static_cast<uint32_t>(head & 0xffffffffu),
+                     std::memory_order_relaxed);
+        desired = (((head >> 32) + 1) << 32) | static_cast<uint64_t>(n + 1);
+    } while (!_free_head.compare_exchange_weak(head, desired,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+    return true;
+}
+
+/**
+ * Upper bound of indices handed out so far.
+ */
+template <class T>
+int ConcurrentFreeList<T>::
+range() const {
+    return std::min(_next_unused.load(std::memory_order_acquire),
+                    CHUNK_SIZE * MAX_CHUNKS);
+}
+
+/**
+ *
+ */
+template <class T>
+bool ConcurrentFreeList<T>::
+active(int n) const {
+    if (n < 0 || n >= range()) {
+        return false;
+    }
+    Slot* chunk = _chunks[n / CHUNK_SIZE].load(std::memory_order_acquire);
+    if (chunk == nullptr) {
+        return false;
+    }
+    return chunk[n % CHUNK_SIZE].live.load(std::memory_order_acquire);
+}
+
+/**
+ *
+ */
+template <class T>
+T& ConcurrentFreeList<T>::
+operator[](int n) {
+    return _slot(n).element;
+}
+
+/**
+ *
+ */
+template <class T>
+const T& ConcurrentFreeList<T>::
+operator[](int n) const {
+    return _slot(n).element;
+}
+
+/**
+ *
+ */
+template <class T>
+typename ConcurrentFreeList<T>::Slot& ConcurrentFreeList<T>::
+_slot(int n) const {
+    Slot* chunk = _chunks[n / CHUNK_SIZE].load(std::memory_order_acquire);
+    return chunk[n % CHUNK_SIZE];
+}
+
+/**
+ * Return the slot at index ``n``, publishing its chunk if necessary. When
+ * several threads race for the same chunk, only one allocation survives.
+ */
+template <class T>
+typename ConcurrentFreeList<T>::Slot& ConcurrentFreeList<T>::
+_ensure_chunk(int n) {
+    std::atomic<Slot*>& c = _chunks[n / CHUNK_SIZE];
+    Slot* chunk = c.load(std::memory_order_acquire);
+    if (chunk == nullptr) {
+        Slot* fresh = new Slot[CHUNK_SIZE];
+        for (int i = 0; i < CHUNK_SIZE; ++i) {
+            fresh[i].next.store(0, std::memory_order_relaxed);
+            fresh[i].live.store(false, std::memory_order_relaxed);
+        }
+        if (c.compare_exchange_strong(chunk, fresh,
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+            chunk = fresh;
+        }
+        else {
+            delete[] fresh;
+        }
+    }
+    return chunk[n % CHUNK_SIZE];
+}
+
+
+}  // namespace tools
+}  // namespace foolysh
+
+#endif
@@ -0,0 +1,565 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "drawlist.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "common.hpp"
+
+namespace foolysh {
+namespace scene {
+
+/**
+ * Corners of the quad of ``c`` (top left, top right, bottom left, bottom
+ * right), rotated clockwise around its center like ``SDL_RenderCopyEx``.
+ */
+static void
+quad_corners(const DrawCommand& c, double xs[4], double ys[4]) {
+    double sa = 0.0, ca = 1.0;
+    if (c.angle != 0.0) {
+        const double a = c.angle * to_rad;
+        sa = std::sin(a);
+        ca = std::cos(a);
+    }
+    const double ox = c.dst.x + c.center.x, oy = c.dst.y + c.center.y;
+    const double left = -c.center.x, top = -c.center.y;
+    const double right = c.dst.w - c.center.x, bottom = c.dst.h - c.center.y;
+    const double dx[4] = {left, right, left, right};
+    const double dy[4] = {top, top, bottom, bottom};
+    for (int k = 0; k < 4; ++k) {
+        xs[k] = ox + dx[k] * ca - dy[k] * sa;
+        ys[k] = oy + dx[k] * sa + dy[k] * ca;
+    }
+}
+
+/**
+ * Smallest rectangle containing ``a`` and ``b``, empty rectangles (w == 0)
+ * are ignored.
+ */
+static DrawRect
+unite(const DrawRect& a, const DrawRect& b) {
+    if (a.w == 0) {
+        return b;
+    }
+    if (b.w == 0) {
+        return a;
+    }
+    const int x = std::min(a.x, b.x), y = std::min(a.y, b.y);
+    return {x, y, std::max(a.x + a.w, b.x + b.w) - x,
+            std::max(a.y + a.h, b.y + b.h) - y};
+}
+
+static bool
+overlap(const DrawRect& a, const DrawRect& b) {
+    return a.x < b.x + b.w && b.x < a.x + a.w
+        && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+static bool
+same_rect(const DrawRect& a, const DrawRect& b) {
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+/**
+ * Set ``c.bounds`` to the pixel bounds of its rotated quad.
+ */
+static void
+update_bounds(DrawCommand& c) {
+    double xs[4], ys[4];
+    quad_corners(c, xs, ys);
+    const int min_x = static_cast<int>(
+        std::floor(*std::min_element(xs, xs + 4)));
+    const int min_y = static_cast<int>(
+        std::floor(*std::min_element(ys, ys + 4)));
+    c.bounds = {min_x, min_y,
+                static_cast<int>(std::ceil(*std::max_element(xs, xs + 4)))
+                - min_x,
+                static_cast<int>(std::ceil(*std::max_element(ys, ys + 4)))
+                - min_y};
+}
+
+/**
+ * Call ``fn`` with one untiled copy of the tiled command ``c`` per tile. Edge
+ * tiles show the matching part of the texture, all tiles rotate around the
+ * center of ``c`` and are flipped in place. Unrotated tiles outside of
+ * ``clip`` are skipped. Stops at and returns the first non-zero result.
+ */
+template <class Fn>
+static int
+for_each_tile(const DrawCommand& c, const DrawRect* clip, Fn fn) {
+    const DrawRect src = c.src.w ? c.src : DrawRect{0, 0, c.tex_w, c.tex_h};
+    DrawCommand t = c;
+    t.tile_w = t.tile_h = 0;
+    for (int ty = 0; ty < c.dst.h; ty += c.tile_h) {
+        for (int tx = 0; tx < c.dst.w; tx += c.tile_w) {
+            t.dst = {c.dst.x + tx, c.dst.y + ty,
+                     std::min(c.tile_w, c.dst.w - tx),
+                     std::min(c.tile_h, c.dst.h - ty)};
+            if (clip && c.angle == 0.0 && !overlap(t.dst, *clip)) {
+                continue;
+            }
+            t.src = {src.x, src.y, src.w * t.dst.w / c.tile_w,
+                     src.h * t.dst.h / c.tile_h};
+            if (c.flip & 1) {
+                t.src.x += src.w - t.src.w;
+            }
+            if (c.flip & 2) {
+                t.src.y += src.h - t.src.h;
+            }
+            t.center = {c.center.x - tx, c.center.y - ty};
+            const int r = fn(t);
+            if (r != 0) {
+                return r;
+            }
+        }
+    }
+    return 0;
+}
+
+static const size_t NO_COVER = static_cast<size_t>(-1);
+static const size_t UNKNOWN_COVER = static_cast<size_t>(-2);
+
+/**
+ * Register texture ``t`` for ``node_id``, replacing a previous one.
+ */
+void DrawList::
+set_texture(const size_t node_id, const DrawTexture& t) {
+    if (t.tiled && t.texture != nullptr && (t.w <= 0 || t.h <= 0)) {
+        throw std::invalid_argument("Expected positive tile size.");
+    }
+    if (node_id >= _textures.size()) {
+        _textures.resize(node_id + 1);
+        _registered.resize(node_id + 1, 0);
+    }
+    _textures[node_id] = t;
+    _registered[node_id] = 1;
+}
+
+/**
+ *
+ */
+void DrawList::
+remove_texture(const size_t node_id) {
+    if (node_id < _registered.size()) {
+        _registered[node_id] = 0;
+    }
+    if (node_id < _snapshots.size()) {
+        _snapshots[node_id].dirty = true;
+    }
+}
+
+/**
+ *
+ */
+bool DrawList::
+has_texture(const size_t node_id) const {
+    return node_id < _registered.size() && _registered[node_id];
+}
+
+/**
+ * Forget all textures, e.g. after the image scale changed.
+ */
+void DrawList::
+clear_textures() {
+    _registered.assign(_registered.size(), 0);
+}
+
+/**
+ * Register the cached bitmap of the subtree of ``node_id``. A null texture
+ * marks an empty subtree.
+ */
+void DrawList::
+set_cache(const size_t node_id, const DrawCache& c) {
+    if (node_id >= _caches.size()) {
+        _caches.resize(node_id + 1);
+        _cached.resize(node_id + 1, 0);
+    }
+    _caches[node_id] = c;
+    _cached[node_id] = 1;
+    if (node_id < _snapshots.size()) {
+        _snapshots[node_id].dirty = true;
+    }
+}
+
+/**
+ *
+ */
+void DrawList::
+remove_cache(const size_t node_id) {
+    if (node_id < _cached.size()) {
+        _cached[node_id] = 0;
+    }
+}
+
+/**
+ *
+ */
+bool DrawList::
+has_cache(const size_t node_id) const {
+    return node_id < _cached.size() && _cached[node_id];
+}
+
+/**
+ * Forget all caches, e.g. after the image scale changed.
+ */
+void DrawList::
+clear_caches() {
+    _cached.assign(_cached.size(), 0);
+}
+
+/**
+ * Append one command per node in ``nodes`` with a registered texture, in the
+ * order of ``nodes``. Nodes without a registered texture are collected in
+ * ``missing()``. Requires an up to date render column.
+ */
+void DrawList::
+build(SceneGraphDataHandler& sgdh, SmallList<size_t>& nodes,
+      const bool use_caches) {
+    const size_t n = nodes.size();
+    const bool caching = use_caches && sgdh.cache_nodes > 0;
+    if (caching) {
+        _covers.assign(sgdh.size(), UNKNOWN_COVER);
+        _emitted.assign(sgdh.size(), 0);
+    }
+    const size_t rows = sgdh.render.size();
+    const int* x = sgdh.render_x().data;
+    const int* y = sgdh.render_y().data;
+    const int* w = sgdh.render_w().data;
+    const int* h = sgdh.render_h().data;
+    const int* cx = sgdh.render_cx().data;
+    const int* cy = sgdh.render_cy().data;
+    const double* angle = sgdh.render_angle().data;
+    const int* depth = sgdh.r_depth_vec().data;
+    _commands.reserve(_commands.size() + n);
+    for (size_t i = 0; i < n; ++i) {
+        const size_t id = nodes[i];
+        if (id >= rows) {
+            throw std::range_error("Render column not computed for Node.");
+        }
+        if (caching) {
+            const size_t cover = _cover(sgdh, id);
+            if (cover != NO_COVER) {
+                const DrawCache& cache = _caches[cover];
+                if (!_emitted[cover] && cache.texture != nullptr) {
+                    _emitted[cover] = 1;
+                    DrawCommand c;
+                    c.texture = cache.texture;
+                    c.src = {0, 0, cache.rect.w, cache.rect.h};
+                    c.dst = {x[cover] + cache.rect.x, y[cover] + cache.rect.y,
+                             cache.rect.w, cache.rect.h};
+                    c.angle = 0.0;
+                    c.center = {cache.rect.w / 2, cache.rect.h / 2};
+                    c.flip = 0;
+                    c.tex_w = cache.rect.w;
+                    c.tex_h = cache.rect.h;
+                    c.tile_w = c.tile_h = 0;
+                    c.depth = depth[cover];
+                    c.node_id = cover;
+                    c.bounds = c.dst;
+                    _commands.push_back(c);
+                }
+                continue;
+            }
+        }
+        if (!has_texture(id)) {
+            _missing.push_back(id);
+            continue;
+        }
+        const DrawTexture& t = _textures[id];
+        if (t.texture == nullptr) {
+            continue;
+        }
+        DrawCommand c;
+        c.texture = t.texture;
+        c.src = t.src;
+        c.dst.x = x[id];
+        c.dst.y = y[id];
+        c.dst.w = t.fixed_size ? t.w : w[id];
+        c.dst.h = t.fixed_size ? t.h : h[id];
+        c.tile_w = t.tiled ? t.w : 0;
+        c.tile_h = t.tiled ? t.h : 0;
+        c.angle = angle[id];
+        c.center.x = cx[id];
+        c.center.y = cy[id];
+        c.flip = t.flip;
+        c.tex_w = t.tex_w;
+        c.tex_h = t.tex_h;
+        c.depth = depth[id];
+        c.node_id = id;
+        update_bounds(c);
+        _commands.push_back(c);
+    }
+}
+
+/**
+ * Outermost ancestor (or ``node_id`` itself) that is drawn from a
+ * valid cache, ``NO_COVER`` if there is none. Invalid caches met on the way
+ * are collected in ``_stale``. Results are memoized in ``_covers``.
+ */
+size_t DrawList::
+_cover(SceneGraphDataHandler& sgdh, const size_t node_id) {
+    const unsigned char* flag = sgdh.flag_vec().data;
+    const size_t* parent = sgdh.parent_vec().data;
+    size_t cover = NO_COVER;
+    size_t nid = node_id;
+    while (true) {
+        if (_covers[nid] != UNKNOWN_COVER) {
+            cover = _covers[nid];
+            break;
+        }
+        _chain.push_back(nid);
+        if (parent[nid] == nid) {
+            break;
+        }
+        nid = parent[nid];
+    }
+    // Resolve top down, the outermost valid cache covers the whole subtree
+    for (size_t i = _chain.size(); i-- > 0;) {
+        const size_t id = _chain[i];
+        if (cover == NO_COVER && (flag[id] & CACHE_AS_BITMAP)) {
+            if (!(flag[id] & CACHE_INVALID) && has_cache(id)) {
+                cover = id;
+            }
+            else {
+                _stale.push_back(id);
+            }
+        }
+        _covers[id] = cover;
+    }
+    _chain.clear();
+    return cover;
+}
+
+/**
+ * Drop all commands, missing nodes and stale caches, registered textures and
+ * caches are kept.
+ */
+void DrawList::
+clear() {
+    _commands.clear();
+    _missing.clear();
+    _stale.clear();
+}
+
+/**
+ * Union of the bounds of all commands, width 0 if empty.
+ */
+DrawRect DrawList::
+extent() const {
+    DrawRect r = {0, 0, 0, 0};
+    for (size_t i = 0; i < _commands.size(); ++i) {
+        r = unite(r, _commands[i].bounds);
+    }
+    return r;
+}
+
+/**
+ * Move all commands by ``dx``/``dy`` pixels.
+ */
+void DrawList::
+translate(const int dx, const int dy) {
+    for (size_t i = 0; i < _commands.size(); ++i) {
+        DrawCommand& c = _commands[i];
+        c.dst.x += dx;
+        c.dst.y += dy;
+        c.bounds.x += dx;
+        c.bounds.y += dy;
+    }
+}
+
+/**
+ * Issue all commands through ``fn`` (``SDL_RenderCopyEx``), optionally only
+ * those overlapping ``clip``. Stops at and returns the first non-zero result.
+ */
+int DrawList::
+submit(void* renderer, RenderCopyEx fn, const DrawRect* clip) const {
+    for (size_t i = 0; i < _commands.size(); ++i) {
+        const DrawCommand& c = _commands[i];
+        if (clip && !overlap(c.bounds, *clip)) {
+            continue;
+        }
+        const int r = c.tile_w == 0
+            ? fn(renderer, c.texture, c.src.w ? &c.src : nullptr, &c.dst,
+                 c.angle, &c.center, c.flip)
+            : for_each_tile(c, clip, [&](const DrawCommand& t) {
+                  return fn(renderer, t.texture, &t.src, &t.dst, t.angle,
+                            &t.center, t.flip);
+              });
+        if (r != 0) {
+            return r;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Issue all commands as textured quads through ``fn``
+ * (``SDL_RenderGeometry``), one call per run of commands with the same
+ * texture, optionally only those overlapping ``clip``. Stops at and returns
+ * the first non-zero result.
+ */
+int DrawList::
+submit_geometry(void* renderer, RenderGeometry fn, const DrawRect* clip) {
+    _batches = 0;
+    size_t i = 0;
+    const size_t n = _commands.size();
+    while (i < n) {
+        if (clip && !overlap(_commands[i].bounds, *clip)) {
+            ++i;
+            continue;
+        }
+        void* texture = _commands[i].texture;
+        _vertices.clear();
+        _indices.clear();
+        for (; i < n && _commands[i].texture == texture; ++i) {
+            const DrawCommand& c = _commands[i];
+            if (clip && !overlap(c.bounds, *clip)) {
+                continue;
+            }
+            if (c.tile_w == 0) {
+                _append_quad(c, static_cast<int>(_vertices.size()));
+                continue;
+            }
+            for_each_tile(c, clip, [&](const DrawCommand& t) {
+                _append_quad(t, static_cast<int>(_vertices.size()));
+                return 0;
+            });
+        }
+        ++_batches;
+        const int r = fn(renderer, texture, _vertices.data(),
+                         static_cast<int>(_vertices.size()), _indices.data(),
+                         static_cast<int>(_indices.size()));
+        if (r != 0) {
+            return r;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Append the quad of ``c``, rotated clockwise around its center like
+ * ``SDL_RenderCopyEx`` does, with ``base`` as index of its first vertex.
+ */
+void DrawList::
+_append_quad(const DrawCommand& c, const int base) {
+    double xs[4], ys[4];
+    quad_corners(c, xs, ys);
+    const DrawRect src = c.src.w ? c.src : DrawRect{0, 0, c.tex_w, c.tex_h};
+    float u0 = static_cast<float>(src.x) / c.tex_w;
+    float u1 = static_cast<float>(src.x + src.w) / c.tex_w;
+    float v0 = static_cast<float>(src.y) / c.tex_h;
+    float v1 = static_cast<float>(src.y + src.h) / c.tex_h;
+    if (c.flip & 1) {
+        std::swap(u0, u1);
+    }
+    if (c.flip & 2) {
+        std::swap(v0, v1);
+    }
+
+    const float u[4] = {u0, u1, u0, u1};
+    const float v[4] = {v0, v0, v1, v1};
+    for (int k = 0; k < 4; ++k) {
+        DrawVertex vert;
+        vert.x = static_cast<float>(xs[k]);
+        vert.y = static_cast<float>(ys[k]);
+        vert.r = vert.g = vert.b = vert.a = 255;
+        vert.u = u[k];
+        vert.v = v[k];
+        _vertices.push_back(vert);
+    }
+    const int quad[6] = {0, 1, 2, 2, 1, 3};
+    for (int k = 0; k < 6; ++k) {
+        _indices.push_back(base + quad[k]);
+    }
+}
+
+/**
+ * Compare the current commands with the previous call and return the union
+ * of old and new bounds of every command that was added, removed or changed
+ * in position, size, rotation, sprite or depth, or whose texture was removed
+ * since (the sprite may come back with new pixels at the same place). A width
+ * of 0 means nothing changed.
+ */
+DrawRect DrawList::
+update_damage() {
+    const unsigned current = ++_frame;
+    DrawRect damage = {0, 0, 0, 0};
+    for (size_t i = 0; i < _commands.size(); ++i) {
+        const DrawCommand& c = _commands[i];
+        if (c.node_id >= _snapshots.size()) {
+            Snapshot empty;
+            empty.frame = 0;
+            empty.dirty = false;
+            _snapshots.resize(c.node_id + 1, empty);
+        }
+        Snapshot& s = _snapshots[c.node_id];
+        const bool drawn = s.frame != 0 && s.frame == current - 1;
+        if (!drawn || s.texture != c.texture || !same_rect(s.src, c.src)
+            || !same_rect(s.dst, c.dst) || s.center.x != c.center.x
+            || s.center.y != c.center.y || s.angle != c.angle
+            || s.flip != c.flip || s.depth != c.depth || s.dirty) {
+            damage = unite(damage, c.bounds);
+            if (drawn) {
+                damage = unite(damage, s.bounds);
+            }
+        }
+        s.texture = c.texture;
+        s.src = c.src;
+        s.dst = c.dst;
+        s.bounds = c.bounds;
+        s.center = c.center;
+        s.angle = c.angle;
+        s.flip = c.flip;
+        s.depth = c.depth;
+        s.dirty = false;
+        s.frame = current;
+    }
+    for (size_t i = 0; i < _drawn.size(); ++i) {
+        const Snapshot& s = _snapshots[_drawn[i]];
+        if (s.frame == current - 1) {
+            damage = unite(damage, s.bounds);
+        }
+    }
+    _drawn.clear();
+    for (size_t i = 0; i < _commands.size(); ++i) {
+        _drawn.push_back(_commands[i].node_id);
+    }
+    return damage;
+}
+
+/**
+ *
+ */
+const DrawCommand& DrawList::
+get(const size_t i) const {
+    if (i >= _commands.size()) {
+        throw std::range_error("Index out of range");
+    }
+    return _commands[i];
+}
+
+
+}  // namespace scene
+}  // namespace foolysh
@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * Packed list of draw commands, built from a depth sorted query result and the
+ * render column computed by ``process_render``.
+ *
+ * Textures are registered per node id as opaque pointers, so this does not
+ * depend on SDL headers. ``submit`` takes the address of
+ * ``SDL_RenderCopyEx`` and issues the whole list without returning to Python.
+ * ``submit_geometry`` instead turns the commands into rotated quads and issues
+ * one ``SDL_RenderGeometry`` call per run of commands sharing a texture, which
+ * pays off when sprites share atlas pages. Blend mode is a texture property in
+ * SDL, so a texture change also covers a blend mode change.
+ *
+ * ``update_damage`` compares the commands against the previous frame and
+ * returns the union of old and new pixel bounds of everything that moved,
+ * changed sprite, depth or visibility. Both submit variants accept that
+ * rectangle as clip and skip commands outside of it.
+ *
+ * Nodes flagged ``CACHE_AS_BITMAP`` with a valid registered cache are drawn
+ * as one command from that bitmap and their subtree is skipped. Caches that
+ * are invalid or not registered yet are reported by ``stale_caches()`` and
+ * their subtree is drawn as usual. To render a cache, build the subtree with
+ * ``use_caches = false``, move it to the origin with ``translate`` and submit
+ * into the target texture.
+ *
+ * Tiled textures repeat across their Node instead of being stretched. They
+ * stay one command (and one entry for damage tracking) and are only split into
+ * one copy or quad per tile on submit. In ``submit_geometry`` all tiles share
+ * the texture and go out in the same call.
+ */
+
+#ifndef DRAWLIST_HPP
+#define DRAWLIST_HPP
+
+#include <vector>
+
+#include "node.hpp"
+
+namespace foolysh {
+namespace scene {
+    // Layout compatible with SDL_Rect and SDL_Point.
+    struct DrawRect {
+        int x, y, w, h;
+    };
+
+    struct DrawPoint {
+        int x, y;
+    };
+
+    // Layout compatible with SDL_Vertex.
+    struct DrawVertex {
+        float x, y;
+        unsigned char r, g, b, a;
+        float u, v;
+    };
+
+    // Signature of SDL_RenderCopyEx.
+    typedef int (*RenderCopyEx)(void*, void*, const DrawRect*,
+                                const DrawRect*, double, const DrawPoint*,
+                                int);
+
+    // Signature of SDL_RenderGeometry.
+    typedef int (*RenderGeometry)(void*, void*, const DrawVertex*, int,
+                                  const int*, int);
+
+    /**
+     * Texture of a Node. A ``src`` width of 0 uses the whole texture,
+     * ``tex_w``/``tex_h`` is the size of the whole texture.
+     * ``fixed_size`` nodes are drawn at ``w``/``h`` instead of the size from
+     * the render column (e.g. text that is rasterized at its final size).
+     * ``tiled`` nodes repeat the texture at ``w``/``h`` across their size,
+     * starting at their top left corner.
+     * A null ``texture`` marks a Node that has nothing to draw.
+     */
+    struct DrawTexture {
+        void* texture;
+        DrawRect src;
+        int w, h;
+        int tex_w, tex_h;
+        int flip;
+        bool fixed_size;
+        bool tiled;
+    };
+
+    /**
+     * Bitmap of a cached subtree. ``rect`` x/y is the offset of its top left
+     * corner relative to the render position of the cached Node.
+     */
+    struct DrawCache {
+        void* texture;
+        DrawRect rect;
+    };
+
+    struct DrawCommand {
+        void* texture;
+        DrawRect src;
+        DrawRect dst;
+        double angle;
+        DrawPoint center;
+        int flip;
+        int tex_w, tex_h;
+        int tile_w, tile_h;  // Tile size of tiled commands, otherwise 0
+        int depth;
+        DrawRect bounds;  // Axis aligned pixel bounds of the rotated quad
+        size_t node_id;
+    };
+
+    class DrawList {
+    public:
+        DrawList() {}
+
+        void set_texture(const size_t node_id, const DrawTexture& t);
+        void remove_texture(const size_t node_id);
+        bool has_texture(const size_t node_id) const;
+        void clear_textures();
+        void set_cache(const size_t node_id, const DrawCache& c);
+        void remove_cache(const size_t node_id);
+        bool has_cache(const size_t node_id) const;
+        void clear_caches();
+
+        void build(SceneGraphDataHandler& sgdh, SmallList<size_t>& nodes,
+                   const bool use_caches = true);
+        void clear();
+        DrawRect extent() const;
+        void translate(const int dx, const int dy);
+        int submit(void* renderer, RenderCopyEx fn,
+                   const DrawRect* clip = nullptr) const;
+        int submit_geometry(void* renderer, RenderGeometry fn,
+                            const DrawRect* clip = nullptr);
+        size_t batch_count() const { return _batches; }
+        DrawRect update_damage();
+
+        size_t size() const { return _commands.size(); }
+        const DrawCommand& get(const size_t i) const;
+        const std::vector<size_t>& missing() const { return _missing; }
+        const std::vector<size_t>& stale_caches() const { return _stale; }
+
+    private:
+        struct Snapshot {
+            void* texture;
+            DrawRect src, dst, bounds;
+            DrawPoint center;
+            double angle;
+            int flip, depth;
+            bool dirty;
+            unsigned frame;
+        };
+
+        void _append_quad(const DrawCommand& c, const int base);
+        size_t _cover(SceneGraphDataHandler& sgdh, const size_t node_id);
+
+        std::vector<DrawTexture> _textures;
+        std::vector<unsigned char> _registered;
+        std::vector<DrawCommand> _commands;
+        std::vector<size_t> _missing;
+        std::vector<DrawCache> _caches;
+        std::vector<unsigned char> _cached;
+        std::vector<size_t> _stale;
+        std::vector<size_t> _covers;  // Per build: covering cache of a node
+        std::vector<size_t> _chain;
+        std::vector<unsigned char> _emitted;
+        std::vector<DrawVertex> _vertices;
+        std::vector<int> _indices;
+        size_t _batches = 0;
+        std::vector<Snapshot> _snapshots;
+        std::vector<size_t> _drawn;
+        unsigned _frame = 0;
+    };
+}  // namespace scene
+}  // namespace foolysh
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ *
+ * Provides a fast approximation of sine and cosine for transforms. The
+ * argument is reduced to [-pi/4, pi/4] and evaluated with minimax polynomials
+ * (Cephes single precision coefficients), the absolute error is below 1e-7
+ * for arguments up to a few thousand radians. The loops are free of branches
+ * so the array variant can be vectorized by the compiler, batch.hpp provides
+ * an explicitly vectorized version with runtime dispatch.
+ */
+
+#ifndef FASTMATH_HPP
+#define FASTMATH_HPP
+
+#include <cmath>
+#include <cstddef>
+
+namespace foolysh {
+namespace tools {
+
+    /**
+     * Set ``s`` and ``c`` to the approximate sine and cosine of ``a``
+     * (radians).
+     */
+    inline void fast_sincos(const double a, double& s, double& c) noexcept {
+        // Cody-Waite reduction by multiples of pi/2
+        const double k = std::nearbyint(a * 0.63661977236758134308);
+        const double r = (a - k * 1.57079632679489655800e+00)
+                         - k * 6.12323399573676603587e-17;
+        const double r2 = r * r;
+        const double ps = r + r * r2 * (-1.6666654611e-1
+                          + r2 * (8.3321608736e-3 + r2 * -1.9515295891e-4));
+        const double pc = 1.0 - 0.5 * r2 + r2 * r2 * (4.166664568298827e-2
+                          + r2 * (-1.388731625493765e-3
+                          + r2 * 2.443315711809948e-5));
+        const long q = static_cast<long>(k) & 3;
+        const double ss = (q & 1) ? pc : ps;
+        const double cc = (q & 1) ? ps : pc;
+        s = (q & 2) ? -ss : ss;
+        c = ((q + 1) & 2) ? -cc : cc;
+    }
+
+    /**
+     * Array version of ``fast_sincos``.
+     */
+    inline void fast_sincos(const double* a, double* s, double* c,
+                            const size_t n) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+            fast_sincos(a[i], s[i], c[i]);
+        }
+    }
+
+    /**
+     * Sine and cosine of ``a`` (radians), approximated if ``fast`` is true.
+     */
+    inline void sin_cos(const double a, double& s, double& c,
+                        const bool fast) noexcept {
+        if (fast) {
+            fast_sincos(a, s, c);
+        }
+        else {
+            s = std::sin(a);
+            c = std::cos(a);
+        }
+    }
+
+}  // namespace tools
+}  // namespace foolysh
+
+#endif
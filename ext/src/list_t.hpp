@@ -23,11 +23,16 @@
  * Provides an indexed free list with constant-time removals from anywhere
  * in the list without invalidating indices. T must be trivially constructible
  * and destructible.
+ *
+ * ``ExtFreeList`` additionally tracks occupancy in a packed bitset, so live
+ * elements can be visited in proportion to their number rather than to the
+ * size of the list.
  */
 
 #ifndef LIST_T_HPP
 #define LIST_T_HPP
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <algorithm>
@@ -35,6 +40,22 @@
 
 namespace foolysh {
 namespace tools {
+    /**
+     * Index of the lowest set bit in ``v``, ``v`` must not be 0.
+     */
+    inline int count_trailing_zeros(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(v);
+#else
+        int n = 0;
+        while (!(v & 1u)) {
+            v >>= 1;
+            ++n;
+        }
+        return n;
+#endif
+    }
+
     template <class T>
     class FreeList {
     public:
@@ -58,15 +79,21 @@ namespace tools {
     };
 
 
-    template <class T>
+    /**
+     * Stack-like list with an inline capacity of 128 elements. Storage beyond
+     * that is requested from ``Alloc``, e.g. an ``ArenaAllocator`` for
+     * scratch lists that only live for the duration of a frame.
+     */
+    template <class T, class Alloc = std::allocator<T>>
     class SmallList {
     public:
         SmallList();
+        explicit SmallList(const Alloc& alloc);
         ~SmallList();
-        SmallList(const SmallList<T>& other);
-        SmallList(SmallList<T>&& other) noexcept;
-        SmallList<T>& operator=(const SmallList<T>& other);
-        SmallList<T>& operator=(SmallList<T>&& other) noexcept;
+        SmallList(const SmallList<T, Alloc>& other);
+        SmallList(SmallList<T, Alloc>&& other) noexcept;
+        SmallList<T, Alloc>& operator=(const SmallList<T, Alloc>& other);
+        SmallList<T, Alloc>& operator=(SmallList<T, Alloc>&& other) noexcept;
         void push_back(const T& element);
         T pop_back();
         size_t size();
@@ -77,7 +104,7 @@ namespace tools {
         const T& operator[](const size_t n) const;
     private:
         T _a[128];
-        std::vector<T> _v;
+        std::vector<T, Alloc> _v;
         size_t _size;
         bool _is_vec;
     };
@@ -91,7 +118,9 @@ namespace tools {
         void erase(int n);
         void clear();
         int range() const;
-        bool active(int n);
+        bool active(int n) const;
+        template <class F>
+        void for_each_active(F f) const;
         T& operator[](int n);
         const T& operator[](int n) const;
 
@@ -99,9 +128,12 @@ namespace tools {
         struct FreeElement {
             T element;
             int next;
-            bool free = false;
         };
+        void _set(int n);
+        void _unset(int n);
+
         std::vector<FreeElement> data;
+        std::vector<uint64_t> occupied;
         int first_free;
         int free_count;
     };
@@ -192,20 +224,28 @@ operator[](int n) const {
 /**
  *
  */
-template <class T>
-SmallList<T>::SmallList() : _size(0), _is_vec(false) {}
+template <class T, class Alloc>
+SmallList<T, Alloc>::SmallList() : _size(0), _is_vec(false) {}
+
+/**
+ * Use ``alloc`` for storage beyond the inline capacity.
+ */
+template <class T, class Alloc>
+SmallList<T, Alloc>::SmallList(const Alloc& alloc)
+    : _v(alloc), _size(0), _is_vec(false) {}
 
 /**
  *
  */
-template <class T>
-SmallList<T>::~SmallList() {}
+template <class T, class Alloc>
+SmallList<T, Alloc>::~SmallList() {}
 
 /**
  *
  */
-template <class T>
-SmallList<T>::SmallList(const SmallList<T>& other) {
+template <class T, class Alloc>
+SmallList<T, Alloc>::SmallList(const SmallList<T, Alloc>& other)
+    : _v(other._v.get_allocator()) {
     if (other._is_vec) {
         _is_vec = true;
         _v.insert(_v.begin(), other._v.begin(), other._v.end());
@@ -220,8 +260,9 @@ SmallList<T>::SmallList(const SmallList<T>& other) {
 /**
  *
  */
-template <class T>
-SmallList<T>::SmallList(SmallList<T>&& other) noexcept {
+template <class T, class Alloc>
+SmallList<T, Alloc>::SmallList(SmallList<T, Alloc>&& other) noexcept
+    : _v(other._v.get_allocator()) {
     if (other._is_vec) {
         _is_vec = true;
         _v.swap(other._v);
@@ -236,18 +277,18 @@ SmallList<T>::SmallList(SmallList<T>&& other) noexcept {
 /**
  *
  */
-template <class T>
-SmallList<T>& SmallList<T>::
-operator=(const SmallList<T>& other) {
-    return *this = SmallList(other);
+template <class T, class Alloc>
+SmallList<T, Alloc>& SmallList<T, Alloc>::
+operator=(const SmallList<T, Alloc>& other) {
+    return *this = SmallList<T, Alloc>(other);
 }
 
 /**
  *
  */
-template <class T>
-SmallList<T>& SmallList<T>::
-operator=(SmallList<T>&& other) noexcept {
+template <class T, class Alloc>
+SmallList<T, Alloc>& SmallList<T, Alloc>::
+operator=(SmallList<T, Alloc>&& other) noexcept {
     if (other._is_vec) {
         _is_vec = true;
         _v.swap(other._v);
@@ -263,8 +304,8 @@ operator=(SmallList<T>&& other) noexcept {
 /**
  *
  */
-template <class T>
-void SmallList<T>::
+template <class T, class Alloc>
+void SmallList<T, Alloc>::
 push_back(const T& element) {
     if (_is_vec) {
         _v.push_back(element);
@@ -288,8 +329,8 @@ push_back(const T& element) {
 /**
  *
  */
-template <class T>
-T SmallList<T>::
+template <class T, class Alloc>
+T SmallList<T, Alloc>::
 pop_back() {
     if (_is_vec) {
         T ret = _v.back();
@@ -303,8 +344,8 @@ pop_back() {
 /**
  *
  */
-template <class T>
-size_t SmallList<T>::
+template <class T, class Alloc>
+size_t SmallList<T, Alloc>::
 size() {
     if (_is_vec) {
         return _v.size();
@@ -315,8 +356,8 @@ size() {
 /**
  *
  */
-template <class T>
-void SmallList<T>::
+template <class T, class Alloc>
+void SmallList<T, Alloc>::
 reverse() {
     if (_is_vec) {
         std::reverse(_v.begin(), _v.end());
@@ -331,8 +372,8 @@ reverse() {
 /**
  *
  */
-template <class T>
-void SmallList<T>::
+template <class T, class Alloc>
+void SmallList<T, Alloc>::
 reserve(const size_t size) {
     if (size <= 128 && !_is_vec) {
         return;
@@ -352,8 +393,8 @@ reserve(const size_t size) {
 /**
  *
  */
-template <class T>
-void SmallList<T>::
+template <class T, class Alloc>
+void SmallList<T, Alloc>::
 clear() {
     if (_is_vec) {
         _v.clear();
@@ -364,8 +405,8 @@ clear() {
 /**
  *
  */
-template <class T>
-T& SmallList<T>::
+template <class T, class Alloc>
+T& SmallList<T, Alloc>::
 operator[](const size_t n) {
     if (_is_vec) {
         return _v[n];
@@ -376,8 +417,8 @@ operator[](const size_t n) {
 /**
  *
  */
-template <class T>
-const T& SmallList<T>::
+template <class T, class Alloc>
+const T& SmallList<T, Alloc>::
 operator[](const size_t n) const {
     if (_is_vec) {
         return _v[n];
@@ -406,16 +447,19 @@ insert(const T& element) {
         const int index = first_free;
         first_free = data[first_free].next;
         data[index].element = element;
-        data[index].free = false;
+        _set(index);
         --free_count;
         return index;
     }
     else {
-        //FreeElement fe();
-        //fe.e.element = element;
         data.push_back(FreeElement());
         data.back().element = element;
-        return static_cast<int>(data.size() - 1);
+        const int index = static_cast<int>(data.size() - 1);
+        if (static_cast<size_t>(index) / 64 >= occupied.size()) {
+            occupied.push_back(0);
+        }
+        _set(index);
+        return index;
     }
 }
 
@@ -426,7 +470,7 @@ template <class T>
 void ExtFreeList<T>::
 erase(int n) {
     data[n].next = first_free;
-    data[n].free = true;
+    _unset(n);
     first_free = n;
     ++free_count;
     if ((int) data.size() == free_count) {
@@ -441,12 +485,13 @@ template <class T>
 void ExtFreeList<T>::
 clear() {
     data.clear();
+    occupied.clear();
     first_free = -1;
     free_count = 0;
 }
 
 /**
- *
+ * Number of live elements.
  */
 template <class T>
 int ExtFreeList<T>::
@@ -459,13 +504,30 @@ range() const {
  */
 template <class T>
 bool ExtFreeList<T>::
-active(int n) {
+active(int n) const {
     if (n < (int) data.size() && n > -1) {
-        return (data[n].free) ? false : true;
+        return (occupied[n >> 6] >> (n & 63)) & 1u;
     }
     return false;
 }
 
+/**
+ * Call ``f(index)`` for every live element in ascending index order. Skips
+ * 64 free slots per empty word of the occupancy bitset.
+ */
+template <class T>
+template <class F>
+void ExtFreeList<T>::
+for_each_active(F f) const {
+    for (size_t w = 0; w < occupied.size(); ++w) {
+        uint64_t bits = occupied[w];
+        while (bits) {
+            f(static_cast<int>(w * 64) + count_trailing_zeros(bits));
+            bits &= bits - 1;
+        }
+    }
+}
+
 /**
  *
  */
@@ -484,6 +546,24 @@ operator[](int n) const {
     return data[n].element;
 }
 
+/**
+ *
+ */
+template <class T>
+void ExtFreeList<T>::
+_set(int n) {
+    occupied[n >> 6] |= uint64_t(1) << (n & 63);
+}
+
+/**
+ *
+ */
+template <class T>
+void ExtFreeList<T>::
+_unset(int n) {
+    occupied[n >> 6] &= ~(uint64_t(1) << (n & 63));
+}
+
 
 }  // namespace tools
 }  // namespace foolysh
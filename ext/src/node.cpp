@@ -26,6 +26,7 @@
 
 #include "node.hpp"
 #include "common.hpp"
+#include "fastmath.hpp"
 
 #include <cmath>
 #include <stdexcept>
@@ -33,8 +34,28 @@
 namespace foolysh {
 namespace scene {
 
+using foolysh::tools::ArenaAllocator;
+using foolysh::tools::ArenaScope;
 using foolysh::tools::SmallList;
 using foolysh::tools::Vec2;
+using foolysh::tools::Vec2d;
+
+/**
+ * Sine and cosine for a clockwise rotation by ``deg`` degrees, approximated
+ * if the precision mode of ``sgdh`` allows it.
+ **/
+static inline void
+rotation(const SceneGraphDataHandler& sgdh, const double deg, double& sa,
+         double& ca) {
+    if (sgdh.fast_trig) {
+        tools::fast_sincos(clamp_angle(deg) * -to_rad, sa, ca);
+    }
+    else {
+        const double rad = deg * -to_rad;
+        sa = std::sin(rad);
+        ca = std::cos(rad);
+    }
+}
 
 /* SceneGraphDataHandler */
 
@@ -46,32 +67,12 @@ get_empty() {
     if (free_vec.size()) {
         const size_t node_id = free_vec.back();
         free_vec.pop_back();
-        flag_vec[node_id] = 0;
+        flag_vec()[node_id] = 0;
+        ref_vec()[node_id] = 1;
         return node_id;
     }
-    pos_x.push_back(0.0);
-    pos_y.push_back(0.0);
-    r_pos_x.push_back(0.0);
-    r_pos_y.push_back(0.0);
-    o_pos_x.push_back(0.0);
-    o_pos_y.push_back(0.0);
-    scale_x.push_back(0.0);
-    scale_y.push_back(0.0);
-    r_scale_x.push_back(0.0);
-    r_scale_y.push_back(0.0);
-    size_x.push_back(0.0);
-    size_y.push_back(0.0);
-    rotation_center_x.push_back(0.0);
-    rotation_center_y.push_back(0.0);
-    angle_vec.push_back(0.0);
-    r_angle_vec.push_back(0.0);
-    depth_vec.push_back(0);
-    r_depth_vec.push_back(0);
-    flag_vec.push_back(0);
-    origin_vec.push_back(TOP_LEFT);
-    parent_vec.push_back(0);
-    ref_vec.push_back(1);
-    return pos_x.size() - 1;
+    return data.push_back(0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+                          0.0, 0.0, 0.0, 0.0, 0.0, 0, 0, 0, TOP_LEFT, 0, 1);
 }
 
 /**
@@ -79,11 +80,15 @@ get_empty() {
  **/
 void SceneGraphDataHandler::
 erase(const size_t node_id) {
-    --ref_vec[node_id];
-    if (ref_vec[node_id]) {
+    --ref_vec()[node_id];
+    if (ref_vec()[node_id]) {
         return;
     }
-    flag_vec[node_id] = flag_vec[node_id] | FREE;
+    invalidate_cache(*this, node_id);
+    if (flag_vec()[node_id] & CACHE_AS_BITMAP) {
+        --cache_nodes;
+    }
+    flag_vec()[node_id] = flag_vec()[node_id] | FREE;
     free_vec.push_back(node_id);
 }
 
@@ -92,28 +97,16 @@ erase(const size_t node_id) {
  **/
 void SceneGraphDataHandler::
 reserve(const size_t size) {
-    pos_x.reserve(size);
-    pos_y.reserve(size);
-    r_pos_x.reserve(size);
-    r_pos_y.reserve(size);
-    o_pos_x.reserve(size);
-    o_pos_y.reserve(size);
-    scale_x.reserve(size);
-    scale_y.reserve(size);
-    r_scale_x.reserve(size);
-    r_scale_y.reserve(size);
-    size_x.reserve(size);
-    size_y.reserve(size);
-    rotation_center_x.reserve(size);
-    rotation_center_y.reserve(size);
-    angle_vec.reserve(size);
-    r_angle_vec.reserve(size);
-    depth_vec.reserve(size);
-    r_depth_vec.reserve(size);
-    flag_vec.reserve(size);
-    origin_vec.reserve(size);
-    parent_vec.reserve(size);
-    ref_vec.reserve(size);
+    data.reserve(size);
+}
+
+/**
+ * Release all scratch memory used during the frame. Call once per frame,
+ * after traversal and queries are done.
+ **/
+void SceneGraphDataHandler::
+reset_arena() {
+    arena.reset();
 }
 
 /* Node */
@@ -124,25 +117,25 @@ reserve(const size_t size) {
 Node::
 Node(SceneGraphDataHandler& sgdh) : sgdh(sgdh) {
     node_id = sgdh.get_empty();
-    sgdh.pos_x[node_id] = 0.0;
-    sgdh.pos_y[node_id] = 0.0;
-    sgdh.r_pos_x[node_id] = 0.0;
-    sgdh.r_pos_y[node_id] = 0.0;
-    sgdh.o_pos_x[node_id] = 0.0;
-    sgdh.o_pos_y[node_id] = 0.0;
-    sgdh.scale_x[node_id] = 1.0;
-    sgdh.scale_y[node_id] = 1.0;
-    sgdh.size_x[node_id] = 0.0;
-    sgdh.size_y[node_id] = 0.0;
-    sgdh.rotation_center_x[node_id] = 0.0;
-    sgdh.rotation_center_y[node_id] = 0.0;
-    sgdh.angle_vec[node_id] = 0.0;
-    sgdh.r_angle_vec[node_id] = 0.0;
-    sgdh.depth_vec[node_id] = 1;
-    sgdh.r_depth_vec[node_id] = 1;
-    sgdh.flag_vec[node_id] = DIRTY;
-    sgdh.origin_vec[node_id] = TOP_LEFT;
-    sgdh.parent_vec[node_id] = node_id;
+    sgdh.pos_x()[node_id] = 0.0;
+    sgdh.pos_y()[node_id] = 0.0;
+    sgdh.r_pos_x()[node_id] = 0.0;
+    sgdh.r_pos_y()[node_id] = 0.0;
+    sgdh.o_pos_x()[node_id] = 0.0;
+    sgdh.o_pos_y()[node_id] = 0.0;
+    sgdh.scale_x()[node_id] = 1.0;
+    sgdh.scale_y()[node_id] = 1.0;
+    sgdh.size_x()[node_id] = 0.0;
+    sgdh.size_y()[node_id] = 0.0;
+    sgdh.rotation_center_x()[node_id] = 0.0;
+    sgdh.rotation_center_y()[node_id] = 0.0;
+    sgdh.angle_vec()[node_id] = 0.0;
+    sgdh.r_angle_vec()[node_id] = 0.0;
+    sgdh.depth_vec()[node_id] = 1;
+    sgdh.r_depth_vec()[node_id] = 1;
+    sgdh.flag_vec()[node_id] = DIRTY;
+    sgdh.origin_vec()[node_id] = TOP_LEFT;
+    sgdh.parent_vec()[node_id] = node_id;
 }
 
 /**
@@ -151,7 +144,7 @@ Node(SceneGraphDataHandler& sgdh) : sgdh(sgdh) {
 Node::
 Node(SceneGraphDataHandler& sgdh, const size_t node_id)
  : sgdh(sgdh), node_id(node_id) {
-     ++sgdh.ref_vec[node_id];
+     ++sgdh.ref_vec()[node_id];
 }
 
 /**
@@ -167,7 +160,7 @@ Node::
  **/
 Node::
 Node(const Node& other) : sgdh(other.sgdh), node_id(other.node_id) {
-    ++sgdh.ref_vec[node_id];
+    ++sgdh.ref_vec()[node_id];
 }
 
 /**
@@ -186,7 +179,7 @@ operator=(const Node& other) {
     }
     sgdh = other.sgdh;
     node_id = other.node_id;
-    ++sgdh.ref_vec[node_id];
+    ++sgdh.ref_vec()[node_id];
     return *this;
 }
 
@@ -220,8 +213,9 @@ attach_node() {
  **/
 void Node::
 reparent_to(Node& parent) {
-    if (sgdh.parent_vec[node_id] != parent.node_id) {
-        sgdh.parent_vec[node_id] = parent.node_id;
+    if (sgdh.parent_vec()[node_id] != parent.node_id) {
+        invalidate_cache(sgdh, node_id);
+        sgdh.parent_vec()[node_id] = parent.node_id;
         propagate_dirty();
     }
 }
@@ -231,8 +225,9 @@ reparent_to(Node& parent) {
  **/
 void Node::
 reparent_to(const size_t parent) {
-    if (sgdh.parent_vec[node_id] != parent) {
-        sgdh.parent_vec[node_id] = parent;
+    if (sgdh.parent_vec()[node_id] != parent) {
+        invalidate_cache(sgdh, node_id);
+        sgdh.parent_vec()[node_id] = parent;
         propagate_dirty();
     }
 }
@@ -247,8 +242,8 @@ traverse(const bool local) {
         return scene_traverse(sgdh, node_id);
     }
     size_t root = node_id;
-    while (sgdh.parent_vec[root] != root) {
-        root = sgdh.parent_vec[root];
+    while (sgdh.parent_vec()[root] != root) {
+        root = sgdh.parent_vec()[root];
     }
     return scene_traverse(sgdh, root);
 }
@@ -258,24 +253,28 @@ traverse(const bool local) {
  **/
 SmallList<size_t> Node::
 query(AABB& aabb, const bool depth_sorted) {
-    SmallList<size_t> to_process;
-    std::vector<DepthSort> v;
+    ArenaScope scope(sgdh.arena);
+    NodeList to_process(ArenaAllocator<size_t>(&sgdh.arena));
+    std::vector<DepthSort, ArenaAllocator<DepthSort>> v(
+        ArenaAllocator<DepthSort>(&sgdh.arena));
+    SmallList<size_t> result;
+    const Box query_box(aabb);
 
     to_process.push_back(node_id);
     while(to_process.size()) {
         const size_t pid = to_process.pop_back();
-        if (sgdh.flag_vec[pid] & HIDDEN || sgdh.flag_vec[pid] & FREE) {
+        if (sgdh.flag_vec()[pid] & HIDDEN || sgdh.flag_vec()[pid] & FREE) {
             continue;
         }
         Node n(sgdh, pid);
-        if (aabb.overlap(n.get_aabb())) {
+        if (query_box.overlap(n.get_box())) {
             v.emplace_back(DepthSort(n.node_id, n.get_relative_depth()));
         }
-        for (size_t i = 0; i < sgdh.parent_vec.size(); ++i) {
+        for (size_t i = 0; i < sgdh.size(); ++i) {
             if (i == pid) {
                 continue;
             }
-            if (sgdh.parent_vec[i] == pid) {
+            if (sgdh.parent_vec()[i] == pid) {
                 to_process.push_back(i);
             }
         }
@@ -283,10 +282,11 @@ query(AABB& aabb, const bool depth_sorted) {
     if (depth_sorted) {
         std::sort(v.begin(), v.end());
     }
+    result.reserve(v.size());
     for (auto& i : v) {
-        to_process.push_back(i.node_id);
+        result.push_back(i.node_id);
     }
-    return to_process;
+    return result;
 }
 
 /**
@@ -294,17 +294,17 @@ query(AABB& aabb, const bool depth_sorted) {
  **/
 bool Node::
 hidden() {
-    if (sgdh.flag_vec[node_id] & HIDDEN) {
+    if (sgdh.flag_vec()[node_id] & HIDDEN) {
         return true;
     }
     size_t nid = node_id;
-    size_t parent = sgdh.parent_vec[node_id];
+    size_t parent = sgdh.parent_vec()[node_id];
     while (parent != nid) {
-        if (sgdh.flag_vec[nid] & HIDDEN) {
+        if (sgdh.flag_vec()[nid] & HIDDEN) {
             return true;
         }
         nid = parent;
-        parent = sgdh.parent_vec[nid];
+        parent = sgdh.parent_vec()[nid];
     }
     return false;
 }
@@ -314,10 +314,11 @@ hidden() {
  **/
 void Node::
 hide() {
-    if (sgdh.flag_vec[node_id] & HIDDEN) {
+    if (sgdh.flag_vec()[node_id] & HIDDEN) {
         return;
     }
-    sgdh.flag_vec[node_id] = sgdh.flag_vec[node_id] | HIDDEN;
+    sgdh.flag_vec()[node_id] = sgdh.flag_vec()[node_id] | HIDDEN;
+    invalidate_cache(sgdh, node_id);
 }
 
 /**
@@ -325,27 +326,69 @@ hide() {
  **/
 void Node::
 show() {
-    if (!(sgdh.flag_vec[node_id] & HIDDEN)) {
+    if (!(sgdh.flag_vec()[node_id] & HIDDEN)) {
         return;
     }
-    sgdh.flag_vec[node_id] = sgdh.flag_vec[node_id] ^ HIDDEN;
+    sgdh.flag_vec()[node_id] = sgdh.flag_vec()[node_id] ^ HIDDEN;
     propagate_dirty();
 }
 
 /**
- * Propagate the dirty flag to all attached nodes.
+ * Remove the Node and all its descendants from the scene. Every node of the
+ * subtree is detached and becomes its own root, so a node that outlives the
+ * removal never ends up below a reused id. Returns the removed node ids.
+ **/
+SmallList<size_t> Node::
+remove() {
+    SmallList<size_t> nodes;
+    invalidate_cache(sgdh, node_id);
+    nodes.push_back(node_id);
+    size_t current = 0;
+    while (nodes.size() > current) {
+        const size_t pid = nodes[current++];
+        for (size_t i = 0; i < sgdh.size(); ++i) {
+            if (i == pid || sgdh.flag_vec()[i] & FREE) {
+                continue;
+            }
+            if (sgdh.parent_vec()[i] == pid) {
+                nodes.push_back(i);
+            }
+        }
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        sgdh.parent_vec()[nodes[i]] = nodes[i];
+        sgdh.flag_vec()[nodes[i]] = sgdh.flag_vec()[nodes[i]] | DIRTY;
+    }
+    return nodes;
+}
+
+/**
+ * Propagate the dirty flag to all attached nodes and invalidate the cached
+ * bitmaps the change shows up in. ``moved`` means only the position of this
+ * Node changed, which keeps cached bitmaps in its subtree valid, as they are
+ * drawn relative to their render position.
  **/
-void Node::propagate_dirty() {
-    SmallList<size_t> to_process;
+void Node::propagate_dirty(const bool moved) {
+    const size_t parent = sgdh.parent_vec()[node_id];
+    if (parent != node_id) {
+        invalidate_cache(sgdh, parent);
+    }
+    const bool invalidate = sgdh.cache_nodes && !moved;
+    ArenaScope scope(sgdh.arena);
+    NodeList to_process(ArenaAllocator<size_t>(&sgdh.arena));
     to_process.push_back(node_id);
     while (to_process.size()) {
         const size_t child_node_id = to_process.pop_back();
-        sgdh.flag_vec[child_node_id] = sgdh.flag_vec[child_node_id] | DIRTY;
-        for (size_t i = 0; i < sgdh.parent_vec.size(); ++i) {
+        unsigned char& flag = sgdh.flag_vec()[child_node_id];
+        flag = flag | DIRTY;
+        if (invalidate && flag & CACHE_AS_BITMAP) {
+            flag = flag | CACHE_INVALID;
+        }
+        for (size_t i = 0; i < sgdh.size(); ++i) {
             if (i == node_id || i == child_node_id) {
                 continue;
             }
-            if (sgdh.parent_vec[i] == child_node_id) {
+            if (sgdh.parent_vec()[i] == child_node_id) {
                 to_process.push_back(i);
             }
         }
@@ -365,7 +408,7 @@ get_id() {
  **/
 size_t Node::
 get_parent_id() {
-    return sgdh.parent_vec[node_id];
+    return sgdh.parent_vec()[node_id];
 }
 
 /**
@@ -381,10 +424,10 @@ set_pos(const double v) {
  **/
 void Node::
 set_pos(const double x, const double y) {
-    if (sgdh.pos_x[node_id] != x || sgdh.pos_y[node_id] != y) {
-        sgdh.pos_x[node_id] = x;
-        sgdh.pos_y[node_id] = y;
-        propagate_dirty();
+    if (sgdh.pos_x()[node_id] != x || sgdh.pos_y()[node_id] != y) {
+        sgdh.pos_x()[node_id] = x;
+        sgdh.pos_y()[node_id] = y;
+        propagate_dirty(true);
     }
 }
 
@@ -393,7 +436,7 @@ set_pos(const double x, const double y) {
  **/
 void Node::
 set_pos(Vec2& p) {
-    set_pos(p[0], p[1]);
+    set_pos(p.x(), p.y());
 }
 
 /**
@@ -407,20 +450,20 @@ set_pos(Node& other, const double x, const double y) {
         return;
     }
 
-    const bool dist_rel = (sgdh.flag_vec[node_id] & DISTANCE_RELATIVE) > 0;
-    const double p_x = sgdh.pos_x[node_id];
-    const double p_y = sgdh.pos_y[node_id];
+    const bool dist_rel = (sgdh.flag_vec()[node_id] & DISTANCE_RELATIVE) > 0;
+    const double p_x = sgdh.pos_x()[node_id];
+    const double p_y = sgdh.pos_y()[node_id];
     const Scale r_s = get_relative_scale();
     const double o_x = get_relative_x() - (dist_rel ? p_x * r_s.sx : p_x);
     const double o_y = get_relative_y() - (dist_rel ? p_y * r_s.sy : p_y);
 
-    sgdh.pos_x[node_id] = t_x - o_x;
-    sgdh.pos_y[node_id] = t_y - o_y;
+    sgdh.pos_x()[node_id] = t_x - o_x;
+    sgdh.pos_y()[node_id] = t_y - o_y;
     if (dist_rel) {
-        sgdh.pos_x[node_id] /= r_s.sx;
-        sgdh.pos_y[node_id] /= r_s.sy;
+        sgdh.pos_x()[node_id] /= r_s.sx;
+        sgdh.pos_y()[node_id] /= r_s.sy;
     }
-    propagate_dirty();
+    propagate_dirty(true);
 }
 
 /**
@@ -436,7 +479,7 @@ set_pos(Node& other, const double v) {
  **/
 void Node::
 set_pos(Node& other, Vec2& p) {
-    set_pos(other, p[0], p[1]);
+    set_pos(other, p.x(), p.y());
 }
 
 /**
@@ -444,9 +487,9 @@ set_pos(Node& other, Vec2& p) {
  **/
 void Node::
 set_x(const double v) {
-    if (sgdh.pos_x[node_id] != v) {
-        sgdh.pos_x[node_id] = v;
-        propagate_dirty();
+    if (sgdh.pos_x()[node_id] != v) {
+        sgdh.pos_x()[node_id] = v;
+        propagate_dirty(true);
     }
 }
 
@@ -461,16 +504,16 @@ set_x(Node& other, const double v) {
         return;
     }
 
-    const bool dist_rel = (sgdh.flag_vec[node_id] & DISTANCE_RELATIVE) > 0;
-    const double p_x = sgdh.pos_x[node_id];
+    const bool dist_rel = (sgdh.flag_vec()[node_id] & DISTANCE_RELATIVE) > 0;
+    const double p_x = sgdh.pos_x()[node_id];
     const double s_x = get_relative_scale().sx;
     const double o_x = r_x - (dist_rel ? p_x * s_x : p_x);
 
-    sgdh.pos_x[node_id] = t_x - o_x;
+    sgdh.pos_x()[node_id] = t_x - o_x;
     if (dist_rel) {
-        sgdh.pos_x[node_id] /= s_x;
+        sgdh.pos_x()[node_id] /= s_x;
     }
-    propagate_dirty();
+    propagate_dirty(true);
 }
 
 /**
@@ -478,9 +521,9 @@ set_x(Node& other, const double v) {
  **/
 void Node::
 set_y(const double v) {
-    if (sgdh.pos_y[node_id] != v) {
-        sgdh.pos_y[node_id] = v;
-        propagate_dirty();
+    if (sgdh.pos_y()[node_id] != v) {
+        sgdh.pos_y()[node_id] = v;
+        propagate_dirty(true);
     }
 }
 
@@ -495,16 +538,16 @@ set_y(Node& other, const double v) {
         return;
     }
 
-    const bool dist_rel = (sgdh.flag_vec[node_id] & DISTANCE_RELATIVE) > 0;
-    const double p_y = sgdh.pos_y[node_id];
+    const bool dist_rel = (sgdh.flag_vec()[node_id] & DISTANCE_RELATIVE) > 0;
+    const double p_y = sgdh.pos_y()[node_id];
     const double s_y = get_relative_scale().sy;
     const double o_y = r_y - (dist_rel ? p_y * s_y : p_y);
 
-    sgdh.pos_y[node_id] = t_y - o_y;
+    sgdh.pos_y()[node_id] = t_y - o_y;
     if (dist_rel) {
-        sgdh.pos_y[node_id] /= s_y;
+        sgdh.pos_y()[node_id] /= s_y;
     }
-    propagate_dirty();
+    propagate_dirty(true);
 }
 
 /**
@@ -512,7 +555,7 @@ set_y(Node& other, const double v) {
  **/
 Vec2 Node::
 get_pos() {
-    return Vec2(sgdh.pos_x[node_id], sgdh.pos_y[node_id]);
+    return Vec2(sgdh.pos_x()[node_id], sgdh.pos_y()[node_id]);
 }
 
 /**
@@ -529,7 +572,7 @@ get_pos(Node& other) {
 Vec2 Node::
 get_relative_pos() {
     clean_node();
-    return Vec2(sgdh.r_pos_x[node_id], sgdh.r_pos_y[node_id]);
+    return Vec2(sgdh.r_pos_x()[node_id], sgdh.r_pos_y()[node_id]);
 }
 
 /**
@@ -537,7 +580,7 @@ get_relative_pos() {
  **/
 double Node::
 get_x() {
-    return sgdh.pos_x[node_id];
+    return sgdh.pos_x()[node_id];
 }
 
 /**
@@ -554,7 +597,7 @@ get_x(Node& other) {
 double Node::
 get_relative_x() {
     clean_node();
-    return sgdh.r_pos_x[node_id];
+    return sgdh.r_pos_x()[node_id];
 }
 
 /**
@@ -562,7 +605,7 @@ get_relative_x() {
  **/
 double Node::
 get_y() {
-    return sgdh.pos_y[node_id];
+    return sgdh.pos_y()[node_id];
 }
 
 /**
@@ -579,7 +622,7 @@ get_y(Node& other) {
 double Node::
 get_relative_y() {
     clean_node();
-    return sgdh.r_pos_y[node_id];
+    return sgdh.r_pos_y()[node_id];
 }
 
 /**
@@ -595,9 +638,9 @@ set_scale(const double s) {
  **/
 void Node::
 set_scale(const double sx, const double sy) {
-    if (sgdh.scale_x[node_id] != sx || sgdh.scale_y[node_id] != sy) {
-        sgdh.scale_x[node_id] = sx;
-        sgdh.scale_y[node_id] = sy;
+    if (sgdh.scale_x()[node_id] != sx || sgdh.scale_y()[node_id] != sy) {
+        sgdh.scale_x()[node_id] = sx;
+        sgdh.scale_y()[node_id] = sy;
         propagate_dirty();
     }
 }
@@ -630,8 +673,10 @@ set_scale(Node& other, const double sx, const double sy) {
     Scale r_scale = get_relative_scale();
 
     if (r_scale != t_scale) {
-        sgdh.scale_x[node_id] = sgdh.scale_x[node_id] / r_scale.sx * t_scale.sx;
-        sgdh.scale_y[node_id] = sgdh.scale_y[node_id] / r_scale.sy * t_scale.sy;
+        sgdh.scale_x()[node_id] = sgdh.scale_x()[node_id] / r_scale.sx
+                                  * t_scale.sx;
+        sgdh.scale_y()[node_id] = sgdh.scale_y()[node_id] / r_scale.sy
+                                  * t_scale.sy;
         propagate_dirty();
     }
 }
@@ -649,7 +694,7 @@ set_scale(Node& other, const Scale& s) {
  **/
 Scale Node::
 get_scale() {
-    return Scale(sgdh.scale_x[node_id], sgdh.scale_y[node_id]);
+    return Scale(sgdh.scale_x()[node_id], sgdh.scale_y()[node_id]);
 }
 
 /**
@@ -668,7 +713,7 @@ get_scale(Node& other) {
 Scale Node::
 get_relative_scale() {
     clean_node();
-    return Scale(sgdh.r_scale_x[node_id], sgdh.r_scale_y[node_id]);
+    return Scale(sgdh.r_scale_x()[node_id], sgdh.r_scale_y()[node_id]);
 }
 
 /**
@@ -677,8 +722,8 @@ get_relative_scale() {
 void Node::
 set_angle(const double angle, bool radians) {
     const double deg_angle = radians ? angle * to_deg : angle;
-    if (sgdh.angle_vec[node_id] != deg_angle) {
-        sgdh.angle_vec[node_id] = deg_angle;
+    if (sgdh.angle_vec()[node_id] != deg_angle) {
+        sgdh.angle_vec()[node_id] = deg_angle;
         propagate_dirty();
     }
 }
@@ -692,7 +737,7 @@ set_angle(Node& other, const double angle, bool radians) {
     const double t_angle = other.get_relative_angle() + deg_angle;
     const double r_angle = get_relative_angle();
     if (r_angle != t_angle) {
-        sgdh.angle_vec[node_id] += r_angle - t_angle;
+        sgdh.angle_vec()[node_id] += r_angle - t_angle;
         propagate_dirty();
     }
 }
@@ -702,7 +747,7 @@ set_angle(Node& other, const double angle, bool radians) {
  **/
 double Node::
 get_angle(bool radians) {
-    return sgdh.angle_vec[node_id] * (radians ? to_rad : 1.0);
+    return sgdh.angle_vec()[node_id] * (radians ? to_rad : 1.0);
 }
 
 /**
@@ -720,7 +765,7 @@ get_angle(Node& other, bool radians) {
 double Node::
 get_relative_angle() {
     clean_node();
-    return sgdh.r_angle_vec[node_id];
+    return sgdh.r_angle_vec()[node_id];
 }
 
 /**
@@ -728,12 +773,12 @@ get_relative_angle() {
  **/
 void Node::
 set_rotation_center(const double x, const double y) {
-    if (!(sgdh.flag_vec[node_id] & ROTATION_CENTER_SET) ||
-            sgdh.rotation_center_x[node_id] != x ||
-            sgdh.rotation_center_y[node_id] != y) {
-        sgdh.rotation_center_x[node_id] = x;
-        sgdh.rotation_center_y[node_id] = y;
-        sgdh.flag_vec[node_id] = sgdh.flag_vec[node_id] | ROTATION_CENTER_SET;
+    if (!(sgdh.flag_vec()[node_id] & ROTATION_CENTER_SET) ||
+            sgdh.rotation_center_x()[node_id] != x ||
+            sgdh.rotation_center_y()[node_id] != y) {
+        sgdh.rotation_center_x()[node_id] = x;
+        sgdh.rotation_center_y()[node_id] = y;
+        sgdh.flag_vec()[node_id] |= ROTATION_CENTER_SET;
         propagate_dirty();
     }
 }
@@ -743,12 +788,12 @@ set_rotation_center(const double x, const double y) {
  **/
 void Node::
 set_rotation_center(Vec2& c) {
-    if (!(sgdh.flag_vec[node_id] & ROTATION_CENTER_SET) ||
-            sgdh.rotation_center_x[node_id] != c[0] ||
-            sgdh.rotation_center_y[node_id] != c[1]) {
-        sgdh.rotation_center_x[node_id] = c[0];
-        sgdh.rotation_center_y[node_id] = c[1];
-        sgdh.flag_vec[node_id] = sgdh.flag_vec[node_id] | ROTATION_CENTER_SET;
+    if (!(sgdh.flag_vec()[node_id] & ROTATION_CENTER_SET) ||
+            sgdh.rotation_center_x()[node_id] != c.x() ||
+            sgdh.rotation_center_y()[node_id] != c.y()) {
+        sgdh.rotation_center_x()[node_id] = c.x();
+        sgdh.rotation_center_y()[node_id] = c.y();
+        sgdh.flag_vec()[node_id] |= ROTATION_CENTER_SET;
         propagate_dirty();
     }
 }
@@ -758,8 +803,8 @@ set_rotation_center(Vec2& c) {
  **/
 void Node::
 reset_rotation_center() {
-    if (sgdh.flag_vec[node_id] & ROTATION_CENTER_SET) {
-        sgdh.flag_vec[node_id] = sgdh.flag_vec[node_id] ^ ROTATION_CENTER_SET;
+    if (sgdh.flag_vec()[node_id] & ROTATION_CENTER_SET) {
+        sgdh.flag_vec()[node_id] ^= ROTATION_CENTER_SET;
     }
     propagate_dirty();
 }
@@ -769,15 +814,15 @@ reset_rotation_center() {
  **/
 Vec2 Node::
 get_rotation_center() {
-    if (!(sgdh.flag_vec[node_id] & ROTATION_CENTER_SET)) {
+    if (!(sgdh.flag_vec()[node_id] & ROTATION_CENTER_SET)) {
         return Vec2(
-            sgdh.size_x[node_id] / 2.0,
-            sgdh.size_y[node_id] / 2.0
+            sgdh.size_x()[node_id] / 2.0,
+            sgdh.size_y()[node_id] / 2.0
         );
     }
     return Vec2(
-        sgdh.rotation_center_x[node_id],
-        sgdh.rotation_center_y[node_id]
+        sgdh.rotation_center_x()[node_id],
+        sgdh.rotation_center_y()[node_id]
     );
 }
 
@@ -786,8 +831,8 @@ get_rotation_center() {
  **/
 void Node::
 set_depth(const int depth) {
-    if (sgdh.depth_vec[node_id] != depth) {
-        sgdh.depth_vec[node_id] = depth;
+    if (sgdh.depth_vec()[node_id] != depth) {
+        sgdh.depth_vec()[node_id] = depth;
         propagate_dirty();
     }
 }
@@ -799,7 +844,7 @@ void Node::
 set_depth(Node& other, const int depth) {
     const int d = other.get_relative_depth() + depth - get_relative_depth();
     if (d != 0) {
-        sgdh.depth_vec[node_id] += d;
+        sgdh.depth_vec()[node_id] += d;
         propagate_dirty();
     }
 }
@@ -809,7 +854,7 @@ set_depth(Node& other, const int depth) {
  **/
 int Node::
 get_depth() {
-    return sgdh.depth_vec[node_id];
+    return sgdh.depth_vec()[node_id];
 }
 
 /**
@@ -826,7 +871,7 @@ get_depth(Node& other) {
 int Node::
 get_relative_depth() {
     clean_node();
-    return sgdh.r_depth_vec[node_id];
+    return sgdh.r_depth_vec()[node_id];
 }
 
 /**
@@ -834,9 +879,9 @@ get_relative_depth() {
  **/
 void Node::
 set_size(const double x, const double y) {
-    if (sgdh.size_x[node_id] != x || sgdh.size_y[node_id] != y) {
-        sgdh.size_x[node_id] = x;
-        sgdh.size_y[node_id] = y;
+    if (sgdh.size_x()[node_id] != x || sgdh.size_y()[node_id] != y) {
+        sgdh.size_x()[node_id] = x;
+        sgdh.size_y()[node_id] = y;
         propagate_dirty();
     }
 }
@@ -846,9 +891,9 @@ set_size(const double x, const double y) {
  **/
 void Node::
 set_size(const Size& s) {
-    if (sgdh.size_x[node_id] != s.w || sgdh.size_y[node_id] != s.h) {
-        sgdh.size_x[node_id] = s.w;
-        sgdh.size_y[node_id] = s.h;
+    if (sgdh.size_x()[node_id] != s.w || sgdh.size_y()[node_id] != s.h) {
+        sgdh.size_x()[node_id] = s.w;
+        sgdh.size_y()[node_id] = s.h;
         propagate_dirty();
     }
 }
@@ -858,7 +903,7 @@ set_size(const Size& s) {
  **/
 Size Node::
 get_size() {
-    return Size(sgdh.size_x[node_id], sgdh.size_y[node_id]);
+    return Size(sgdh.size_x()[node_id], sgdh.size_y()[node_id]);
 }
 
 /**
@@ -868,8 +913,8 @@ Size Node::
 get_relative_size() {
     clean_node();
     return Size(
-        sgdh.size_x[node_id] * sgdh.r_scale_x[node_id],
-        sgdh.size_y[node_id] * sgdh.r_scale_y[node_id]
+        sgdh.size_x()[node_id] * sgdh.r_scale_x()[node_id],
+        sgdh.size_y()[node_id] * sgdh.r_scale_y()[node_id]
     );
 }
 
@@ -878,8 +923,8 @@ get_relative_size() {
  **/
 void Node::
 set_origin(Origin o) {
-    if (sgdh.origin_vec[node_id] != o) {
-        sgdh.origin_vec[node_id] = o;
+    if (sgdh.origin_vec()[node_id] != o) {
+        sgdh.origin_vec()[node_id] = o;
         propagate_dirty();
     }
 }
@@ -889,7 +934,7 @@ set_origin(Origin o) {
  **/
 Origin Node::
 get_origin() {
-    return sgdh.origin_vec[node_id];
+    return sgdh.origin_vec()[node_id];
 }
 
 /**
@@ -897,12 +942,12 @@ get_origin() {
  **/
 void Node::
 set_distance_relative(const bool v) {
-    if (!(sgdh.flag_vec[node_id] & DISTANCE_RELATIVE) && v) {
-        sgdh.flag_vec[node_id] = sgdh.flag_vec[node_id] | DISTANCE_RELATIVE;
+    if (!(sgdh.flag_vec()[node_id] & DISTANCE_RELATIVE) && v) {
+        sgdh.flag_vec()[node_id] = sgdh.flag_vec()[node_id] | DISTANCE_RELATIVE;
         propagate_dirty();
     }
-    else if ((sgdh.flag_vec[node_id] & DISTANCE_RELATIVE) && !v) {
-        sgdh.flag_vec[node_id] = sgdh.flag_vec[node_id] ^ DISTANCE_RELATIVE;
+    else if ((sgdh.flag_vec()[node_id] & DISTANCE_RELATIVE) && !v) {
+        sgdh.flag_vec()[node_id] = sgdh.flag_vec()[node_id] ^ DISTANCE_RELATIVE;
         propagate_dirty();
     }
 }
@@ -912,7 +957,52 @@ set_distance_relative(const bool v) {
  **/
 bool Node::
 get_distance_relative() {
-    return (sgdh.flag_vec[node_id] & DISTANCE_RELATIVE) > 0;
+    return (sgdh.flag_vec()[node_id] & DISTANCE_RELATIVE) > 0;
+}
+
+/**
+ * Set whether the subtree of this Node should be drawn from a cached bitmap.
+ * A new cache starts out invalid.
+ **/
+void Node::
+set_cache_as_bitmap(const bool v) {
+    unsigned char& flag = sgdh.flag_vec()[node_id];
+    if (!(flag & CACHE_AS_BITMAP) && v) {
+        flag = flag | CACHE_AS_BITMAP | CACHE_INVALID;
+        ++sgdh.cache_nodes;
+    }
+    else if ((flag & CACHE_AS_BITMAP) && !v) {
+        flag = flag & ~(CACHE_AS_BITMAP | CACHE_INVALID);
+        --sgdh.cache_nodes;
+        invalidate_cache(sgdh, node_id);
+    }
+}
+
+/**
+ * Get whether the cache as bitmap flag has been set.
+ **/
+bool Node::
+get_cache_as_bitmap() {
+    return (sgdh.flag_vec()[node_id] & CACHE_AS_BITMAP) > 0;
+}
+
+/**
+ * Whether the cached bitmap is still up to date, i.e. no node in the subtree
+ * changed since ``validate_cache()``.
+ **/
+bool Node::
+cache_valid() {
+    const unsigned char flag = sgdh.flag_vec()[node_id];
+    return (flag & CACHE_AS_BITMAP) && !(flag & CACHE_INVALID);
+}
+
+/**
+ * Mark the cached bitmap as up to date.
+ **/
+void Node::
+validate_cache() {
+    unsigned char& flag = sgdh.flag_vec()[node_id];
+    flag = flag & ~CACHE_INVALID;
 }
 
 /**
@@ -920,48 +1010,60 @@ get_distance_relative() {
  **/
 AABB Node::
 get_aabb() {
+    return AABB(get_box());
+}
+
+/**
+ * Return the render rectangle computed by the last ``process_render``.
+ **/
+RenderRect Node::
+get_render_rect() {
+    if (node_id >= sgdh.render.size()) {
+        throw std::range_error("Render column not computed for this Node.");
+    }
+    RenderRect r;
+    r.x = sgdh.render_x()[node_id];
+    r.y = sgdh.render_y()[node_id];
+    r.w = sgdh.render_w()[node_id];
+    r.h = sgdh.render_h()[node_id];
+    r.cx = sgdh.render_cx()[node_id];
+    r.cy = sgdh.render_cy()[node_id];
+    r.angle = sgdh.render_angle()[node_id];
+    return r;
+}
+
+/**
+ * Return the bounds of the Node as min/max Box.
+ **/
+Box Node::
+get_box() {
     Size r_sz = get_relative_size();
-    Vec2 r_pos = get_relative_pos();
+    const Vec2d r_pos = get_relative_pos();
     Scale r_sc = get_relative_scale();
 
-    double min_x = r_pos[0], max_x = r_pos[0] + r_sz.w;
-    double min_y = r_pos[1], max_y = r_pos[1] + r_sz.h;
-    Vec2 top_left(min_x, min_y);
-    Vec2 top_right(max_x, min_y);
-    Vec2 bottom_left(min_x, max_y);
-    Vec2 bottom_right(max_x, max_y);
-    Vec2 rot_center = get_rotation_center();
-    rot_center = Vec2(rot_center[0] * r_sc.sx, rot_center[1] * r_sc.sy) + r_pos;
-    Vec2 rot;
-    const double a = get_relative_angle();
-
-    rot = (top_left - rot_center).rotated(a) + rot_center;
-    min_x = std::min(min_x, rot[0]);
-    max_x = std::max(max_x, rot[0]);
-    min_y = std::min(min_y, rot[1]);
-    max_y = std::max(max_y, rot[1]);
-
-    rot = (top_right - rot_center).rotated(a) + rot_center;
-    min_x = std::min(min_x, rot[0]);
-    max_x = std::max(max_x, rot[0]);
-    min_y = std::min(min_y, rot[1]);
-    max_y = std::max(max_y, rot[1]);
-
-    rot = (bottom_left - rot_center).rotated(a) + rot_center;
-    min_x = std::min(min_x, rot[0]);
-    max_x = std::max(max_x, rot[0]);
-    min_y = std::min(min_y, rot[1]);
-    max_y = std::max(max_y, rot[1]);
-
-    rot = (bottom_right - rot_center).rotated(a) + rot_center;
-    min_x = std::min(min_x, rot[0]);
-    max_x = std::max(max_x, rot[0]);
-    min_y = std::min(min_y, rot[1]);
-    max_y = std::max(max_y, rot[1]);
-
-    const double hw = (max_x - min_x) / 2.0;
-    const double hh = (max_y - min_y) / 2.0;
-    return AABB(min_x + hw, min_y + hh, hw, hh);
+    const Vec2d rc = get_rotation_center();
+    const Vec2d rot_center = Vec2d{rc.x * r_sc.sx, rc.y * r_sc.sy} + r_pos;
+    const Vec2d corners[4] = {
+        {r_pos.x, r_pos.y},
+        {r_pos.x + r_sz.w, r_pos.y},
+        {r_pos.x, r_pos.y + r_sz.h},
+        {r_pos.x + r_sz.w, r_pos.y + r_sz.h}
+    };
+    double sa, ca;
+    rotation(sgdh, get_relative_angle(), sa, ca);
+
+    double min_x = corners[0].x, max_x = corners[3].x;
+    double min_y = corners[0].y, max_y = corners[3].y;
+    for (int i = 0; i < 4; ++i) {
+        const Vec2d rot = tools::rotated(corners[i] - rot_center, sa, ca)
+                          + rot_center;
+        min_x = std::min(min_x, rot.x);
+        max_x = std::max(max_x, rot.x);
+        min_y = std::min(min_y, rot.y);
+        max_y = std::max(max_y, rot.y);
+    }
+
+    return Box(min_x, min_y, max_x, max_y);
 }
 
 
@@ -974,26 +1076,27 @@ get_aabb() {
  **/
 bool scene_traverse(SceneGraphDataHandler& sgdh, const size_t start_node) {
     bool was_dirty = false;
-    const size_t parent = sgdh.parent_vec[start_node];
-    if (parent != start_node && (sgdh.flag_vec[start_node] & DIRTY)) {
+    const size_t parent = sgdh.parent_vec()[start_node];
+    if (parent != start_node && (sgdh.flag_vec()[start_node] & DIRTY)) {
         minimal_clean(sgdh, parent);
         was_dirty = true;
     }
 
-    SmallList<size_t> to_process;
-    SmallList<size_t> nodes;
-    nodes.reserve(sgdh.flag_vec.size());
+    ArenaScope scope(sgdh.arena);
+    NodeList to_process(ArenaAllocator<size_t>(&sgdh.arena));
+    NodeList nodes(ArenaAllocator<size_t>(&sgdh.arena));
+    nodes.reserve(sgdh.size());
 
     nodes.push_back(start_node);
     to_process.push_back(start_node);
     size_t current_proc_id = 0;
     while (to_process.size() > current_proc_id) {
         const size_t pid = to_process[current_proc_id];
-        for (size_t i = 0; i < sgdh.parent_vec.size(); ++i) {
-            if (i == pid || sgdh.flag_vec[i] & FREE) {
+        for (size_t i = 0; i < sgdh.size(); ++i) {
+            if (i == pid || sgdh.flag_vec()[i] & FREE) {
                 continue;
             }
-            if (sgdh.parent_vec[i] == pid) {
+            if (sgdh.parent_vec()[i] == pid) {
                 to_process.push_back(i);
                 nodes.push_back(i);
             }
@@ -1018,7 +1121,8 @@ bool scene_traverse(SceneGraphDataHandler& sgdh, const size_t start_node) {
  * Perform the least amount of traversal to clean a Node.
  **/
 void minimal_clean(SceneGraphDataHandler &sgdh, const size_t node_id) {
-    SmallList<size_t> path;
+    ArenaScope scope(sgdh.arena);
+    NodeList path(ArenaAllocator<size_t>(&sgdh.arena));
     path.push_back(node_id);
     dirty_path(sgdh, node_id, path);
     path.reverse();
@@ -1035,16 +1139,16 @@ void minimal_clean(SceneGraphDataHandler &sgdh, const size_t node_id) {
  * Node in reversed order. Does not clear the list.
  **/
 void dirty_path(SceneGraphDataHandler &sgdh, const size_t node_id,
-                SmallList<size_t>& path) {
+                NodeList& path) {
     size_t base_node = node_id;
-    while (base_node > 0 && sgdh.parent_vec[base_node] != base_node) {
-        if (!(sgdh.flag_vec[base_node] & DIRTY)) {
+    while (base_node > 0 && sgdh.parent_vec()[base_node] != base_node) {
+        if (!(sgdh.flag_vec()[base_node] & DIRTY)) {
             break;
         }
-        if (sgdh.flag_vec[base_node] & FREE) {
+        if (sgdh.flag_vec()[base_node] & FREE) {
             throw std::runtime_error("Encountered a removed Node.");
         }
-        base_node = sgdh.parent_vec[base_node];
+        base_node = sgdh.parent_vec()[base_node];
         path.push_back(base_node);
     }
 }
@@ -1052,68 +1156,68 @@ void dirty_path(SceneGraphDataHandler &sgdh, const size_t node_id,
 /**
  * Process all angles of nodes in path.
  **/
-void process_angle(SceneGraphDataHandler& sgdh, SmallList<size_t>& path) {
+void process_angle(SceneGraphDataHandler& sgdh, NodeList& path) {
     for (size_t i = 0; i < path.size(); ++i) {
         const size_t pid = path[i];
-        const size_t parent = sgdh.parent_vec[pid];
-        const double rel = parent == pid ? 0.0 : sgdh.r_angle_vec[parent];
-        sgdh.r_angle_vec[pid] = rel + sgdh.angle_vec[pid];
+        const size_t parent = sgdh.parent_vec()[pid];
+        const double rel = parent == pid ? 0.0 : sgdh.r_angle_vec()[parent];
+        sgdh.r_angle_vec()[pid] = rel + sgdh.angle_vec()[pid];
     }
 }
 
 /**
  * Process all depths of nodes in path.
  **/
-void process_depth(SceneGraphDataHandler& sgdh, SmallList<size_t>& path) {
+void process_depth(SceneGraphDataHandler& sgdh, NodeList& path) {
     for (size_t i = 0; i < path.size(); ++i) {
         const size_t pid = path[i];
-        const size_t parent = sgdh.parent_vec[pid];
-        const double rel = parent == pid ? 0 : sgdh.r_depth_vec[parent];
-        sgdh.r_depth_vec[pid] = rel + sgdh.depth_vec[pid];
+        const size_t parent = sgdh.parent_vec()[pid];
+        const double rel = parent == pid ? 0 : sgdh.r_depth_vec()[parent];
+        sgdh.r_depth_vec()[pid] = rel + sgdh.depth_vec()[pid];
     }
 }
 
 /**
  * Process all scale factors of nodes in path.
  **/
-void process_scale(SceneGraphDataHandler& sgdh, SmallList<size_t>& path) {
+void process_scale(SceneGraphDataHandler& sgdh, NodeList& path) {
     for (size_t i = 0; i < path.size(); ++i) {
         const size_t pid = path[i];
-        const size_t parent = sgdh.parent_vec[pid];
-        const double rel = parent == pid ? 1.0 : sgdh.r_scale_x[parent];
-        sgdh.r_scale_x[pid] = rel * sgdh.scale_x[pid];
+        const size_t parent = sgdh.parent_vec()[pid];
+        const double rel = parent == pid ? 1.0 : sgdh.r_scale_x()[parent];
+        sgdh.r_scale_x()[pid] = rel * sgdh.scale_x()[pid];
     }
     for (size_t i = 0; i < path.size(); ++i) {
         const size_t pid = path[i];
-        const size_t parent = sgdh.parent_vec[pid];
-        const double rel = parent == pid ? 1.0 : sgdh.r_scale_y[parent];
-        sgdh.r_scale_y[pid] = rel * sgdh.scale_y[pid];
+        const size_t parent = sgdh.parent_vec()[pid];
+        const double rel = parent == pid ? 1.0 : sgdh.r_scale_y()[parent];
+        sgdh.r_scale_y()[pid] = rel * sgdh.scale_y()[pid];
     }
 }
 
 /**
  * Process all positions of nodes in path.
  **/
-void process_origin(SceneGraphDataHandler& sgdh, SmallList<size_t>& path) {
+void process_origin(SceneGraphDataHandler& sgdh, NodeList& path) {
     for (size_t i = 0; i < path.size(); ++i) {
         const size_t pid = path[i];
-        const bool dist_rel = (sgdh.flag_vec[pid] & DISTANCE_RELATIVE) > 0;
-        const double sx = sgdh.r_scale_x[pid];
-        const double sy = sgdh.r_scale_y[pid];
-        const double hw = sgdh.size_x[pid] * sx / 2.0;
-        const double hh = sgdh.size_y[pid] * sy / 2.0;
-        double x = sgdh.pos_x[pid] * (dist_rel ? sx : 1.0);
-        double y = sgdh.pos_y[pid] * (dist_rel ? sx : 1.0);
-        double ox = x - sgdh.origin_vec[pid] % 3 * hw;
-        double oy = y - sgdh.origin_vec[pid] / 3 * hh;
-
-        const double rad = sgdh.r_angle_vec[pid] * -to_rad;
-        if (rad != 0.0) {
-            const double sa = std::sin(rad), ca = std::cos(rad);
+        const bool dist_rel = (sgdh.flag_vec()[pid] & DISTANCE_RELATIVE) > 0;
+        const double sx = sgdh.r_scale_x()[pid];
+        const double sy = sgdh.r_scale_y()[pid];
+        const double hw = sgdh.size_x()[pid] * sx / 2.0;
+        const double hh = sgdh.size_y()[pid] * sy / 2.0;
+        double x = sgdh.pos_x()[pid] * (dist_rel ? sx : 1.0);
+        double y = sgdh.pos_y()[pid] * (dist_rel ? sx : 1.0);
+        double ox = x - sgdh.origin_vec()[pid] % 3 * hw;
+        double oy = y - sgdh.origin_vec()[pid] / 3 * hh;
+
+        if (sgdh.r_angle_vec()[pid] != 0.0) {
+            double sa, ca;
+            rotation(sgdh, sgdh.r_angle_vec()[pid], sa, ca);
             double rot_cen_x, rot_cen_y;
-            if (sgdh.flag_vec[pid] & ROTATION_CENTER_SET) {
-                rot_cen_x = x + sgdh.rotation_center_x[pid] * sx;
-                rot_cen_y = y + sgdh.rotation_center_y[pid] * sy;
+            if (sgdh.flag_vec()[pid] & ROTATION_CENTER_SET) {
+                rot_cen_x = x + sgdh.rotation_center_x()[pid] * sx;
+                rot_cen_y = y + sgdh.rotation_center_y()[pid] * sy;
             }
             else {
                 rot_cen_x = x + hw;
@@ -1124,49 +1228,51 @@ void process_origin(SceneGraphDataHandler& sgdh, SmallList<size_t>& path) {
             ox = ca * (ox - rot_cen_x) - sa * (oy - rot_cen_y) + rot_cen_x;
             oy = sa * (ox - rot_cen_x) + ca * (oy - rot_cen_y) + rot_cen_y;
         }
-        sgdh.o_pos_x[pid] = x - ox;
-        sgdh.o_pos_y[pid] = y - oy;
+        sgdh.o_pos_x()[pid] = x - ox;
+        sgdh.o_pos_y()[pid] = y - oy;
     }
 }
 
 /**
  * Process all positions of nodes in path.
  **/
-void process_pos(SceneGraphDataHandler& sgdh, SmallList<size_t>& path) {
+void process_pos(SceneGraphDataHandler& sgdh, NodeList& path) {
     for (size_t i = 0; i < path.size(); ++i) {
         const size_t pid = path[i];
-        const size_t parent = sgdh.parent_vec[pid];
+        const size_t parent = sgdh.parent_vec()[pid];
         const double rel_x = (parent == pid
                                 ? 0.0
-                                : sgdh.r_pos_x[parent] + sgdh.o_pos_x[parent]);
+                                : sgdh.r_pos_x()[parent]
+                                  + sgdh.o_pos_x()[parent]);
         const double rel_y = (parent == pid
                                 ? 0.0
-                                : sgdh.r_pos_y[parent] + sgdh.o_pos_y[parent]);
-        const double sx = sgdh.r_scale_x[pid];
-        const double sy = sgdh.r_scale_y[pid];
-        const double hw = sgdh.size_x[pid] * sx / 2.0;
-        const double hh = sgdh.size_y[pid] * sy / 2.0;
-
-        const bool dist_rel = (sgdh.flag_vec[pid] & DISTANCE_RELATIVE) > 0;
-        double x = sgdh.pos_x[pid], y = sgdh.pos_y[pid];
-        x -= (sgdh.origin_vec[pid] % 3) * hw;
-        y -= (sgdh.origin_vec[pid] / 3) * hh;
+                                : sgdh.r_pos_y()[parent]
+                                  + sgdh.o_pos_y()[parent]);
+        const double sx = sgdh.r_scale_x()[pid];
+        const double sy = sgdh.r_scale_y()[pid];
+        const double hw = sgdh.size_x()[pid] * sx / 2.0;
+        const double hh = sgdh.size_y()[pid] * sy / 2.0;
+
+        const bool dist_rel = (sgdh.flag_vec()[pid] & DISTANCE_RELATIVE) > 0;
+        double x = sgdh.pos_x()[pid], y = sgdh.pos_y()[pid];
+        x -= (sgdh.origin_vec()[pid] % 3) * hw;
+        y -= (sgdh.origin_vec()[pid] / 3) * hh;
         x = dist_rel ? x * sx : x;
         y = dist_rel ? y * sy : y;
 
-        if (sgdh.r_angle_vec[parent] != 0.0 && parent != pid) {
-            const double rad = sgdh.r_angle_vec[parent] * -to_rad;
-            const double sa = std::sin(rad), ca = std::cos(rad);
-            const double psx = sgdh.r_scale_x[parent];
-            const double psy = sgdh.r_scale_y[parent];
+        if (sgdh.r_angle_vec()[parent] != 0.0 && parent != pid) {
+            double sa, ca;
+            rotation(sgdh, sgdh.r_angle_vec()[parent], sa, ca);
+            const double psx = sgdh.r_scale_x()[parent];
+            const double psy = sgdh.r_scale_y()[parent];
             double rot_cen_x, rot_cen_y;
-            if (sgdh.flag_vec[parent] & ROTATION_CENTER_SET) {
-                rot_cen_x = rel_x + sgdh.rotation_center_x[parent] * psx;
-                rot_cen_y = rel_y + sgdh.rotation_center_y[parent] * psy;
+            if (sgdh.flag_vec()[parent] & ROTATION_CENTER_SET) {
+                rot_cen_x = rel_x + sgdh.rotation_center_x()[parent] * psx;
+                rot_cen_y = rel_y + sgdh.rotation_center_y()[parent] * psy;
             }
             else {
-                const double phw = sgdh.size_x[parent] / 2.0;
-                const double phh = sgdh.size_y[parent] / 2.0;
+                const double phw = sgdh.size_x()[parent] / 2.0;
+                const double phh = sgdh.size_y()[parent] / 2.0;
                 rot_cen_x = rel_x + phw * psx;
                 rot_cen_y = rel_y + phh * psy;
             }
@@ -1177,29 +1283,93 @@ void process_pos(SceneGraphDataHandler& sgdh, SmallList<size_t>& path) {
             x += tmp_x;
             y += tmp_y;
         }
-        sgdh.r_pos_x[pid] = rel_x + x;
-        sgdh.r_pos_y[pid] = rel_y + y;
+        sgdh.r_pos_x()[pid] = rel_x + x;
+        sgdh.r_pos_y()[pid] = rel_y + y;
+    }
+}
+
+/**
+ * Compute the pixel space render column of all nodes for ``view`` in one
+ * pass over the node columns. Values of dirty nodes are only valid after
+ * traversal.
+ **/
+void process_render(SceneGraphDataHandler& sgdh, const ViewTransform& view) {
+    const size_t n = sgdh.size();
+    sgdh.render.resize(n);
+    const double scale = view.unit * view.zoom;
+    const int off_x = static_cast<int>(view.view_x * scale);
+    const int off_y = static_cast<int>(view.view_y * scale);
+    const double* r_pos_x = sgdh.r_pos_x().data;
+    const double* r_pos_y = sgdh.r_pos_y().data;
+    const double* r_scale_x = sgdh.r_scale_x().data;
+    const double* r_scale_y = sgdh.r_scale_y().data;
+    const double* size_x = sgdh.size_x().data;
+    const double* size_y = sgdh.size_y().data;
+    const double* rc_x = sgdh.rotation_center_x().data;
+    const double* rc_y = sgdh.rotation_center_y().data;
+    const double* r_angle = sgdh.r_angle_vec().data;
+    const unsigned char* flags = sgdh.flag_vec().data;
+    int* x = sgdh.render_x().data;
+    int* y = sgdh.render_y().data;
+    int* w = sgdh.render_w().data;
+    int* h = sgdh.render_h().data;
+    int* cx = sgdh.render_cx().data;
+    int* cy = sgdh.render_cy().data;
+    double* angle = sgdh.render_angle().data;
+    for (size_t i = 0; i < n; ++i) {
+        const bool center_set = (flags[i] & ROTATION_CENTER_SET) != 0;
+        const double c_x = center_set ? rc_x[i] : size_x[i] / 2.0;
+        const double c_y = center_set ? rc_y[i] : size_y[i] / 2.0;
+        x[i] = off_x + static_cast<int>(r_pos_x[i] * scale + 0.5);
+        y[i] = off_y + static_cast<int>(r_pos_y[i] * scale + 0.5);
+        w[i] = static_cast<int>(size_x[i] * r_scale_x[i] * view.unit + 0.5);
+        h[i] = static_cast<int>(size_y[i] * r_scale_y[i] * view.unit + 0.5);
+        cx[i] = static_cast<int>(c_x * r_scale_x[i] * scale + 0.5);
+        cy[i] = static_cast<int>(c_y * r_scale_y[i] * scale + 0.5);
+        angle[i] = r_angle[i];
     }
 }
 
 /**
  * Clear all dirty flags.
  **/
-bool clear_dirty_flag(SceneGraphDataHandler& sgdh, SmallList<size_t>& path) {
+bool clear_dirty_flag(SceneGraphDataHandler& sgdh, NodeList& path) {
     bool dirty = false;
     int count = 0;
     for (size_t i = 0; i < path.size(); ++i) {
-        if (sgdh.flag_vec[path[i]] & DIRTY) {
+        if (sgdh.flag_vec()[path[i]] & DIRTY) {
             if (!dirty) {
                 dirty = true;
             }
-            sgdh.flag_vec[path[i]] = sgdh.flag_vec[path[i]] ^ DIRTY;
+            sgdh.flag_vec()[path[i]] = sgdh.flag_vec()[path[i]] ^ DIRTY;
             ++count;
         }
     }
     return dirty;
 }
 
+/**
+ * Invalidate the cached bitmap of ``node_id`` and of all its ancestors that
+ * are drawn from a cached bitmap.
+ **/
+void invalidate_cache(SceneGraphDataHandler& sgdh, const size_t node_id) {
+    if (!sgdh.cache_nodes) {
+        return;
+    }
+    size_t nid = node_id;
+    while (true) {
+        unsigned char& flag = sgdh.flag_vec()[nid];
+        if (flag & CACHE_AS_BITMAP) {
+            flag = flag | CACHE_INVALID;
+        }
+        const size_t parent = sgdh.parent_vec()[nid];
+        if (parent == nid) {
+            break;
+        }
+        nid = parent;
+    }
+}
+
 
 }  // namespace scene
 }  // namespace foolysh
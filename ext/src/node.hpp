@@ -28,8 +28,10 @@
 
 #include <vector>
 
+#include "arena.hpp"
 #include "vec2.hpp"
 #include "list_t.hpp"
+#include "soa.hpp"
 #include "aabb.hpp"
 
 namespace foolysh {
@@ -37,14 +39,22 @@ namespace scene {
 
 typedef foolysh::tools::Vec2 Vec2;
 typedef foolysh::tools::AABB AABB;
+typedef foolysh::tools::Box Box;
 using tools::SmallList;
+using tools::FrameArena;
+using tools::ColumnView;
+
+// Scratch list of node ids, spills over into the per-frame arena.
+typedef SmallList<size_t, tools::ArenaAllocator<size_t>> NodeList;
 
 enum Flags {
     DIRTY = 1,
     ROTATION_CENTER_SET = 2,
     DISTANCE_RELATIVE = 4,
     HIDDEN = 8,
-    FREE = 16
+    FREE = 16,
+    CACHE_AS_BITMAP = 32,
+    CACHE_INVALID = 64
 };
 
 enum Origin {
@@ -119,44 +129,130 @@ struct DepthSort {
     }
 };
 
+// Column indices of NodeData.
+enum NodeColumn {
+    COL_POS_X = 0,
+    COL_POS_Y,
+    COL_R_POS_X,
+    COL_R_POS_Y,
+    COL_O_POS_X,
+    COL_O_POS_Y,
+    COL_SCALE_X,
+    COL_SCALE_Y,
+    COL_R_SCALE_X,
+    COL_R_SCALE_Y,
+    COL_SIZE_X,
+    COL_SIZE_Y,
+    COL_ROTATION_CENTER_X,
+    COL_ROTATION_CENTER_Y,
+    COL_ANGLE,
+    COL_R_ANGLE,
+    COL_DEPTH,
+    COL_R_DEPTH,
+    COL_FLAG,
+    COL_ORIGIN,
+    COL_PARENT,
+    COL_REF
+};
+
+typedef tools::SoA<double, double, double, double, double, double, double,
+                   double, double, double, double, double, double, double,
+                   double, double, int, int, unsigned char, Origin, size_t,
+                   size_t> NodeData;
+
+// Column indices of RenderData.
+enum RenderColumn {
+    RCOL_X = 0,
+    RCOL_Y,
+    RCOL_W,
+    RCOL_H,
+    RCOL_CX,
+    RCOL_CY,
+    RCOL_ANGLE
+};
+
+typedef tools::SoA<int, int, int, int, int, int, double> RenderData;
+
+/**
+ * Maps world units to pixels: ``unit`` = pixels per world unit (the smaller
+ * window dimension), ``zoom`` and the ``view_x/view_y`` offset in world units.
+ **/
+struct ViewTransform {
+    double unit, zoom, view_x, view_y;
+};
+
+/**
+ * Pixel snapped destination rectangle, rotation center and angle of a Node.
+ * The size is the node size times its relative scale.
+ **/
+struct RenderRect {
+    int x, y, w, h, cx, cy;
+    double angle;
+};
+
 /**
- * Holds all data vectors for one scene graph with index 0 being the root.
+ * Holds all node data for one scene graph with index 0 being the root. The
+ * columns share one SoA allocation and are accessed through column views,
+ * e.g. ``sgdh.pos_x()[node_id]``.
  * Prefix meanings:
  *   r_ = relative = top left point (as used/needed in SDL).
  *   o_ = origin = local origin of the Node with rotation and scale applied.
  *
  * Flags: 1 = dirty, 2 = rotation_center set, 4 = scaled_position, 8 = hidden,
- *        16 = free
+ *        16 = free, 32 = cache as bitmap, 64 = cached bitmap invalid
  **/
 struct SceneGraphDataHandler {
     SceneGraphDataHandler() {}
-    std::vector<double> pos_x;
-    std::vector<double> pos_y;
-    std::vector<double> r_pos_x;
-    std::vector<double> r_pos_y;
-    std::vector<double> o_pos_x;
-    std::vector<double> o_pos_y;
-    std::vector<double> scale_x;
-    std::vector<double> scale_y;
-    std::vector<double> r_scale_x;
-    std::vector<double> r_scale_y;
-    std::vector<double> size_x;
-    std::vector<double> size_y;
-    std::vector<double> rotation_center_x;
-    std::vector<double> rotation_center_y;
-    std::vector<double> angle_vec;
-    std::vector<double> r_angle_vec;
-    std::vector<int> depth_vec;
-    std::vector<int> r_depth_vec;
-    std::vector<unsigned char> flag_vec;
-    std::vector<Origin> origin_vec;
-    std::vector<size_t> parent_vec;
+    NodeData data;
     std::vector<size_t> free_vec;
-    std::vector<size_t> ref_vec;
-
+    FrameArena arena;
+    // Approximate sin/cos (~1e-7) when computing transforms, see fastmath.hpp
+    bool fast_trig = false;
+    // Number of nodes with the CACHE_AS_BITMAP flag set
+    size_t cache_nodes = 0;
+    // Pixel space output of process_render, one row per node
+    RenderData render;
+
+    ColumnView<double> pos_x() { return data.view<COL_POS_X>(); }
+    ColumnView<double> pos_y() { return data.view<COL_POS_Y>(); }
+    ColumnView<double> r_pos_x() { return data.view<COL_R_POS_X>(); }
+    ColumnView<double> r_pos_y() { return data.view<COL_R_POS_Y>(); }
+    ColumnView<double> o_pos_x() { return data.view<COL_O_POS_X>(); }
+    ColumnView<double> o_pos_y() { return data.view<COL_O_POS_Y>(); }
+    ColumnView<double> scale_x() { return data.view<COL_SCALE_X>(); }
+    ColumnView<double> scale_y() { return data.view<COL_SCALE_Y>(); }
+    ColumnView<double> r_scale_x() { return data.view<COL_R_SCALE_X>(); }
+    ColumnView<double> r_scale_y() { return data.view<COL_R_SCALE_Y>(); }
+    ColumnView<double> size_x() { return data.view<COL_SIZE_X>(); }
+    ColumnView<double> size_y() { return data.view<COL_SIZE_Y>(); }
+    ColumnView<double> rotation_center_x() {
+        return data.view<COL_ROTATION_CENTER_X>();
+    }
+    ColumnView<double> rotation_center_y() {
+        return data.view<COL_ROTATION_CENTER_Y>();
+    }
+    ColumnView<double> angle_vec() { return data.view<COL_ANGLE>(); }
+    ColumnView<double> r_angle_vec() { return data.view<COL_R_ANGLE>(); }
+    ColumnView<int> depth_vec() { return data.view<COL_DEPTH>(); }
+    ColumnView<int> r_depth_vec() { return data.view<COL_R_DEPTH>(); }
+    ColumnView<unsigned char> flag_vec() { return data.view<COL_FLAG>(); }
+    ColumnView<Origin> origin_vec() { return data.view<COL_ORIGIN>(); }
+    ColumnView<size_t> parent_vec() { return data.view<COL_PARENT>(); }
+    ColumnView<size_t> ref_vec() { return data.view<COL_REF>(); }
+
+    ColumnView<int> render_x() { return render.view<RCOL_X>(); }
+    ColumnView<int> render_y() { return render.view<RCOL_Y>(); }
+    ColumnView<int> render_w() { return render.view<RCOL_W>(); }
+    ColumnView<int> render_h() { return render.view<RCOL_H>(); }
+    ColumnView<int> render_cx() { return render.view<RCOL_CX>(); }
+    ColumnView<int> render_cy() { return render.view<RCOL_CY>(); }
+    ColumnView<double> render_angle() { return render.view<RCOL_ANGLE>(); }
+
+    size_t size() const { return data.size(); }
     size_t get_empty();
     void erase(const size_t node_id);
     void reserve(const size_t size);
+    void reset_arena();
 };
 
 
@@ -165,13 +261,15 @@ struct SceneGraphDataHandler {
 bool scene_traverse(SceneGraphDataHandler& sgdh, const size_t start_node = 0);
 void minimal_clean(SceneGraphDataHandler& sgdh, const size_t node_id);
 void dirty_path(SceneGraphDataHandler& sgdh, const size_t node_id,
-                SmallList<size_t>& path);
-void process_angle(SceneGraphDataHandler& sgdh, SmallList<size_t>& path);
-void process_depth(SceneGraphDataHandler& sgdh, SmallList<size_t>& path);
-void process_scale(SceneGraphDataHandler& sgdh, SmallList<size_t>& path);
-void process_origin(SceneGraphDataHandler& sgdh, SmallList<size_t>& path);
-void process_pos(SceneGraphDataHandler& sgdh, SmallList<size_t>& path);
-bool clear_dirty_flag(SceneGraphDataHandler& sgdh, SmallList<size_t>& path);
+                NodeList& path);
+void process_angle(SceneGraphDataHandler& sgdh, NodeList& path);
+void process_depth(SceneGraphDataHandler& sgdh, NodeList& path);
+void process_scale(SceneGraphDataHandler& sgdh, NodeList& path);
+void process_origin(SceneGraphDataHandler& sgdh, NodeList& path);
+void process_pos(SceneGraphDataHandler& sgdh, NodeList& path);
+void process_render(SceneGraphDataHandler& sgdh, const ViewTransform& view);
+bool clear_dirty_flag(SceneGraphDataHandler& sgdh, NodeList& path);
+void invalidate_cache(SceneGraphDataHandler& sgdh, const size_t node_id);
 
 
 // Node
@@ -194,7 +292,8 @@ public:
     bool hidden();
     void hide();
     void show();
-    void propagate_dirty();
+    void propagate_dirty(const bool moved = false);
+    SmallList<size_t> remove();
 
     size_t get_id();
     size_t get_parent_id();
@@ -257,14 +356,21 @@ public:
     void set_distance_relative(const bool v);  // Whether to scale distance
     bool get_distance_relative();
 
+    void set_cache_as_bitmap(const bool v);
+    bool get_cache_as_bitmap();
+    bool cache_valid();
+    void validate_cache();
+
     AABB get_aabb();
+    RenderRect get_render_rect();
+    Box get_box();
 
 private:
     SceneGraphDataHandler& sgdh;
     size_t node_id;
 
     inline void clean_node() {
-        if (sgdh.flag_vec[node_id] & DIRTY)  {
+        if (sgdh.flag_vec()[node_id] & DIRTY)  {
             minimal_clean(sgdh, node_id);
         }
     }
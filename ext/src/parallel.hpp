@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * Provides ``parallel_rows`` to split the rows of an image between threads,
+ * shared by the native rasterizers and resamplers.
+ */
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace foolysh {
+namespace tools {
+
+    // Minimum number of pixels per thread, below that threads cost more than
+    // they save.
+    const size_t PIXELS_PER_THREAD = 128 * 128;
+
+    /**
+     * Call ``fn(begin, end)`` for ``rows`` rows of ``width`` pixels, split
+     * between up to ``threads`` threads (0 = number of hardware threads).
+     * The calling thread processes the first block.
+     */
+    template <class Fn>
+    void
+    parallel_rows(const int rows, const int width, int threads, Fn fn) {
+        if (threads <= 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        const size_t pixels = static_cast<size_t>(rows) * width;
+        const size_t max_threads =
+            std::max<size_t>(pixels / PIXELS_PER_THREAD, 1);
+        threads = static_cast<int>(std::min<size_t>(threads, max_threads));
+        threads = std::min(threads, rows);
+        if (threads <= 1) {
+            fn(0, rows);
+            return;
+        }
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+        const int step = (rows + threads - 1) / threads;
+        for (int t = 1; t < threads; ++t) {
+            const int begin = std::min(t * step, rows);
+            workers.emplace_back(fn, begin, std::min(begin + step, rows));
+        }
+        fn(0, std::min(step, rows));
+        for (size_t i = 0; i < workers.size(); ++i) {
+            workers[i].join();
+        }
+    }
+
+}  // namespace tools
+}  // namespace foolysh
+
+#endif
@@ -0,0 +1,333 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * Provides chunked object pools with stable addresses and slot recycling:
+ *
+ * :Slab:
+ *      Untyped storage of fixed size slots, used for objects of different
+ *      (polymorphic) types that share one size class.
+ *
+ * :Pool:
+ *      Typed storage, addressed by an ``int`` id like ``ExtFreeList``. Objects
+ *      are constructed in place and destroyed on ``erase()``.
+ *
+ * Memory is only returned to the system when the pool is destroyed.
+ */
+
+#ifndef POOL_HPP
+#define POOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace foolysh {
+namespace tools {
+
+    class Slab {
+    public:
+        Slab(const size_t slot_size, const size_t slots_per_chunk = 64);
+        ~Slab();
+        Slab(const Slab& other) = delete;
+        Slab& operator=(const Slab& other) = delete;
+
+        void* allocate();
+        void deallocate(void* p);
+        size_t slot_size() const;
+        size_t size() const;
+        size_t capacity() const;
+
+    private:
+        struct FreeSlot {
+            FreeSlot* next;
+        };
+        std::vector<char*> _chunks;
+        FreeSlot* _first_free;
+        size_t _slot_size;
+        size_t _per_chunk;
+        size_t _next;
+        size_t _size;
+    };
+
+    template <class T, int N = 64>
+    class Pool {
+    public:
+        Pool();
+        ~Pool();
+        Pool(const Pool<T, N>& other) = delete;
+        Pool<T, N>& operator=(const Pool<T, N>& other) = delete;
+
+        template <class... Args>
+        int insert(Args&&... args);
+        void erase(int n);
+        void clear();
+        bool active(int n) const;
+        int range() const;
+        int capacity() const;
+        T& operator[](int n);
+        const T& operator[](int n) const;
+
+    private:
+        typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type
+            Storage;
+        T* _ptr(int n) const;
+
+        std::vector<Storage*> _chunks;
+        std::vector<int> _free;
+        std::vector<unsigned char> _live;
+        int _count;
+    };
+
+
+/**
+ * Slab
+ */
+
+/**
+ * ``slot_size`` is rounded up to keep every slot suitably aligned for any
+ * type.
+ */
+inline Slab::
+Slab(const size_t slot_size, const size_t slots_per_chunk)
+    : _first_free(nullptr), _per_chunk(slots_per_chunk),
+      _next(slots_per_chunk), _size(0) {
+    const size_t align = alignof(std::max_align_t);
+    const size_t s = std::max(slot_size, sizeof(FreeSlot));
+    _slot_size = (s + align - 1) / align * align;
+}
+
+/**
+ * Releases all chunks. Objects still alive are not destroyed.
+ */
+inline Slab::
+~Slab() {
+    for (auto c : _chunks) {
+        ::operator delete(c);
+    }
+}
+
+/**
+ * Return uninitialized storage for one slot.
+ */
+inline void* Slab::
+allocate() {
+    ++_size;
+    if (_first_free != nullptr) {
+        FreeSlot* slot = _first_free;
+        _first_free = slot->next;
+        return static_cast<void*>(slot);
+    }
+    if (_next == _per_chunk) {
+        _chunks.push_back(
+            static_cast<char*>(::operator new(_slot_size * _per_chunk)));
+        _next = 0;
+    }
+    return static_cast<void*>(_chunks.back() + _slot_size * _next++);
+}
+
+/**
+ * Return the slot ``p`` to the slab for reuse.
+ */
+inline void Slab::
+deallocate(void* p) {
+    FreeSlot* slot = static_cast<FreeSlot*>(p);
+    slot->next = _first_free;
+    _first_free = slot;
+    --_size;
+}
+
+/**
+ *
+ */
+inline size_t Slab::
+slot_size() const {
+    return _slot_size;
+}
+
+/**
+ * Number of allocated slots.
+ */
+inline size_t Slab::
+size() const {
+    return _size;
+}
+
+/**
+ * Number of slots available without allocating a new chunk.
+ */
+inline size_t Slab::
+capacity() const {
+    return _chunks.size() * _per_chunk;
+}
+
+
+/**
+ * Pool
+ */
+
+/**
+ *
+ */
+template <class T, int N>
+Pool<T, N>::Pool() : _count(0) {}
+
+/**
+ * Destroys all objects still alive.
+ */
+template <class T, int N>
+Pool<T, N>::~Pool() {
+    clear();
+    for (auto c : _chunks) {
+        delete[] c;
+    }
+}
+
+/**
+ * Construct a new element in place and return its id. Ids of erased elements
+ * are reused.
+ */
+template <class T, int N>
+template <class... Args>
+int Pool<T, N>::
+insert(Args&&... args) {
+    int n;
+    if (_free.size()) {
+        n = _free.back();
+        _free.pop_back();
+    }
+    else {
+        n = static_cast<int>(_live.size());
+        if (n == static_cast<int>(_chunks.size()) * N) {
+            _chunks.push_back(new Storage[N]);
+        }
+        _live.push_back(0);
+    }
+    try {
+        new (_ptr(n)) T(std::forward<Args>(args)...);
+    }
+    catch (...) {
+        _free.push_back(n);
+        throw;
+    }
+    _live[n] = 1;
+    ++_count;
+    return n;
+}
+
+/**
+ * Destroy the element with id ``n``.
+ */
+template <class T, int N>
+void Pool<T, N>::
+erase(int n) {
+    if (!active(n)) {
+        throw std::range_error("Tried to erase an inactive element.");
+    }
+    _live[n] = 0;
+    --_count;
+    _free.push_back(n);
+    _ptr(n)->~T();
+}
+
+/**
+ * Destroy all elements, keeping the chunks for reuse.
+ */
+template <class T, int N>
+void Pool<T, N>::
+clear() {
+    for (int i = 0; i < static_cast<int>(_live.size()); ++i) {
+        if (_live[i]) {
+            _live[i] = 0;
+            _ptr(i)->~T();
+        }
+    }
+    _live.clear();
+    _free.clear();
+    _count = 0;
+}
+
+/**
+ *
+ */
+template <class T, int N>
+bool Pool<T, N>::
+active(int n) const {
+    if (n < static_cast<int>(_live.size()) && n > -1) {
+        return _live[n] != 0;
+    }
+    return false;
+}
+
+/**
+ * Number of live elements.
+ */
+template <class T, int N>
+int Pool<T, N>::
+range() const {
+    return _count;
+}
+
+/**
+ * Number of elements that fit into the currently allocated chunks.
+ */
+template <class T, int N>
+int Pool<T, N>::
+capacity() const {
+    return static_cast<int>(_chunks.size()) * N;
+}
+
+/**
+ *
+ */
+template <class T, int N>
+T& Pool<T, N>::
+operator[](int n) {
+    return *_ptr(n);
+}
+
+/**
+ *
+ */
+template <class T, int N>
+const T& Pool<T, N>::
+operator[](int n) const {
+    return *_ptr(n);
+}
+
+/**
+ *
+ */
+template <class T, int N>
+T* Pool<T, N>::
+_ptr(int n) const {
+    return reinterpret_cast<T*>(&_chunks[n / N][n % N]);
+}
+
+
+}  // namespace tools
+}  // namespace foolysh
+
+#endif
@@ -40,6 +40,7 @@ namespace tools {
 Quadtree::
 Quadtree() {
     _aabb = AABB(0.0, 0.0, 1.0, 1.0);
+    _box = _aabb.box();
     _max_leaf_elements = 8;
     _max_depth = 8;
     _max_w = 0.0;
@@ -56,6 +57,7 @@ Quadtree() {
 Quadtree::
 Quadtree(AABB& aabb, const int max_leaf_elements, const int max_depth) {
     _aabb = aabb;
+    _box = _aabb.box();
     _max_leaf_elements = max_leaf_elements;
     _max_depth = max_depth;
     _max_w = 0.0;
@@ -75,20 +77,22 @@ query(AABB& aabb) {
     if (_nodes[0].first_child == -1) {
         return result;
     }
-    SmallList<int> to_process;
-    SmallList<AABB> quadrants;
-    /* Extend search AABB to allow for cheap point inside AABB check */
-    AABB search_aabb = AABB(aabb.x, aabb.y, aabb.hw + _max_w, aabb.hh + _max_h);
+    ArenaScope scope(_arena);
+    IndexStack to_process{ArenaAllocator<int>(&_arena)};
+    BoxStack quadrants{ArenaAllocator<Box>(&_arena)};
+    const Box query_box(aabb);
+    /* Extend search box to allow for cheap point inside box check */
+    const Box search_box = query_box.grown(_max_w, _max_h);
 
     to_process.push_back(0);
-    quadrants.push_back(_aabb);
+    quadrants.push_back(_box);
     while (to_process.size() > 0) {
         const int node_index = to_process.pop_back();
-        AABB quadrant = quadrants.pop_back();
+        const Box quadrant = quadrants.pop_back();
         if (_nodes[node_index].count == -1) {
             for (int i = 0; i < 4; ++i) {
-                AABB search_quadrant = quadrant.split((Quadrant) i);
-                if (search_aabb.overlap(search_quadrant)) {
+                const Box search_quadrant = quadrant.quadrant((Quadrant) i);
+                if (search_box.overlap(search_quadrant)) {
                     to_process.push_back(_nodes[node_index].first_child + i);
                     quadrants.push_back(search_quadrant);
                 }
@@ -99,7 +103,7 @@ query(AABB& aabb) {
             while (element_node_id != -1) {
                 QuadElementNode& qen = _element_nodes[element_node_id];
                 QuadElement& qe = _elements[qen.element];
-                if (aabb.overlap(qe.aabb)) {
+                if (query_box.overlap(qe.box)) {
                     result.push_back(qe.id);
                 }
                 element_node_id = qen.next;
@@ -116,9 +120,22 @@ bool Quadtree::
 insert(const int id, AABB& aabb) {
     QuadElement qe;
     qe.id = id;
-    qe.aabb = aabb;
+    qe.x = aabb.x;
+    qe.y = aabb.y;
+    qe.box = Box(aabb);
+    _insert(qe);
+    _max_w = std::max(_max_w, aabb.hw);
+    _max_h = std::max(_max_h, aabb.hh);
+    return true;
+}
+
+/**
+ * Store ``qe`` and link it into the leaf containing its center.
+ */
+void Quadtree::
+_insert(const QuadElement& qe) {
     const int element_id = _elements.insert(qe);
-    const int prev_qen_id = _insert_element_node(aabb);
+    const int prev_qen_id = _insert_element_node(qe.x, qe.y);
     if (_element_nodes[prev_qen_id].element == -1) {
         /* First Element */
         _element_nodes[prev_qen_id].element = element_id;
@@ -129,9 +146,6 @@ insert(const int id, AABB& aabb) {
         const int element_node_id = _element_nodes.insert(qen);
         _element_nodes[prev_qen_id].next = element_node_id;
     }
-    _max_w = std::max(_max_w, aabb.hw);
-    _max_h = std::max(_max_h, aabb.hh);
-    return true;
 }
 
 /**
@@ -139,9 +153,10 @@ insert(const int id, AABB& aabb) {
  * the node count by 1.
  */
 int Quadtree::
-_insert_element_node(AABB& aabb) {
-    AABB current_quadrant = _aabb;
-    SmallList<int> to_process;
+_insert_element_node(const double x, const double y) {
+    Box current_quadrant = _box;
+    ArenaScope scope(_arena);
+    IndexStack to_process{ArenaAllocator<int>(&_arena)};
     int depth = 0;
     to_process.push_back(0);
 
@@ -172,9 +187,9 @@ _insert_element_node(AABB& aabb) {
             }
         }
         /* Is Branch */
-        Quadrant quadrant = current_quadrant.find_quadrant(aabb.x, aabb.y);
+        Quadrant quadrant = current_quadrant.find_quadrant(x, y);
         to_process.push_back(_nodes[node_index].first_child + (int) quadrant);
-        current_quadrant = current_quadrant.split(quadrant);
+        current_quadrant = current_quadrant.quadrant(quadrant);
         ++depth;
     }
     throw std::logic_error("Could not find appropriate element node!");
@@ -184,8 +199,9 @@ _insert_element_node(AABB& aabb) {
  * Convert Leaf to Branch.
  */
 void Quadtree::
-_leaf_to_branch(const int node_id, AABB& aabb) {
-    SmallList<int> elements;
+_leaf_to_branch(const int node_id, const Box& box) {
+    ArenaScope scope(_arena);
+    IndexStack elements{ArenaAllocator<int>(&_arena)};
     if (_nodes[node_id].first_child != -1) {
         int element_node_id = _nodes[node_id].first_child;
         do {
@@ -205,8 +221,8 @@ _leaf_to_branch(const int node_id, AABB& aabb) {
     _nodes[node_id].count = -1;
     while (elements.size() > 0) {
         int element_id = elements.pop_back();
-        int child_node_id = first_child + (int) aabb.find_quadrant(
-            _elements[element_id].aabb.x, _elements[element_id].aabb.y);
+        int child_node_id = first_child + (int) box.find_quadrant(
+            _elements[element_id].x, _elements[element_id].y);
         QuadElementNode qen;
         qen.next = -1;
         qen.element = element_id;
@@ -244,15 +260,16 @@ remove(const int id, AABB& aabb) {
 /*    if (_nodes[0].count != -1) {
         throw std::logic_error("Unable to remove, Quadtree is empty");
     } */
-    AABB current_quadrant = _aabb;
-    SmallList<int> to_process;
+    Box current_quadrant = _box;
+    ArenaScope scope(_arena);
+    IndexStack to_process{ArenaAllocator<int>(&_arena)};
     to_process.push_back(0);
     while (to_process.size() > 0) {
         const int node_index = to_process.pop_back();
         QuadNode& node = _nodes[node_index];
         if (node.count == -1) {
             Quadrant q = current_quadrant.find_quadrant(aabb.x, aabb.y);
-            current_quadrant = current_quadrant.split(q);
+            current_quadrant = current_quadrant.quadrant(q);
             to_process.push_back(node.first_child + (int) q);
         }
         else {
@@ -304,7 +321,8 @@ remove(const int id, AABB& aabb) {
  */
 bool Quadtree::
 cleanup() {
-    SmallList<int> to_process;
+    ArenaScope scope(_arena);
+    IndexStack to_process{ArenaAllocator<int>(&_arena)};
     if (_nodes[0].count == -1){
         to_process.push_back(0);
     }
@@ -342,7 +360,7 @@ cleanup() {
  */
 bool Quadtree::
 inside(const double x, const double y) {
-    return _aabb.inside(x, y);
+    return _box.inside(x, y);
 }
 
 /**
@@ -350,48 +368,36 @@ inside(const double x, const double y) {
  */
 bool Quadtree::
 inside(Vec2& v) {
-    return _aabb.inside(v[0], v[1]);
+    return _box.inside(v.x(), v.y());
 }
 
 /**
  * Resize Quadtree to new ``aabb``. Temporarily stores all QuadElement indices
- * for later reinsertion into the cleared and resized Quadtree.
+ * for later reinsertion into the cleared and resized Quadtree. The indices are
+ * read from the occupancy bitset of the element list instead of walking the
+ * tree. The element set doesn't change, so the maximum element extents stay
+ * valid.
  */
 void Quadtree::
 resize(AABB& aabb) {
-    SmallList<int> elements, to_process;
-    if (_nodes[0].count == -1){
-        to_process.push_back(0);
-    }
-
-    while (to_process.size() > 0) {
-        const int node_index = to_process.pop_back();
-        if (_nodes[node_index].count == -1) {
-            for (int i = 0; i < 4; ++i) {
-                to_process.push_back(_nodes[node_index].first_child + i);
-            }
-        }
-        else {
-            int next = _nodes[node_index].first_child;
-            while (next != -1) {
-                elements.push_back(_element_nodes[next].element);
-                next = _element_nodes[next].next;
-            }
-        }
-    }
+    ArenaScope scope(_arena);
+    IndexStack elements{ArenaAllocator<int>(&_arena)};
+    _elements.for_each_active([&elements](const int n) {
+        elements.push_back(n);
+    });
     _aabb = aabb;
+    _box = _aabb.box();
     _element_nodes.clear();
     _nodes.clear();
-    _max_w = 0.0;
-    _max_h = 0.0;
     QuadNode root;
     root.first_child = -1;
     root.count = -1;
     _nodes.push_back(root);
     while (elements.size() > 0) {
         const int element_id = elements.pop_back();
-        insert(_elements[element_id].id, _elements[element_id].aabb);
+        const QuadElement qe = _elements[element_id];
         _elements.erase(element_id);
+        _insert(qe);
     }
 }
 
@@ -30,14 +30,19 @@
 
 #include <vector>
 #include "aabb.hpp"
+#include "arena.hpp"
 #include "list_t.hpp"
 #include "vec2.hpp"
 
+using foolysh::tools::ExtFreeList;
 using foolysh::tools::FreeList;
 using foolysh::tools::SmallList;
 
 namespace foolysh {
 namespace tools {
+    typedef SmallList<int, ArenaAllocator<int>> IndexStack;
+    typedef SmallList<Box, ArenaAllocator<Box>> BoxStack;
+
     struct QuadNode {
         int first_child;
         int count;
@@ -45,7 +50,8 @@ namespace tools {
 
     struct QuadElement {
         int id;
-        AABB aabb;
+        double x, y;  // Center, used to place the element in a leaf
+        Box box;
     };
 
     struct QuadElementNode {
@@ -67,11 +73,14 @@ namespace tools {
         void resize(AABB& aabb);
 
     private:
-        int _insert_element_node(AABB& aabb);
-        void _leaf_to_branch(const int node_id, AABB& aabb);
+        void _insert(const QuadElement& qe);
+        int _insert_element_node(const double x, const double y);
+        void _leaf_to_branch(const int node_id, const Box& box);
 
         AABB _aabb;
-        FreeList<QuadElement> _elements;
+        Box _box;
+        FrameArena _arena;  // Scratch memory for search stacks
+        ExtFreeList<QuadElement> _elements;
         FreeList<QuadElementNode> _element_nodes;
         std::vector<QuadNode> _nodes;
         int _free_node;
@@ -0,0 +1,324 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * RGBA8 resampler, see resample.hpp.
+ */
+
+#include "resample.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__SSE2__)
+#define FOOLYSH_RESAMPLE_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace foolysh {
+namespace tools {
+namespace resample {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+double
+sinc(double x) {
+    if (x == 0.0) {
+        return 1.0;
+    }
+    x *= PI;
+    return std::sin(x) / x;
+}
+
+/**
+ * Filter kernel at ``x`` source pixels from the sample center.
+ */
+double
+kernel(const Filter filter, double x) {
+    switch (filter) {
+    case BOX:
+        return (x > -0.5 && x <= 0.5) ? 1.0 : 0.0;
+    case BILINEAR:
+        x = std::fabs(x);
+        return x < 1.0 ? 1.0 - x : 0.0;
+    case BICUBIC: {
+        const double a = -0.5;
+        x = std::fabs(x);
+        if (x < 1.0) {
+            return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+        }
+        if (x < 2.0) {
+            return (((x - 5.0) * x + 8.0) * x - 4.0) * a;
+        }
+        return 0.0;
+    }
+    default:
+        return (x > -3.0 && x < 3.0) ? sinc(x) * sinc(x / 3.0) : 0.0;
+    }
+}
+
+double
+support(const Filter filter) {
+    switch (filter) {
+    case BOX:
+        return 0.5;
+    case BILINEAR:
+        return 1.0;
+    case BICUBIC:
+        return 2.0;
+    default:
+        return 3.0;
+    }
+}
+
+/**
+ * Normalized weights of the source pixels ``first[i]`` to ``first[i] +
+ * count[i]`` that contribute to output pixel ``i``, ``taps`` per pixel.
+ */
+struct Coefficients {
+    std::vector<int> first, count;
+    std::vector<float> weights;
+    int taps;
+};
+
+Coefficients
+coefficients(const int in_size, const int out_size, const Filter filter) {
+    const double scale = static_cast<double>(in_size) / out_size;
+    const double filter_scale = std::max(scale, 1.0);
+    const double radius = support(filter) * filter_scale;
+    Coefficients c;
+    c.taps = static_cast<int>(std::ceil(radius)) * 2 + 1;
+    c.first.resize(out_size);
+    c.count.resize(out_size);
+    c.weights.assign(static_cast<size_t>(out_size) * c.taps, 0.0f);
+    std::vector<double> w(c.taps);
+    for (int i = 0; i < out_size; ++i) {
+        const double center = (i + 0.5) * scale;
+        const int lo = std::max(static_cast<int>(center - radius + 0.5), 0);
+        const int hi = std::min(static_cast<int>(center + radius + 0.5),
+                                in_size);
+        const int n = std::min(hi - lo, c.taps);
+        double sum = 0.0;
+        for (int k = 0; k < n; ++k) {
+            w[k] = kernel(filter, (lo + k - center + 0.5) / filter_scale);
+            sum += w[k];
+        }
+        c.first[i] = lo;
+        c.count[i] = n;
+        float* out = &c.weights[static_cast<size_t>(i) * c.taps];
+        for (int k = 0; k < n; ++k) {
+            out[k] = static_cast<float>(sum != 0.0 ? w[k] / sum : 0.0);
+        }
+    }
+    return c;
+}
+
+#ifdef FOOLYSH_RESAMPLE_SSE
+
+/**
+ * ``n`` straight alpha RGBA8 pixels to premultiplied floats.
+ */
+inline void
+premultiply(const uint8_t* src, float* out, const int n) {
+    const __m128i zero = _mm_setzero_si128();
+    for (int i = 0; i < n; ++i) {
+        const __m128i px = _mm_cvtsi32_si128(
+            *reinterpret_cast<const int*>(src + i * 4));
+        const __m128 v = _mm_cvtepi32_ps(_mm_unpacklo_epi16(
+            _mm_unpacklo_epi8(px, zero), zero));
+        const float a = src[i * 4 + 3] * (1.0f / 255.0f);
+        _mm_storeu_ps(out + i * 4, _mm_mul_ps(v, _mm_set_ps(1.0f, a, a, a)));
+    }
+}
+
+/**
+ * Weighted sum of ``n`` RGBA float pixels into ``out``.
+ */
+inline void
+convolve(const float* px, const float* w, const int n, float* out) {
+    __m128 acc = _mm_setzero_ps();
+    for (int k = 0; k < n; ++k) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(w[k]),
+                                         _mm_loadu_ps(px + k * 4)));
+    }
+    _mm_storeu_ps(out, acc);
+}
+
+/**
+ * ``acc += w * px`` for ``n`` RGBA float pixels.
+ */
+inline void
+accumulate(float* acc, const float* px, const float w, const int n) {
+    const __m128 wv = _mm_set1_ps(w);
+    for (int i = 0; i < n; ++i) {
+        const __m128 p = _mm_mul_ps(wv, _mm_loadu_ps(px + i * 4));
+        _mm_storeu_ps(acc + i * 4, _mm_add_ps(_mm_loadu_ps(acc + i * 4), p));
+    }
+}
+
+/**
+ * ``n`` premultiplied float pixels to straight alpha RGBA8.
+ */
+inline void
+unpremultiply(const float* acc, uint8_t* out, const int n) {
+    const __m128 lo = _mm_setzero_ps(), hi = _mm_set1_ps(255.0f);
+    for (int i = 0; i < n; ++i) {
+        const float a = std::min(std::max(acc[i * 4 + 3], 0.0f), 255.0f);
+        const float inv = a > 0.0f ? 255.0f / a : 0.0f;
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(acc + i * 4),
+                              _mm_set_ps(1.0f, inv, inv, inv));
+        v = _mm_min_ps(_mm_max_ps(v, lo), hi);
+        const __m128i px = _mm_cvtps_epi32(v);
+        const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(px, px), px);
+        *reinterpret_cast<int*>(out + i * 4) = _mm_cvtsi128_si32(packed);
+    }
+}
+
+#else
+
+inline void
+premultiply(const uint8_t* src, float* out, const int n) {
+    for (int i = 0; i < n; ++i) {
+        const float a = src[i * 4 + 3] * (1.0f / 255.0f);
+        out[i * 4] = src[i * 4] * a;
+        out[i * 4 + 1] = src[i * 4 + 1] * a;
+        out[i * 4 + 2] = src[i * 4 + 2] * a;
+        out[i * 4 + 3] = src[i * 4 + 3];
+    }
+}
+
+inline void
+convolve(const float* px, const float* w, const int n, float* out) {
+    float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (int k = 0; k < n; ++k) {
+        for (int i = 0; i < 4; ++i) {
+            acc[i] += w[k] * px[k * 4 + i];
+        }
+    }
+    std::copy(acc, acc + 4, out);
+}
+
+inline void
+accumulate(float* acc, const float* px, const float w, const int n) {
+    for (int i = 0; i < n * 4; ++i) {
+        acc[i] += w * px[i];
+    }
+}
+
+inline void
+unpremultiply(const float* acc, uint8_t* out, const int n) {
+    for (int i = 0; i < n; ++i) {
+        const float* p = acc + i * 4;
+        const float a = std::min(std::max(p[3], 0.0f), 255.0f);
+        const float inv = a > 0.0f ? 255.0f / a : 0.0f;
+        for (int j = 0; j < 3; ++j) {
+            out[i * 4 + j] = static_cast<uint8_t>(
+                std::min(std::max(p[j] * inv, 0.0f), 255.0f) + 0.5f);
+        }
+        out[i * 4 + 3] = static_cast<uint8_t>(a + 0.5f);
+    }
+}
+
+#endif
+
+/**
+ * Filter source rows ``begin`` to ``end`` horizontally into ``tmp``
+ * (premultiplied RGBA floats, ``dst_w`` pixels per row).
+ */
+void
+horizontal(const uint8_t* src, const int src_w, const Coefficients& c,
+           float* tmp, const int dst_w, const int begin, const int end) {
+    std::vector<float> row(static_cast<size_t>(src_w) * 4);
+    for (int y = begin; y < end; ++y) {
+        premultiply(src + static_cast<size_t>(y) * src_w * 4, row.data(),
+                    src_w);
+        float* out = tmp + static_cast<size_t>(y) * dst_w * 4;
+        for (int x = 0; x < dst_w; ++x) {
+            convolve(&row[static_cast<size_t>(c.first[x]) * 4],
+                     &c.weights[static_cast<size_t>(x) * c.taps], c.count[x],
+                     out + x * 4);
+        }
+    }
+}
+
+/**
+ * Filter ``tmp`` vertically into output rows ``begin`` to ``end`` and convert
+ * back to straight alpha RGBA8.
+ */
+void
+vertical(const float* tmp, const Coefficients& c, uint8_t* dst,
+         const int dst_w, const int begin, const int end) {
+    std::vector<float> acc(static_cast<size_t>(dst_w) * 4);
+    for (int y = begin; y < end; ++y) {
+        std::fill(acc.begin(), acc.end(), 0.0f);
+        const float* w = &c.weights[static_cast<size_t>(y) * c.taps];
+        for (int k = 0; k < c.count[y]; ++k) {
+            accumulate(acc.data(),
+                       tmp + static_cast<size_t>(c.first[y] + k) * dst_w * 4,
+                       w[k], dst_w);
+        }
+        unpremultiply(acc.data(), dst + static_cast<size_t>(y) * dst_w * 4,
+                      dst_w);
+    }
+}
+
+}  // namespace
+
+/**
+ * Resample ``src`` (``src_w * src_h * 4`` bytes, straight alpha) into ``dst``
+ * (``dst_w * dst_h * 4`` bytes).
+ */
+void
+resize(Span<const uint8_t> src, const int src_w, const int src_h,
+       Span<uint8_t> dst, const int dst_w, const int dst_h,
+       const Filter filter, const int threads) {
+    if (src_w <= 0 || src_h <= 0 || dst_w <= 0 || dst_h <= 0) {
+        throw std::invalid_argument("Expected positive image sizes.");
+    }
+    if (src.size() != static_cast<size_t>(src_w) * src_h * 4
+        || dst.size() != static_cast<size_t>(dst_w) * dst_h * 4) {
+        throw std::invalid_argument("Buffer size does not match image size.");
+    }
+    const Coefficients cx = coefficients(src_w, dst_w, filter);
+    const Coefficients cy = coefficients(src_h, dst_h, filter);
+    std::vector<float> tmp(static_cast<size_t>(dst_w) * src_h * 4);
+    const uint8_t* s = src.data;
+    float* t = tmp.data();
+    parallel_rows(src_h, std::max(src_w, dst_w), threads,
+                  [&](const int begin, const int end) {
+                      horizontal(s, src_w, cx, t, dst_w, begin, end);
+                  });
+    uint8_t* d = dst.data;
+    parallel_rows(dst_h, dst_w, threads,
+                  [&](const int begin, const int end) {
+                      vertical(t, cy, d, dst_w, begin, end);
+                  });
+}
+
+}  // namespace resample
+}  // namespace tools
+}  // namespace foolysh
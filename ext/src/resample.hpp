@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * Resamples RGBA8 images with a box, bilinear, bicubic or Lanczos filter.
+ *
+ * The image is filtered separately in x and y with precomputed weights.
+ * Filtering happens on premultiplied colors, so fully transparent pixels
+ * don't bleed their color into the edges of opaque ones. When downscaling,
+ * the filter support grows with the scale factor, so every source pixel
+ * contributes. Callers that scale down a lot should first halve the image
+ * with ``BOX`` while it stays at least twice the target size (mip levels).
+ *
+ * Pixels are processed as four float lanes with SSE2 where available. Rows
+ * are split between threads for large images.
+ */
+
+#ifndef RESAMPLE_HPP
+#define RESAMPLE_HPP
+
+#include <cstdint>
+
+#include "soa.hpp"
+
+namespace foolysh {
+namespace tools {
+namespace resample {
+
+    template <class T>
+    using Span = ColumnView<T>;
+
+    enum Filter {
+        BOX,
+        BILINEAR,
+        BICUBIC,
+        LANCZOS
+    };
+
+    void resize(Span<const uint8_t> src, const int src_w, const int src_h,
+                Span<uint8_t> dst, const int dst_w, const int dst_h,
+                const Filter filter, const int threads = 0);
+
+}  // namespace resample
+}  // namespace tools
+}  // namespace foolysh
+
+#endif
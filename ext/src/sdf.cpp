@@ -0,0 +1,278 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * SDF shape rasterizer, see sdf.hpp.
+ */
+
+#include "sdf.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define FOOLYSH_SDF_AVX 1
+#include <immintrin.h>
+#define AVX_FN __attribute__((target("avx")))
+#endif
+
+namespace foolysh {
+namespace tools {
+namespace sdf {
+
+namespace {
+
+/**
+ * Rounded box centered at ``cx``/``cy`` with half extents ``bx + r`` and
+ * ``by + r``. ``ht`` is half the border thickness, ``border`` 1 if there is a
+ * border, otherwise 0.
+ */
+struct Shape {
+    float cx, cy, bx, by, r, ht, border;
+};
+
+namespace scalar {
+
+/**
+ * Fill and border coverage of pixels ``begin`` to ``end`` of the row with
+ * pixel center ``py``.
+ */
+void
+coverage(const Shape& s, const float py, float* fill, float* border,
+         const int begin, const int end) {
+    const float qy = std::fabs(py - s.cy) - s.by;
+    const float qy_out = std::max(qy, 0.0f);
+    for (int i = begin; i < end; ++i) {
+        const float qx = std::fabs(i + 0.5f - s.cx) - s.bx;
+        const float qx_out = std::max(qx, 0.0f);
+        const float d = std::sqrt(qx_out * qx_out + qy_out * qy_out)
+                        + std::min(std::max(qx, qy), 0.0f) - s.r;
+        fill[i] = std::min(std::max(0.5f - (d + s.ht), 0.0f), 1.0f);
+        const float db = std::fabs(d + s.ht) - s.ht;
+        border[i] = std::min(std::max(0.5f - db, 0.0f), 1.0f) * s.border;
+    }
+}
+
+}  // namespace scalar
+
+#ifdef FOOLYSH_SDF_AVX
+namespace avx {
+
+/**
+ * Same as ``scalar::coverage`` for the whole row, eight pixels at a time.
+ */
+AVX_FN void
+coverage(const Shape& s, const float py, float* fill, float* border,
+         const int width) {
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 cx = _mm256_set1_ps(s.cx);
+    const __m256 bx = _mm256_set1_ps(s.bx);
+    const __m256 r = _mm256_set1_ps(s.r);
+    const __m256 ht = _mm256_set1_ps(s.ht);
+    const __m256 has_border = _mm256_set1_ps(s.border);
+    const __m256 offsets = _mm256_set_ps(7.5f, 6.5f, 5.5f, 4.5f, 3.5f, 2.5f,
+                                         1.5f, 0.5f);
+    const float qy_s = std::fabs(py - s.cy) - s.by;
+    const __m256 qy = _mm256_set1_ps(qy_s);
+    const float qy_out = std::max(qy_s, 0.0f);
+    const __m256 qy_sq = _mm256_set1_ps(qy_out * qy_out);
+    int i = 0;
+    for (; i + 8 <= width; i += 8) {
+        const __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)),
+                                        offsets);
+        const __m256 qx = _mm256_sub_ps(
+            _mm256_andnot_ps(sign, _mm256_sub_ps(px, cx)), bx);
+        const __m256 qx_out = _mm256_max_ps(qx, zero);
+        const __m256 outside = _mm256_sqrt_ps(
+            _mm256_add_ps(_mm256_mul_ps(qx_out, qx_out), qy_sq));
+        const __m256 inside = _mm256_min_ps(_mm256_max_ps(qx, qy), zero);
+        const __m256 d = _mm256_sub_ps(_mm256_add_ps(outside, inside), r);
+        const __m256 df = _mm256_add_ps(d, ht);
+        _mm256_storeu_ps(fill + i, _mm256_min_ps(
+            _mm256_max_ps(_mm256_sub_ps(half, df), zero), one));
+        const __m256 db = _mm256_sub_ps(_mm256_andnot_ps(sign, df), ht);
+        _mm256_storeu_ps(border + i, _mm256_mul_ps(_mm256_min_ps(
+            _mm256_max_ps(_mm256_sub_ps(half, db), zero), one), has_border));
+    }
+    scalar::coverage(s, py, fill, border, i, width);
+}
+
+}  // namespace avx
+#endif
+
+batch::SimdLevel
+detect_simd_level() {
+#ifdef FOOLYSH_SDF_AVX
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx")) {
+        return batch::AVX;
+    }
+#endif
+    return batch::SCALAR;
+}
+
+batch::SimdLevel&
+active_level() {
+    static batch::SimdLevel level = detect_simd_level();
+    return level;
+}
+
+/**
+ * Composite border over fill for one row and write RGBA8 pixels.
+ */
+void
+compose(const float* fill, const float* border, const Style& style,
+        uint8_t* out, const int width) {
+    const float fa = style.fill.a / 255.0f, ba = style.border.a / 255.0f;
+    const float fr = style.fill.r, fg = style.fill.g, fb = style.fill.b;
+    const float br = style.border.r, bg = style.border.g, bb = style.border.b;
+    for (int i = 0; i < width; ++i) {
+        const float a_b = border[i] * ba;
+        const float a_f = fill[i] * fa * (1.0f - a_b);
+        const float a = a_b + a_f;
+        float r = fr * a_f + br * a_b;
+        float g = fg * a_f + bg * a_b;
+        float b = fb * a_f + bb * a_b;
+        if (!style.premultiplied) {
+            const float inv = a > 0.0f ? 1.0f / a : 0.0f;
+            r *= inv;
+            g *= inv;
+            b *= inv;
+        }
+        uint8_t* p = out + i * 4;
+        p[0] = static_cast<uint8_t>(std::min(r + 0.5f, 255.0f));
+        p[1] = static_cast<uint8_t>(std::min(g + 0.5f, 255.0f));
+        p[2] = static_cast<uint8_t>(std::min(b + 0.5f, 255.0f));
+        p[3] = static_cast<uint8_t>(std::min(a * 255.0f + 0.5f, 255.0f));
+    }
+}
+
+/**
+ * Rasterize rows ``begin`` to ``end``.
+ */
+void
+rasterize_rows(const Shape& s, const Style& style, uint8_t* out,
+               const int width, const int begin, const int end,
+               const bool use_avx) {
+    std::vector<float> fill(width), border(width);
+    for (int y = begin; y < end; ++y) {
+        const float py = y + 0.5f;
+#ifdef FOOLYSH_SDF_AVX
+        if (use_avx) {
+            avx::coverage(s, py, fill.data(), border.data(), width);
+        }
+        else {
+            scalar::coverage(s, py, fill.data(), border.data(), 0, width);
+        }
+#else
+        (void) use_avx;
+        scalar::coverage(s, py, fill.data(), border.data(), 0, width);
+#endif
+        compose(fill.data(), border.data(), style,
+                out + static_cast<size_t>(y) * width * 4, width);
+    }
+}
+
+/**
+ * Rasterize a rounded box of ``width`` x ``height`` pixels, splitting the rows
+ * between up to ``threads`` threads (0 = number of hardware threads).
+ */
+void
+rasterize(Span<uint8_t> out, const int width, const int height,
+          double corner_radius, const Style& style, int threads) {
+    if (width <= 0 || height <= 0) {
+        throw std::invalid_argument("Expected positive width and height.");
+    }
+    const size_t pixels = static_cast<size_t>(width) * height;
+    if (out.size() != pixels * 4) {
+        throw std::invalid_argument("Output size does not match image size.");
+    }
+    if (style.border_thickness < 0.0) {
+        throw std::invalid_argument("Expected non negative border_thickness.");
+    }
+    const double hw = width * 0.5, hh = height * 0.5;
+    corner_radius = std::min(std::max(corner_radius, 0.0), std::min(hw, hh));
+    Shape s;
+    s.cx = static_cast<float>(hw);
+    s.cy = static_cast<float>(hh);
+    s.bx = static_cast<float>(hw - corner_radius);
+    s.by = static_cast<float>(hh - corner_radius);
+    s.r = static_cast<float>(corner_radius);
+    s.ht = static_cast<float>(style.border_thickness * 0.5);
+    s.border = style.border_thickness > 0.0 ? 1.0f : 0.0f;
+
+    const bool use_avx = active_level() == batch::AVX;
+    uint8_t* data = out.data;
+    parallel_rows(height, width, threads,
+                  [&](const int begin, const int end) {
+                      rasterize_rows(s, style, data, width, begin, end,
+                                     use_avx);
+                  });
+}
+
+}  // namespace
+
+/**
+ * Return the SIMD level currently used by the distance pass.
+ */
+batch::SimdLevel
+simd_level() {
+    return active_level();
+}
+
+/**
+ * Select the SIMD level, ``level`` is capped at what the CPU supports.
+ */
+void
+set_simd_level(batch::SimdLevel level) {
+    active_level() = std::min(level, detect_simd_level());
+}
+
+/**
+ * Rasterize a box of ``width`` x ``height`` pixels with rounded corners of
+ * ``corner_radius`` pixels into ``out`` (``width * height * 4`` bytes).
+ */
+void
+box(Span<uint8_t> out, const int width, const int height,
+    const double corner_radius, const Style& style, const int threads) {
+    rasterize(out, width, height, corner_radius, style, threads);
+}
+
+/**
+ * Rasterize a circle of ``radius`` pixels into ``out`` (``2 * radius`` square,
+ * ``16 * radius * radius`` bytes).
+ */
+void
+circle(Span<uint8_t> out, const int radius, const Style& style,
+       const int threads) {
+    rasterize(out, radius * 2, radius * 2, radius, style, threads);
+}
+
+}  // namespace sdf
+}  // namespace tools
+}  // namespace foolysh
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * Rasterizes signed distance field shapes (boxes, rounded boxes, circles and
+ * their frames) straight into RGBA8 pixels.
+ *
+ * Coverage is computed analytically from the distance of the pixel center to
+ * the shape edge (``clamp(0.5 - d, 0, 1)``), so no supersampling is needed.
+ * The optional border is a band of ``border_thickness`` pixels inside the
+ * edge, composited over the fill. Output is straight alpha unless
+ * ``premultiplied`` is set.
+ *
+ * Rows are split between threads for large images. The distance pass uses
+ * AVX when the CPU supports it, like the kernels in batch.hpp.
+ */
+
+#ifndef SDF_HPP
+#define SDF_HPP
+
+#include <cstdint>
+
+#include "batch.hpp"
+#include "soa.hpp"
+
+namespace foolysh {
+namespace tools {
+namespace sdf {
+
+    template <class T>
+    using Span = ColumnView<T>;
+
+    struct Rgba {
+        uint8_t r, g, b, a;
+    };
+
+    struct Style {
+        Rgba fill;
+        Rgba border;
+        double border_thickness;
+        bool premultiplied;
+    };
+
+    batch::SimdLevel simd_level();
+    void set_simd_level(batch::SimdLevel level);
+
+    void box(Span<uint8_t> out, const int width, const int height,
+             const double corner_radius, const Style& style,
+             const int threads = 0);
+    void circle(Span<uint8_t> out, const int radius, const Style& style,
+                const int threads = 0);
+
+}  // namespace sdf
+}  // namespace tools
+}  // namespace foolysh
+
+#endif
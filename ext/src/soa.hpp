@@ -0,0 +1,456 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * Provides a structure of arrays container. All columns share one allocation,
+ * grow together and every column starts at a ``SOA_ALIGNMENT`` byte boundary,
+ * so columns can be processed with aligned SIMD loads. Column types must be
+ * trivially copyable.
+ *
+ * Columns are addressed by index, e.g. ``soa.view<0>()[row]``.
+ */
+
+#ifndef SOA_HPP
+#define SOA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+
+namespace foolysh {
+namespace tools {
+
+    const size_t SOA_ALIGNMENT = 32;
+
+    namespace detail {
+        template <size_t... Is>
+        struct IndexSequence {};
+
+        template <size_t N, size_t... Is>
+        struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, Is...> {};
+
+        template <size_t... Is>
+        struct MakeIndexSequence<0, Is...> {
+            typedef IndexSequence<Is...> type;
+        };
+
+        template <class... Ts>
+        struct AllTrivial : std::true_type {};
+
+        template <class T, class... Ts>
+        struct AllTrivial<T, Ts...> : std::integral_constant<bool,
+            std::is_trivially_copyable<T>::value
+            && AllTrivial<Ts...>::value> {};
+    }  // namespace detail
+
+    /**
+     * Non owning, bounds aware view of one column.
+     */
+    template <class T>
+    struct ColumnView {
+        ColumnView() : data(nullptr), count(0) {}
+        ColumnView(T* d, const size_t s) : data(d), count(s) {}
+        T& operator[](const size_t n) const { return data[n]; }
+        T* begin() const { return data; }
+        T* end() const { return data + count; }
+        size_t size() const { return count; }
+
+        T* data;
+        size_t count;
+    };
+
+    template <class... Columns>
+    class SoA {
+        static_assert(sizeof...(Columns) > 0, "SoA requires columns");
+        static_assert(detail::AllTrivial<Columns...>::value,
+                      "SoA columns must be trivially copyable");
+
+    public:
+        static const size_t column_count = sizeof...(Columns);
+        template <size_t I>
+        using column_type =
+            typename std::tuple_element<I, std::tuple<Columns...>>::type;
+
+        SoA();
+        ~SoA();
+        SoA(const SoA<Columns...>& other);
+        SoA(SoA<Columns...>&& other) noexcept;
+        SoA<Columns...>& operator=(const SoA<Columns...>& other);
+        SoA<Columns...>& operator=(SoA<Columns...>&& other) noexcept;
+
+        size_t push_back(const Columns&... values);
+        void resize(const size_t n);
+        void reserve(const size_t n);
+        void swap_remove(const size_t n);
+        template <class Pred>
+        size_t compact(Pred keep);
+        void clear();
+
+        size_t size() const;
+        size_t capacity() const;
+
+        template <size_t I>
+        column_type<I>* column();
+        template <size_t I>
+        const column_type<I>* column() const;
+        template <size_t I>
+        ColumnView<column_type<I>> view();
+
+    private:
+        template <size_t... Is>
+        void _assign(const size_t n, detail::IndexSequence<Is...>,
+                     const Columns&... values);
+        void _layout(const size_t n, size_t* offsets) const;
+        void _copy_row(const size_t from, const size_t to);
+        void _grow(const size_t min_capacity);
+        void _release();
+
+        static const size_t _sizes[sizeof...(Columns)];
+        char* _raw;
+        char* _base;
+        size_t _offsets[sizeof...(Columns)];
+        size_t _size;
+        size_t _capacity;
+    };
+
+
+/**
+ * SoA
+ */
+
+template <class... Columns>
+const size_t SoA<Columns...>::_sizes[sizeof...(Columns)] = {
+    sizeof(Columns)...};
+
+template <class... Columns>
+const size_t SoA<Columns...>::column_count;
+
+/**
+ *
+ */
+template <class... Columns>
+SoA<Columns...>::SoA()
+    : _raw(nullptr), _base(nullptr), _size(0), _capacity(0) {
+    std::memset(_offsets, 0, sizeof(_offsets));
+}
+
+/**
+ *
+ */
+template <class... Columns>
+SoA<Columns...>::~SoA() {
+    _release();
+}
+
+/**
+ *
+ */
+template <class... Columns>
+SoA<Columns...>::SoA(const SoA<Columns...>& other)
+    : _raw(nullptr), _base(nullptr), _size(0), _capacity(0) {
+    std::memset(_offsets, 0, sizeof(_offsets));
+    *this = other;
+}
+
+/**
+ *
+ */
+template <class... Columns>
+SoA<Columns...>::SoA(SoA<Columns...>&& other) noexcept
+    : _raw(other._raw), _base(other._base), _size(other._size),
+      _capacity(other._capacity) {
+    std::memcpy(_offsets, other._offsets, sizeof(_offsets));
+    other._raw = nullptr;
+    other._base = nullptr;
+    other._size = 0;
+    other._capacity = 0;
+}
+
+/**
+ *
+ */
+template <class... Columns>
+SoA<Columns...>& SoA<Columns...>::
+operator=(const SoA<Columns...>& other) {
+    if (this == &other) {
+        return *this;
+    }
+    _size = 0;
+    reserve(other._size);
+    for (size_t i = 0; i < column_count && other._size; ++i) {
+        std::memcpy(_base + _offsets[i], other._base + other._offsets[i],
+                    other._size * _sizes[i]);
+    }
+    _size = other._size;
+    return *this;
+}
+
+/**
+ *
+ */
+template <class... Columns>
+SoA<Columns...>& SoA<Columns...>::
+operator=(SoA<Columns...>&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    _release();
+    _raw = other._raw;
+    _base = other._base;
+    _size = other._size;
+    _capacity = other._capacity;
+    std::memcpy(_offsets, other._offsets, sizeof(_offsets));
+    other._raw = nullptr;
+    other._base = nullptr;
+    other._size = 0;
+    other._capacity = 0;
+    return *this;
+}
+
+/**
+ * Append a row and return its index.
+ */
+template <class... Columns>
+size_t SoA<Columns...>::
+push_back(const Columns&... values) {
+    if (_size == _capacity) {
+        _grow(_size + 1);
+    }
+    _assign(_size, typename detail::MakeIndexSequence<column_count>::type(),
+            values...);
+    return _size++;
+}
+
+/**
+ * Resize to ``n`` rows, new rows are zero initialized.
+ */
+template <class... Columns>
+void SoA<Columns...>::
+resize(const size_t n) {
+    if (n > _capacity) {
+        _grow(n);
+    }
+    if (n > _size) {
+        for (size_t i = 0; i < column_count; ++i) {
+            std::memset(_base + _offsets[i] + _size * _sizes[i], 0,
+                        (n - _size) * _sizes[i]);
+        }
+    }
+    _size = n;
+}
+
+/**
+ * Make room for ``n`` rows with a single allocation.
+ */
+template <class... Columns>
+void SoA<Columns...>::
+reserve(const size_t n) {
+    if (n <= _capacity) {
+        return;
+    }
+    size_t offsets[sizeof...(Columns)];
+    _layout(n, offsets);
+    const size_t total = offsets[column_count - 1]
+                         + n * _sizes[column_count - 1];
+    char* raw = static_cast<char*>(::operator new(total + SOA_ALIGNMENT));
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(raw);
+    char* base = raw + (SOA_ALIGNMENT - addr % SOA_ALIGNMENT) % SOA_ALIGNMENT;
+    for (size_t i = 0; i < column_count; ++i) {
+        if (_size) {
+            std::memcpy(base + offsets[i], _base + _offsets[i],
+                        _size * _sizes[i]);
+        }
+        _offsets[i] = offsets[i];
+    }
+    ::operator delete(_raw);
+    _raw = raw;
+    _base = base;
+    _capacity = n;
+}
+
+/**
+ * Remove row ``n`` by moving the last row into its place. Invalidates the
+ * index of the last row.
+ */
+template <class... Columns>
+void SoA<Columns...>::
+swap_remove(const size_t n) {
+    if (n >= _size) {
+        throw std::range_error("Row index out of range.");
+    }
+    --_size;
+    if (n != _size) {
+        _copy_row(_size, n);
+    }
+}
+
+/**
+ * Remove all rows for which ``keep(row)`` returns false, preserving the order
+ * of the remaining rows. Returns the new size.
+ */
+template <class... Columns>
+template <class Pred>
+size_t SoA<Columns...>::
+compact(Pred keep) {
+    size_t w = 0;
+    for (size_t r = 0; r < _size; ++r) {
+        if (keep(r)) {
+            if (w != r) {
+                _copy_row(r, w);
+            }
+            ++w;
+        }
+    }
+    _size = w;
+    return w;
+}
+
+/**
+ * Remove all rows, keeps the allocation.
+ */
+template <class... Columns>
+void SoA<Columns...>::
+clear() {
+    _size = 0;
+}
+
+/**
+ *
+ */
+template <class... Columns>
+size_t SoA<Columns...>::
+size() const {
+    return _size;
+}
+
+/**
+ *
+ */
+template <class... Columns>
+size_t SoA<Columns...>::
+capacity() const {
+    return _capacity;
+}
+
+/**
+ * Pointer to the first element of column ``I``.
+ */
+template <class... Columns>
+template <size_t I>
+typename SoA<Columns...>::template column_type<I>* SoA<Columns...>::
+column() {
+    return reinterpret_cast<column_type<I>*>(_base + _offsets[I]);
+}
+
+/**
+ *
+ */
+template <class... Columns>
+template <size_t I>
+const typename SoA<Columns...>::template column_type<I>* SoA<Columns...>::
+column() const {
+    return reinterpret_cast<const column_type<I>*>(_base + _offsets[I]);
+}
+
+/**
+ * View of column ``I``, invalidated when the container grows.
+ */
+template <class... Columns>
+template <size_t I>
+ColumnView<typename SoA<Columns...>::template column_type<I>> SoA<Columns...>::
+view() {
+    return ColumnView<column_type<I>>(column<I>(), _size);
+}
+
+/**
+ *
+ */
+template <class... Columns>
+template <size_t... Is>
+void SoA<Columns...>::
+_assign(const size_t n, detail::IndexSequence<Is...>,
+        const Columns&... values) {
+    int expand[] = {(column<Is>()[n] = values, 0)...};
+    (void) expand;
+}
+
+/**
+ * Compute column offsets for a capacity of ``n`` rows.
+ */
+template <class... Columns>
+void SoA<Columns...>::
+_layout(const size_t n, size_t* offsets) const {
+    size_t offset = 0;
+    for (size_t i = 0; i < column_count; ++i) {
+        offsets[i] = offset;
+        offset += n * _sizes[i];
+        offset = (offset + SOA_ALIGNMENT - 1) / SOA_ALIGNMENT * SOA_ALIGNMENT;
+    }
+}
+
+/**
+ *
+ */
+template <class... Columns>
+void SoA<Columns...>::
+_copy_row(const size_t from, const size_t to) {
+    for (size_t i = 0; i < column_count; ++i) {
+        std::memcpy(_base + _offsets[i] + to * _sizes[i],
+                    _base + _offsets[i] + from * _sizes[i], _sizes[i]);
+    }
+}
+
+/**
+ *
+ */
+template <class... Columns>
+void SoA<Columns...>::
+_grow(const size_t min_capacity) {
+    size_t n = _capacity ? _capacity * 2 : 16;
+    while (n < min_capacity) {
+        n *= 2;
+    }
+    reserve(n);
+}
+
+/**
+ *
+ */
+template <class... Columns>
+void SoA<Columns...>::
+_release() {
+    ::operator delete(_raw);
+    _raw = nullptr;
+    _base = nullptr;
+    _size = 0;
+    _capacity = 0;
+}
+
+
+}  // namespace tools
+}  // namespace foolysh
+
+#endif
@@ -0,0 +1,538 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Glyph storage and text layout, see text.hpp.
+ */
+
+#include "text.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace foolysh {
+namespace tools {
+namespace text {
+
+namespace {
+
+const double EDT_INF = 1e20;
+
+/**
+ * Squared euclidean distance transform of a 1D sampled function (Felzenszwalb
+ * and Huttenlocher). ``v`` and ``z`` are scratch buffers of ``n`` and
+ * ``n + 1`` elements.
+ */
+void
+edt_1d(const double* f, double* d, int* v, double* z, const int n) {
+    int k = 0;
+    v[0] = 0;
+    z[0] = -EDT_INF;
+    z[1] = EDT_INF;
+    for (int q = 1; q < n; ++q) {
+        double s;
+        do {
+            const int p = v[k];
+            s = ((f[q] + q * q) - (f[p] + p * p)) / (2.0 * q - 2.0 * p);
+        } while (s <= z[k] && k-- > 0);
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = EDT_INF;
+    }
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        while (z[k + 1] < q) {
+            ++k;
+        }
+        const double dq = q - v[k];
+        d[q] = dq * dq + f[v[k]];
+    }
+}
+
+/**
+ * In place 2D squared distance transform of ``grid`` (0 at features,
+ * ``EDT_INF`` elsewhere).
+ */
+void
+edt_2d(std::vector<double>& grid, const int w, const int h) {
+    const int n = std::max(w, h);
+    std::vector<double> f(n), d(n), z(n + 1);
+    std::vector<int> v(n);
+    for (int x = 0; x < w; ++x) {
+        for (int y = 0; y < h; ++y) {
+            f[y] = grid[y * w + x];
+        }
+        edt_1d(f.data(), d.data(), v.data(), z.data(), h);
+        for (int y = 0; y < h; ++y) {
+            grid[y * w + x] = d[y];
+        }
+    }
+    for (int y = 0; y < h; ++y) {
+        edt_1d(&grid[y * w], d.data(), v.data(), z.data(), w);
+        std::copy(d.begin(), d.begin() + w, grid.begin() + y * w);
+    }
+}
+
+struct Line {
+    size_t begin, end;
+    double width;
+};
+
+/**
+ * Split ``text`` into lines at '\n' and, with ``max_width > 0``, after the
+ * last space before a line exceeds ``max_width``. Words wider than
+ * ``max_width`` are broken between code points. ``advances`` holds the
+ * advance of every code point of ``text``.
+ */
+std::vector<Line>
+break_lines(const std::vector<uint32_t>& text,
+            const std::vector<double>& advances, const double max_width) {
+    const size_t none = text.size();
+    std::vector<Line> lines;
+    Line line = {0, 0, 0.0};
+    size_t brk = none;
+    double brk_width = 0.0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\n') {
+            line.end = i;
+            lines.push_back(line);
+            line = {i + 1, i + 1, 0.0};
+            brk = none;
+            continue;
+        }
+        if (max_width > 0.0 && text[i] != ' ' && i > line.begin
+            && line.width + advances[i] > max_width) {
+            if (brk != none) {
+                lines.push_back({line.begin, brk, brk_width});
+                line = {brk + 1, brk + 1, 0.0};
+                for (size_t j = brk + 1; j < i; ++j) {
+                    line.width += advances[j];
+                }
+            }
+            else {
+                line.end = i;
+                lines.push_back(line);
+                line = {i, i, 0.0};
+            }
+            brk = none;
+        }
+        if (text[i] == ' ' && i > line.begin) {
+            brk = i;
+            brk_width = line.width;
+        }
+        line.width += advances[i];
+    }
+    line.end = text.size();
+    lines.push_back(line);
+    return lines;
+}
+
+/**
+ * Break and align ``text``. ``emit(i, x, y, quads)`` adds the quad of code
+ * point ``i`` with its pen at ``x`` on the top line ``y``.
+ */
+template <class Emit>
+TextLayout
+lay_out(const std::vector<uint32_t>& text, const std::vector<double>& advances,
+        const double line_height, const double spacing, const Align align,
+        const double max_width, Emit emit) {
+    const std::vector<Line> lines = break_lines(text, advances, max_width);
+    TextLayout result;
+    result.width = 0.0;
+    for (size_t l = 0; l < lines.size(); ++l) {
+        result.width = std::max(result.width, lines[l].width);
+    }
+    result.height = lines.size() * (line_height + spacing) - spacing;
+    for (size_t l = 0; l < lines.size(); ++l) {
+        double pen = 0.0;
+        if (align == CENTER) {
+            pen = (result.width - lines[l].width) * 0.5;
+        }
+        else if (align == RIGHT) {
+            pen = result.width - lines[l].width;
+        }
+        const double y = l * (line_height + spacing);
+        for (size_t i = lines[l].begin; i < lines[l].end; ++i) {
+            emit(i, pen, y, result.quads);
+            pen += advances[i];
+        }
+    }
+    return result;
+}
+
+/**
+ * Unique code points of ``text`` without an entry in ``glyphs``, in order of
+ * appearance.
+ */
+template <class Map>
+std::vector<uint32_t>
+missing_glyphs(const Map& glyphs, const std::vector<uint32_t>& text) {
+    std::vector<uint32_t> result;
+    for (size_t i = 0; i < text.size(); ++i) {
+        const uint32_t c = text[i];
+        if (c == '\n' || glyphs.find(c) != glyphs.end()
+            || std::find(result.begin(), result.end(), c) != result.end()) {
+            continue;
+        }
+        result.push_back(c);
+    }
+    return result;
+}
+
+/**
+ * Write ``coverage`` (0..1) as straight alpha ``color`` into ``out``.
+ */
+void
+compose(const std::vector<float>& coverage, Span<uint8_t> out,
+        const sdf::Rgba& color) {
+    for (size_t i = 0; i < coverage.size(); ++i) {
+        uint8_t* p = out.data + i * 4;
+        p[0] = color.r;
+        p[1] = color.g;
+        p[2] = color.b;
+        p[3] = static_cast<uint8_t>(coverage[i] * color.a + 0.5f);
+    }
+}
+
+void
+check_output(Span<uint8_t> out, const int width, const int height) {
+    if (width < 0 || height < 0
+        || out.size() != static_cast<size_t>(width) * height * 4) {
+        throw std::invalid_argument("Output size does not match image size.");
+    }
+}
+
+}  // namespace
+
+/**
+ * ``size`` is the reference pixel size glyphs are rasterized at, ``spread``
+ * the distance in pixels covered by the field on either side of the edge.
+ */
+SdfFont::
+SdfFont(const int size, const int spread, const int atlas_size)
+    : _packer(atlas_size, atlas_size), _size(size), _spread(spread),
+      _atlas_size(atlas_size), _atlas_height(atlas_size), _ascent(size),
+      _descent(0) {
+    if (size <= 0 || spread <= 0 || atlas_size <= 0) {
+        throw std::invalid_argument("Expected positive size, spread and "
+                                    "atlas_size.");
+    }
+    _atlas.assign(static_cast<size_t>(atlas_size) * atlas_size, 0);
+}
+
+/**
+ * Set ascent and descent of the font at the reference size.
+ */
+void SdfFont::
+set_metrics(const int ascent, const int descent) {
+    _ascent = ascent;
+    _descent = descent;
+}
+
+/**
+ * Add a glyph from its coverage ``mask`` (``m.w * m.h`` bytes, rasterized at
+ * the reference size). Replaces the metrics of an existing glyph, the atlas
+ * space of the old one is not reclaimed. The atlas height is doubled until
+ * the glyph fits, a glyph wider than the atlas is rejected.
+ */
+void SdfFont::
+add_glyph(const uint32_t codepoint, const GlyphMetrics& m,
+          Span<const uint8_t> mask) {
+    if (m.w < 0 || m.h < 0
+        || mask.size() != static_cast<size_t>(m.w) * m.h) {
+        throw std::invalid_argument("Mask size does not match glyph size.");
+    }
+    Glyph g;
+    g.metrics = m;
+    g.rect = {0, 0, 0, 0};
+    if (m.w == 0 || m.h == 0) {
+        _glyphs[codepoint] = g;
+        return;
+    }
+    const int w = m.w + 2 * _spread, h = m.h + 2 * _spread;
+    if (w > _atlas_size) {
+        throw std::invalid_argument("Glyph is wider than the SdfFont atlas.");
+    }
+    while (!_packer.insert(w, h, g.rect)) {
+        _atlas_height *= 2;
+        _packer.grow(_atlas_height);
+        _atlas.resize(static_cast<size_t>(_atlas_size) * _atlas_height, 0);
+    }
+    std::vector<double> to_inside(static_cast<size_t>(w) * h, EDT_INF);
+    std::vector<double> to_outside(static_cast<size_t>(w) * h, 0.0);
+    for (int y = 0; y < m.h; ++y) {
+        for (int x = 0; x < m.w; ++x) {
+            if (mask[y * m.w + x] >= 128) {
+                const size_t i = (y + _spread) * w + x + _spread;
+                to_inside[i] = 0.0;
+                to_outside[i] = EDT_INF;
+            }
+        }
+    }
+    edt_2d(to_inside, w, h);
+    edt_2d(to_outside, w, h);
+    const double scale = 127.5 / _spread;
+    for (int y = 0; y < h; ++y) {
+        uint8_t* row = &_atlas[(g.rect.y + y) * _atlas_size + g.rect.x];
+        for (int x = 0; x < w; ++x) {
+            const size_t i = y * w + x;
+            // Positive inside, measured from the pixel edge
+            const double d = to_outside[i] > 0.0
+                ? std::sqrt(to_outside[i]) - 0.5
+                : 0.5 - std::sqrt(to_inside[i]);
+            row[x] = static_cast<uint8_t>(
+                std::min(std::max(127.5 + d * scale, 0.0), 255.0));
+        }
+    }
+    _glyphs[codepoint] = g;
+}
+
+/**
+ *
+ */
+bool SdfFont::
+has_glyph(const uint32_t codepoint) const {
+    return _glyphs.find(codepoint) != _glyphs.end();
+}
+
+/**
+ * Unique code points of ``text`` without a glyph, in order of appearance.
+ */
+std::vector<uint32_t> SdfFont::
+missing(const std::vector<uint32_t>& text) const {
+    return missing_glyphs(_glyphs, text);
+}
+
+/**
+ * Lay out ``text`` at ``size`` pixels with ``spacing`` pixels between lines,
+ * wrapped at ``max_width`` pixels if positive. Lines are aligned within the
+ * widest line. Code points without a glyph are skipped.
+ */
+TextLayout SdfFont::
+layout(const std::vector<uint32_t>& text, const double size,
+       const double spacing, const Align align, const double max_width) const {
+    const double scale = size / _size;
+    std::vector<double> advances(text.size(), 0.0);
+    for (size_t i = 0; i < text.size(); ++i) {
+        auto it = _glyphs.find(text[i]);
+        if (it != _glyphs.end()) {
+            advances[i] = it->second.metrics.advance * scale;
+        }
+    }
+    return lay_out(
+        text, advances, (_ascent + _descent) * scale, spacing, align,
+        max_width,
+        [&](const size_t i, const double x, const double y,
+            std::vector<GlyphQuad>& quads) {
+            auto it = _glyphs.find(text[i]);
+            if (it == _glyphs.end() || it->second.rect.w == 0) {
+                return;
+            }
+            const Glyph& g = it->second;
+            GlyphQuad q;
+            q.x = x + (g.metrics.x - _spread) * scale;
+            q.y = y + (g.metrics.y - _spread) * scale;
+            q.w = g.rect.w * scale;
+            q.h = g.rect.h * scale;
+            q.src = g.rect;
+            q.codepoint = text[i];
+            quads.push_back(q);
+        });
+}
+
+/**
+ * Render ``layout`` into ``out`` (``width * height * 4`` bytes, straight
+ * alpha). Coverage is reconstructed from the distance field with a one pixel
+ * wide edge at the target size.
+ */
+void SdfFont::
+render(const TextLayout& layout, Span<uint8_t> out, const int width,
+       const int height, const sdf::Rgba& color) const {
+    check_output(out, width, height);
+    std::vector<float> coverage(static_cast<size_t>(width) * height, 0.0f);
+    for (size_t i = 0; i < layout.quads.size(); ++i) {
+        const GlyphQuad& q = layout.quads[i];
+        const double s = q.w / q.src.w;
+        const float d_scale = static_cast<float>(_spread * s / 127.5);
+        const int x0 = std::max(0, static_cast<int>(std::floor(q.x)));
+        const int y0 = std::max(0, static_cast<int>(std::floor(q.y)));
+        const int x1 = std::min(width, static_cast<int>(std::ceil(q.x + q.w)));
+        const int y1 = std::min(height,
+                                static_cast<int>(std::ceil(q.y + q.h)));
+        for (int y = y0; y < y1; ++y) {
+            const float v = static_cast<float>((y + 0.5 - q.y) / s);
+            float* row = &coverage[static_cast<size_t>(y) * width];
+            for (int x = x0; x < x1; ++x) {
+                const float u = static_cast<float>((x + 0.5 - q.x) / s);
+                const float d = (_sample(q.src, u, v) - 127.5f) * d_scale;
+                const float c = std::min(std::max(0.5f + d, 0.0f), 1.0f);
+                row[x] = std::max(row[x], c);
+            }
+        }
+    }
+    compose(coverage, out, color);
+}
+
+/**
+ * Bilinear sample of the atlas at ``u``/``v`` pixels within ``r``.
+ */
+float SdfFont::
+_sample(const AtlasRect& r, float u, float v) const {
+    u = std::min(std::max(u - 0.5f, 0.0f), static_cast<float>(r.w - 1));
+    v = std::min(std::max(v - 0.5f, 0.0f), static_cast<float>(r.h - 1));
+    const int x = std::min(static_cast<int>(u), r.w - 2 < 0 ? 0 : r.w - 2);
+    const int y = std::min(static_cast<int>(v), r.h - 2 < 0 ? 0 : r.h - 2);
+    const float fx = u - x, fy = v - y;
+    const int x_1 = std::min(x + 1, r.w - 1), y_1 = std::min(y + 1, r.h - 1);
+    const uint8_t* row0 = &_atlas[(r.y + y) * _atlas_size + r.x];
+    const uint8_t* row1 = &_atlas[(r.y + y_1) * _atlas_size + r.x];
+    const float top = row0[x] + (row0[x_1] - row0[x]) * fx;
+    const float bottom = row1[x] + (row1[x_1] - row1[x]) * fx;
+    return top + (bottom - top) * fy;
+}
+
+/**
+ * ``size`` is the pixel size the glyphs are rasterized at.
+ */
+GlyphCache::
+GlyphCache(const int size)
+    : _size(size), _ascent(size), _descent(0), _bytes(0) {
+    if (size <= 0) {
+        throw std::invalid_argument("Expected positive size.");
+    }
+}
+
+/**
+ * Set ascent and descent of the font.
+ */
+void GlyphCache::
+set_metrics(const int ascent, const int descent) {
+    _ascent = ascent;
+    _descent = descent;
+}
+
+/**
+ * Add a glyph from its coverage ``mask`` (``m.w * m.h`` bytes). Replaces an
+ * existing glyph.
+ */
+void GlyphCache::
+add_glyph(const uint32_t codepoint, const GlyphMetrics& m,
+          Span<const uint8_t> mask) {
+    if (m.w < 0 || m.h < 0
+        || mask.size() != static_cast<size_t>(m.w) * m.h) {
+        throw std::invalid_argument("Mask size does not match glyph size.");
+    }
+    Glyph& g = _glyphs[codepoint];
+    _bytes -= g.mask.size();
+    g.metrics = m;
+    g.mask.assign(mask.data, mask.data + mask.size());
+    _bytes += g.mask.size();
+}
+
+/**
+ *
+ */
+bool GlyphCache::
+has_glyph(const uint32_t codepoint) const {
+    return _glyphs.find(codepoint) != _glyphs.end();
+}
+
+/**
+ * Unique code points of ``text`` without a glyph, in order of appearance.
+ */
+std::vector<uint32_t> GlyphCache::
+missing(const std::vector<uint32_t>& text) const {
+    return missing_glyphs(_glyphs, text);
+}
+
+/**
+ * Lay out ``text`` with ``spacing`` pixels between lines, wrapped at
+ * ``max_width`` pixels if positive. Glyphs are placed on whole pixels, code
+ * points without a glyph are skipped.
+ */
+TextLayout GlyphCache::
+layout(const std::vector<uint32_t>& text, const double spacing,
+       const Align align, const double max_width) const {
+    std::vector<double> advances(text.size(), 0.0);
+    for (size_t i = 0; i < text.size(); ++i) {
+        auto it = _glyphs.find(text[i]);
+        if (it != _glyphs.end()) {
+            advances[i] = it->second.metrics.advance;
+        }
+    }
+    return lay_out(
+        text, advances, _ascent + _descent, spacing, align, max_width,
+        [&](const size_t i, const double x, const double y,
+            std::vector<GlyphQuad>& quads) {
+            auto it = _glyphs.find(text[i]);
+            if (it == _glyphs.end() || it->second.mask.empty()) {
+                return;
+            }
+            const GlyphMetrics& m = it->second.metrics;
+            GlyphQuad q;
+            q.x = std::floor(x + m.x + 0.5);
+            q.y = std::floor(y + m.y + 0.5);
+            q.w = m.w;
+            q.h = m.h;
+            q.src = {0, 0, m.w, m.h};
+            q.codepoint = text[i];
+            quads.push_back(q);
+        });
+}
+
+/**
+ * Render ``layout`` into ``out`` (``width * height * 4`` bytes, straight
+ * alpha) by copying the cached glyph masks.
+ */
+void GlyphCache::
+render(const TextLayout& layout, Span<uint8_t> out, const int width,
+       const int height, const sdf::Rgba& color) const {
+    check_output(out, width, height);
+    std::vector<float> coverage(static_cast<size_t>(width) * height, 0.0f);
+    for (size_t i = 0; i < layout.quads.size(); ++i) {
+        const GlyphQuad& q = layout.quads[i];
+        auto it = _glyphs.find(q.codepoint);
+        if (it == _glyphs.end()) {
+            continue;
+        }
+        const Glyph& g = it->second;
+        const int qx = static_cast<int>(q.x), qy = static_cast<int>(q.y);
+        const int x0 = std::max(0, qx), y0 = std::max(0, qy);
+        const int x1 = std::min(width, qx + g.metrics.w);
+        const int y1 = std::min(height, qy + g.metrics.h);
+        for (int y = y0; y < y1; ++y) {
+            const uint8_t* src = g.mask.data()
+                + static_cast<size_t>(y - qy) * g.metrics.w;
+            float* row = &coverage[static_cast<size_t>(y) * width];
+            for (int x = x0; x < x1; ++x) {
+                row[x] = std::max(row[x], src[x - qx] / 255.0f);
+            }
+        }
+    }
+    compose(coverage, out, color);
+}
+
+}  // namespace text
+}  // namespace tools
+}  // namespace foolysh
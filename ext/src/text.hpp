@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ * Font glyph storage and text layout.
+ *
+ * ``SdfFont`` keeps signed distance fields of glyphs, rasterized once at a
+ * reference size, packed in a single channel atlas that doubles its height
+ * whenever it runs out of space. Text of any size is laid
+ * out as one quad per glyph and rendered on the CPU by sampling the distance
+ * field, so scaling text never requires the font to be rasterized again.
+ * ``GlyphCache`` keeps plain coverage bitmaps of glyphs for one font size and
+ * composes text from those, so only glyphs that were never seen before need
+ * to be rasterized when a string changes.
+ *
+ * Both share line breaking (at '\n' and optionally at spaces to fit a maximum
+ * width) and alignment. Glyph masks and metrics are provided by the caller
+ * (e.g. from Pillow), this does not depend on a font library.
+ *
+ * Glyph offsets are relative to the pen position on the top (ascender) line.
+ */
+
+#ifndef TEXT_HPP
+#define TEXT_HPP
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "atlas.hpp"
+#include "sdf.hpp"
+#include "soa.hpp"
+
+namespace foolysh {
+namespace tools {
+namespace text {
+
+    template <class T>
+    using Span = ColumnView<T>;
+
+    enum Align {
+        LEFT,
+        CENTER,
+        RIGHT
+    };
+
+    struct GlyphMetrics {
+        double advance;
+        int x, y, w, h;
+    };
+
+    struct GlyphQuad {
+        double x, y, w, h;
+        AtlasRect src;
+        uint32_t codepoint;
+    };
+
+    struct TextLayout {
+        std::vector<GlyphQuad> quads;
+        double width, height;
+    };
+
+    class SdfFont {
+    public:
+        SdfFont(const int size, const int spread = 8,
+                const int atlas_size = 1024);
+
+        void set_metrics(const int ascent, const int descent);
+        void add_glyph(const uint32_t codepoint, const GlyphMetrics& m,
+                       Span<const uint8_t> mask);
+        bool has_glyph(const uint32_t codepoint) const;
+        std::vector<uint32_t> missing(
+            const std::vector<uint32_t>& text) const;
+
+        TextLayout layout(const std::vector<uint32_t>& text, const double size,
+                          const double spacing, const Align align,
+                          const double max_width) const;
+        void render(const TextLayout& layout, Span<uint8_t> out,
+                    const int width, const int height,
+                    const sdf::Rgba& color) const;
+
+        int size() const { return _size; }
+        int spread() const { return _spread; }
+        int atlas_size() const { return _atlas_size; }
+        int atlas_height() const { return _atlas_height; }
+        const std::vector<uint8_t>& atlas() const { return _atlas; }
+        size_t glyph_count() const { return _glyphs.size(); }
+
+    private:
+        struct Glyph {
+            GlyphMetrics metrics;
+            AtlasRect rect;
+        };
+
+        float _sample(const AtlasRect& r, float u, float v) const;
+
+        std::unordered_map<uint32_t, Glyph> _glyphs;
+        std::vector<uint8_t> _atlas;
+        SkylinePacker _packer;
+        int _size, _spread, _atlas_size, _atlas_height;
+        int _ascent, _descent;
+    };
+
+    class GlyphCache {
+    public:
+        GlyphCache(const int size);
+
+        void set_metrics(const int ascent, const int descent);
+        void add_glyph(const uint32_t codepoint, const GlyphMetrics& m,
+                       Span<const uint8_t> mask);
+        bool has_glyph(const uint32_t codepoint) const;
+        std::vector<uint32_t> missing(
+            const std::vector<uint32_t>& text) const;
+
+        TextLayout layout(const std::vector<uint32_t>& text,
+                          const double spacing, const Align align,
+                          const double max_width) const;
+        void render(const TextLayout& layout, Span<uint8_t> out,
+                    const int width, const int height,
+                    const sdf::Rgba& color) const;
+
+        int size() const { return _size; }
+        size_t glyph_count() const { return _glyphs.size(); }
+        size_t bytes() const { return _bytes; }
+
+    private:
+        struct Glyph {
+            GlyphMetrics metrics;
+            std::vector<uint8_t> mask;
+        };
+
+        std::unordered_map<uint32_t, Glyph> _glyphs;
+        int _size, _ascent, _descent;
+        size_t _bytes;
+    };
+
+}  // namespace text
+}  // namespace tools
+}  // namespace foolysh
+
+#endif
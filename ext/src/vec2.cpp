@@ -26,7 +26,6 @@
 
 #include "vec2.hpp"
 
-#include <iostream>
 #include <cmath>
 #include <stdexcept>
 
@@ -35,66 +34,6 @@
 namespace foolysh {
 namespace tools {
 
-/**
- * Default c-tor, initialize vector to x = y = 0.0
- */
-Vec2::
-Vec2() {
-    _x = _y = _magnitude = _length = 0.0;
-    _state = 0;
-}
-
-/**
- * Initialize vector to x = y = v
- */
-Vec2::
-Vec2(const double v) {
-    _x = _y = v;
-    _magnitude = _length = 0.0;
-    _state = 0;
-}
-
-/**
- * Initialize with x and y
- */
-Vec2::
-Vec2(const double x, const double y) {
-    _x = x;
-    _y = y;
-    _magnitude = _length = 0.0;
-    _state = 0;
-}
-
-/**
- * Copy c-tor
- */
-Vec2::
-Vec2(const Vec2& other) : _x(other._x), _y(other._y),
-                                _magnitude(other._magnitude),
-                                _length(other._length), _state(other._state) {
-}
-
-/**
- * Assignment c-tor
- */
-Vec2& Vec2::
-operator=(const Vec2& other) {
-    _x = other._x;
-    _y = other._y;
-    _magnitude = other._magnitude;
-    _length = other._length;
-    _state = other._state;
-    return *this;
-}
-
-/**
- * Dot product
- */
-double Vec2::
-dot(const Vec2& other) {
-    return _x * other._x + _y * other._y;
-}
-
 /**
  * Return true if length > 0 otherwise false
  */
@@ -118,7 +57,6 @@ Vec2 Vec2::
 normalized() {
     Vec2 v = Vec2(*this);
     if (v.normalize()) {
-        std::cout << "OK" << std::endl;
         return v;
     }
     throw std::underflow_error("Cannot normalize Vec2 of zero length.");
@@ -172,7 +110,7 @@ rotate(double a, bool radians) {
  * false (=degrees).
  */
 Vec2 Vec2::
-rotated(double a, bool radians) {
+rotated(double a, bool radians) const {
     if (!radians) {
         a *= -to_rad;
     }
@@ -184,7 +122,7 @@ rotated(double a, bool radians) {
  * Return true if almost equal. Use ``d`` for allowed delta.
  */
 bool Vec2::
-almost_equal(Vec2& other, const double d) {
+almost_equal(const Vec2& other, const double d) const {
     return (std::fabs(_x - other._x) + std::fabs(_y - other._y) <= d) ? true : false;
 }
 
@@ -200,146 +138,11 @@ operator[](const int idx) {
     throw std::range_error("Index out of range");
 }
 
-/**
- * this + Vec2
- */
-Vec2 Vec2::
-operator+(const Vec2& rhs) {
-    return Vec2(_x + rhs._x, _y + rhs._y);
-}
-
-/**
- * this + double
- */
-Vec2 Vec2::
-operator+(const double rhs) {
-    return Vec2(_x + rhs, _y + rhs);
-}
-
-/**
- * this += Vec2
- */
-Vec2& Vec2::
-operator+=(const Vec2& rhs) {
-    _state = 0;
-    _x += rhs._x;
-    _y += rhs._y;
-    return *this;
-}
-
-/**
- * this += double
- */
-Vec2& Vec2::
-operator+=(const double rhs) {
-    _state = 0;
-    _x += rhs;
-    _y += rhs;
-    return *this;
-}
-
-/**
- * this += Vec2
- */
-void Vec2::
-iadd(const Vec2& rhs) {
-    *this += rhs;
-}
-
-/**
- * this += double
- */
-void Vec2::
-iadd(const double rhs) {
-    *this += rhs;
-}
-
-/**
- * this - Vec2
- */
-Vec2 Vec2::
-operator-(const Vec2& rhs) {
-    return Vec2(_x - rhs._x, _y - rhs._y);
-}
-
-/**
- * this - double
- */
-Vec2 Vec2::
-operator-(const double rhs) {
-    return Vec2(_x - rhs, _y - rhs);
-}
-
-/**
- * this -= Vec2
- */
-Vec2& Vec2::
-operator-=(const Vec2& rhs) {
-    _state = 0;
-    _x -= rhs._x;
-    _y -= rhs._y;
-    return *this;
-}
-
-/**
- * this -= double
- */
-Vec2& Vec2::
-operator-=(const double rhs) {
-    _state = 0;
-    _x -= rhs;
-    _y -= rhs;
-    return *this;
-}
-
-/**
- * this -= Vec2
- */
-void Vec2::
-isub(const Vec2& rhs) {
-    *this -= rhs;
-}
-
-/**
- * this -= double
- */
-void Vec2::
-isub(const double rhs) {
-    *this -= rhs;
-}
-
-/**
- * this * double
- */
-Vec2 Vec2::
-operator*(const double rhs) {
-    return Vec2(_x * rhs, _y * rhs);
-}
-
-/**
- * this *= double
- */
-Vec2& Vec2::
-operator*=(const double rhs) {
-    _state = 0;
-    _x *= rhs;
-    _y *= rhs;
-    return *this;
-}
-
-/**
- * this *= double
- */
-void Vec2::
-imul(const double rhs) {
-    *this *= rhs;
-}
-
 /**
  * this / double
  */
 Vec2 Vec2::
-operator/(const double rhs) {
+operator/(const double rhs) const {
     if (rhs) {
         return Vec2(_x / rhs, _y / rhs);
     }
@@ -350,7 +153,7 @@ operator/(const double rhs) {
  * Ugly hack because cython cannot handle "operator/" atm.
  */
 Vec2 Vec2::
-div(const double rhs) {
+div(const double rhs) const {
     return *this / rhs;
 }
 
@@ -360,9 +163,7 @@ div(const double rhs) {
 Vec2& Vec2::
 operator/=(const double rhs) {
     if (rhs) {
-        _state = 0;
-        _x /= rhs;
-        _y /= rhs;
+        set(_x / rhs, _y / rhs);
         return *this;
     }
     throw std::underflow_error("Division by zero.");
@@ -376,38 +177,6 @@ idiv(const double rhs) {
     *this /= rhs;
 }
 
-/**
- *
- */
-bool Vec2::
-operator==(const Vec2& rhs) {
-    return (_x == rhs._x && _y == rhs._y);
-}
-
-/**
- *
- */
-bool Vec2::
-operator!=(const Vec2& rhs) {
-    return !(*this == rhs);
-}
-
-/**
- *
- */
-bool Vec2::
-operator==(const double rhs) {
-    return (_x == rhs && _y == rhs);
-}
-
-/**
- *
- */
-bool Vec2::
-operator!=(const double rhs) {
-    return !(*this == rhs);
-}
-
 
 }  // namespace tools
 }  // namespace foolysh
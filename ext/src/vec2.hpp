@@ -21,54 +21,115 @@
  *
  *
  * Basic 2D Vector implementation.
+ *
+ * Trivial arithmetic is defined inline (constexpr/noexcept where C++11
+ * allows) so it can be used in hot loops without a call per operation. Methods
+ * that validate their input and may throw (``operator[]``, division,
+ * ``normalized()``) are defined in vec2.cpp and meant for the Python API;
+ * native code should use the unchecked ``x()``/``y()`` accessors instead.
+ *
+ * Vec2 caches magnitude and length for the Python API. Native internals
+ * should prefer the plain ``Vec2d`` (vec2t.hpp), Vec2 converts implicitly.
  */
 
 #ifndef VEC2_HPP
 #define VEC2_HPP
 
+#include "vec2t.hpp"
+
 namespace foolysh {
 namespace tools {
     class Vec2 {
     public:
-        Vec2();
-        Vec2(const double v);
-        Vec2(const double x, const double y);
-        Vec2(const Vec2& other);
-        Vec2& operator=(const Vec2& other);
+        constexpr Vec2() noexcept
+            : _x(0.0), _y(0.0), _magnitude(0.0), _length(0.0), _state(0) {}
+        constexpr Vec2(const double v) noexcept
+            : _x(v), _y(v), _magnitude(0.0), _length(0.0), _state(0) {}
+        constexpr Vec2(const double x, const double y) noexcept
+            : _x(x), _y(y), _magnitude(0.0), _length(0.0), _state(0) {}
+        constexpr Vec2(const Vec2d& v) noexcept
+            : _x(v.x), _y(v.y), _magnitude(0.0), _length(0.0), _state(0) {}
+        Vec2(const Vec2& other) = default;
+        Vec2& operator=(const Vec2& other) = default;
+
+        // Unchecked access
+        constexpr double x() const noexcept { return _x; }
+        constexpr double y() const noexcept { return _y; }
+        constexpr operator Vec2d() const noexcept { return Vec2d{_x, _y}; }
+        void set(const double x, const double y) noexcept {
+            _x = x;
+            _y = y;
+            _state = 0;
+        }
 
-        double dot(const Vec2& other);
+        constexpr double dot(const Vec2& other) const noexcept {
+            return _x * other._x + _y * other._y;
+        }
         bool normalize();
         Vec2 normalized();
         double magnitude();
         double length();
         void rotate(double a, bool radians = false);
-        Vec2 rotated(double a, bool radians = false);
-        bool almost_equal(Vec2& other, const double d = 1e-6);
+        Vec2 rotated(double a, bool radians = false) const;
+        bool almost_equal(const Vec2& other, const double d = 1e-6) const;
 
         double& operator[](const int idx);
-        Vec2 operator+(const Vec2& rhs);
-        Vec2 operator+(const double rhs);
-        Vec2& operator+=(const Vec2& rhs);
-        Vec2& operator+=(const double rhs);
-        void iadd(const Vec2& rhs);
-        void iadd(const double rhs);
-        Vec2 operator-(const Vec2& rhs);
-        Vec2 operator-(const double rhs);
-        Vec2& operator-=(const Vec2& rhs);
-        Vec2& operator-=(const double rhs);
-        void isub(const Vec2& rhs);
-        void isub(const double rhs);
-        Vec2 operator*(const double rhs);
-        Vec2& operator*=(const double rhs);
-        void imul(const double rhs);
-        Vec2 operator/(const double rhs);
-        Vec2 div(const double rhs);
+        constexpr Vec2 operator+(const Vec2& rhs) const noexcept {
+            return Vec2(_x + rhs._x, _y + rhs._y);
+        }
+        constexpr Vec2 operator+(const double rhs) const noexcept {
+            return Vec2(_x + rhs, _y + rhs);
+        }
+        Vec2& operator+=(const Vec2& rhs) noexcept {
+            set(_x + rhs._x, _y + rhs._y);
+            return *this;
+        }
+        Vec2& operator+=(const double rhs) noexcept {
+            set(_x + rhs, _y + rhs);
+            return *this;
+        }
+        void iadd(const Vec2& rhs) noexcept { *this += rhs; }
+        void iadd(const double rhs) noexcept { *this += rhs; }
+        constexpr Vec2 operator-(const Vec2& rhs) const noexcept {
+            return Vec2(_x - rhs._x, _y - rhs._y);
+        }
+        constexpr Vec2 operator-(const double rhs) const noexcept {
+            return Vec2(_x - rhs, _y - rhs);
+        }
+        Vec2& operator-=(const Vec2& rhs) noexcept {
+            set(_x - rhs._x, _y - rhs._y);
+            return *this;
+        }
+        Vec2& operator-=(const double rhs) noexcept {
+            set(_x - rhs, _y - rhs);
+            return *this;
+        }
+        void isub(const Vec2& rhs) noexcept { *this -= rhs; }
+        void isub(const double rhs) noexcept { *this -= rhs; }
+        constexpr Vec2 operator*(const double rhs) const noexcept {
+            return Vec2(_x * rhs, _y * rhs);
+        }
+        Vec2& operator*=(const double rhs) noexcept {
+            set(_x * rhs, _y * rhs);
+            return *this;
+        }
+        void imul(const double rhs) noexcept { *this *= rhs; }
+        Vec2 operator/(const double rhs) const;
+        Vec2 div(const double rhs) const;
         Vec2& operator/=(const double rhs);
         void idiv(const double rhs);
-        bool operator==(const Vec2& rhs);
-        bool operator!=(const Vec2& rhs);
-        bool operator==(const double rhs);
-        bool operator!=(const double rhs);
+        constexpr bool operator==(const Vec2& rhs) const noexcept {
+            return _x == rhs._x && _y == rhs._y;
+        }
+        constexpr bool operator!=(const Vec2& rhs) const noexcept {
+            return !(*this == rhs);
+        }
+        constexpr bool operator==(const double rhs) const noexcept {
+            return _x == rhs && _y == rhs;
+        }
+        constexpr bool operator!=(const double rhs) const noexcept {
+            return !(*this == rhs);
+        }
     private:
         double _x, _y, _magnitude, _length;
         unsigned char _state;  // 0 = dirty, 1 = have mag, 2 = have mag + len
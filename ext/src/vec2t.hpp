@@ -0,0 +1,143 @@
+/**
+ * Copyright (c) 2020 Tiziano Bettio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ *
+ * Provides a plain 2D vector for native internals. ``Vec2T`` is an aggregate
+ * of two components without any cached state, so it is trivially copyable,
+ * has no padding and can be stored in SoA/AoS buffers or loaded with SIMD
+ * instructions. ``Vec2d`` and ``Vec2f`` are the double and float variants,
+ * ``Vec2`` (vec2.hpp) converts to and from ``Vec2d``.
+ */
+
+#ifndef VEC2T_HPP
+#define VEC2T_HPP
+
+#include <cmath>
+#include <type_traits>
+
+namespace foolysh {
+namespace tools {
+
+    template <class T>
+    struct Vec2T {
+        T x, y;
+    };
+
+    typedef Vec2T<double> Vec2d;
+    typedef Vec2T<float> Vec2f;
+
+    static_assert(std::is_pod<Vec2d>::value && sizeof(Vec2d) == 16,
+                  "Vec2d must be a 16 byte POD");
+    static_assert(std::is_pod<Vec2f>::value && sizeof(Vec2f) == 8,
+                  "Vec2f must be an 8 byte POD");
+
+    template <class T>
+    constexpr Vec2T<T> operator+(const Vec2T<T>& a,
+                                 const Vec2T<T>& b) noexcept {
+        return Vec2T<T>{a.x + b.x, a.y + b.y};
+    }
+
+    template <class T>
+    constexpr Vec2T<T> operator-(const Vec2T<T>& a,
+                                 const Vec2T<T>& b) noexcept {
+        return Vec2T<T>{a.x - b.x, a.y - b.y};
+    }
+
+    template <class T>
+    constexpr Vec2T<T> operator-(const Vec2T<T>& a) noexcept {
+        return Vec2T<T>{-a.x, -a.y};
+    }
+
+    template <class T>
+    constexpr Vec2T<T> operator*(const Vec2T<T>& a, const T s) noexcept {
+        return Vec2T<T>{a.x * s, a.y * s};
+    }
+
+    template <class T>
+    constexpr Vec2T<T> operator*(const T s, const Vec2T<T>& a) noexcept {
+        return Vec2T<T>{a.x * s, a.y * s};
+    }
+
+    template <class T>
+    constexpr bool operator==(const Vec2T<T>& a, const Vec2T<T>& b) noexcept {
+        return a.x == b.x && a.y == b.y;
+    }
+
+    template <class T>
+    constexpr bool operator!=(const Vec2T<T>& a, const Vec2T<T>& b) noexcept {
+        return !(a == b);
+    }
+
+    template <class T>
+    inline Vec2T<T>& operator+=(Vec2T<T>& a, const Vec2T<T>& b) noexcept {
+        a.x += b.x;
+        a.y += b.y;
+        return a;
+    }
+
+    template <class T>
+    inline Vec2T<T>& operator-=(Vec2T<T>& a, const Vec2T<T>& b) noexcept {
+        a.x -= b.x;
+        a.y -= b.y;
+        return a;
+    }
+
+    template <class T>
+    inline Vec2T<T>& operator*=(Vec2T<T>& a, const T s) noexcept {
+        a.x *= s;
+        a.y *= s;
+        return a;
+    }
+
+    template <class T>
+    constexpr T dot(const Vec2T<T>& a, const Vec2T<T>& b) noexcept {
+        return a.x * b.x + a.y * b.y;
+    }
+
+    template <class T>
+    inline T length(const Vec2T<T>& a) noexcept {
+        return std::sqrt(dot(a, a));
+    }
+
+    /**
+     * Linear interpolation, ``t`` = 0 yields ``a``, ``t`` = 1 yields ``b``.
+     */
+    template <class T>
+    constexpr Vec2T<T> lerp(const Vec2T<T>& a, const Vec2T<T>& b,
+                            const T t) noexcept {
+        return Vec2T<T>{a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t};
+    }
+
+    /**
+     * Rotate ``a`` by the angle whose sine and cosine are given. Lets callers
+     * rotate several vectors by the same angle with a single sin/cos.
+     */
+    template <class T>
+    constexpr Vec2T<T> rotated(const Vec2T<T>& a, const T sa,
+                               const T ca) noexcept {
+        return Vec2T<T>{ca * a.x - sa * a.y, sa * a.x + ca * a.y};
+    }
+
+}  // namespace tools
+}  // namespace foolysh
+
+#endif
@@ -0,0 +1,101 @@
+"""
+Benchmark comparing the per sprite ``SDL_RenderCopyEx`` path with batched
+``SDL_RenderGeometry`` draws of atlas packed sprites, using the software
+renderer.
+
+Usage: ``python main.py [sprites] [frames]``
+"""
+
+import os
+import random
+import sys
+import time
+
+# Must be set before SDL creates the renderer
+os.environ.setdefault('SDL_RENDER_DRIVER', 'software')
+
+# pylint: disable=wrong-import-position
+from foolysh import app
+from foolysh.tools import sdf
+
+__author__ = 'Tiziano Bettio'
+__license__ = 'MIT'
+__version__ = '0.1'
+__copyright__ = """Copyright (c) 2020 Tiziano Bettio
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+exist at the moment
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE."""
+
+COLORS = (200, 40, 10), (40, 200, 10), (10, 40, 200), (200, 200, 10)
+
+
+class BatchingBenchmark(app.App):
+    """
+    Fills the screen with small rotated SDF sprites and times rendering with
+    and without geometry batching.
+    """
+    def __init__(self, sprites, frames):
+        super().__init__(config_file='foolysh.ini')
+        self.frames = frames
+        rng = random.Random(42)
+        screen_x, screen_y = self.screen_size
+        max_y = screen_y / screen_x
+        images = [
+            sdf.framed_box_str(width=0.05, height=0.05, corner_radius=0.01,
+                               border_thickness=0.005, frame_color=color,
+                               border_color=(230, 230, 230), alpha=200)
+            for color in COLORS
+        ]
+        for i in range(sprites):
+            sprite = self.root.attach_image_node(f'Sprite{i}',
+                                                 rng.choice(images))
+            sprite.pos = rng.uniform(0.0, 0.95), rng.uniform(0.0, max_y - 0.05)
+            sprite.angle = rng.uniform(0.0, 360.0)
+            sprite.depth = i
+
+    def measure(self, batch_geometry):
+        """Returns the average time per frame in seconds."""
+        self.renderer.batch_geometry = batch_geometry
+        for _ in range(10):
+            self.renderer.set_dirty()
+            self.renderer.render()
+        start = time.perf_counter()
+        for _ in range(self.frames):
+            self.renderer.set_dirty()
+            self.renderer.render()
+        return (time.perf_counter() - start) / self.frames
+
+
+def main():
+    """Run the benchmark and print the results."""
+    sprites = int(sys.argv[1]) if len(sys.argv) > 1 else 2000
+    frames = int(sys.argv[2]) if len(sys.argv) > 2 else 100
+    bench = BatchingBenchmark(sprites, frames)
+    copy_ex = bench.measure(False)
+    geometry = bench.measure(True)
+    batches = bench.renderer.draw_list.batch_count
+    print(f'{sprites} sprites, {frames} frames')
+    print(f'SDL_RenderCopyEx:   {copy_ex * 1000:8.3f} ms/frame '
+          f'({sprites / copy_ex:12.0f} sprites/s)')
+    print(f'SDL_RenderGeometry: {geometry * 1000:8.3f} ms/frame '
+          f'({sprites / geometry:12.0f} sprites/s, {batches} batches)')
+    bench.quit(blocking=False)
+
+
+if __name__ == '__main__':
+    main()
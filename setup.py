@@ -52,6 +52,8 @@ LIBRARIES = []
 if platform.system() == 'Linux':
     EXTRA_COMPILE_ARGS.append('-std=c++11')
     EXTRA_LINK_ARGS.append('-std=c++11')
+    EXTRA_COMPILE_ARGS.append('-pthread')
+    EXTRA_LINK_ARGS.append('-pthread')
 
 if 'ARCH' in os.environ and os.environ['ARCH'].startswith('arm'):
     EXTRA_COMPILE_ARGS.append('-fexceptions')
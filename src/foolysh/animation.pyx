@@ -1303,6 +1303,16 @@ cdef class AnimationManager:
         deref(__am).animate(dt)
         self.clean_up()
 
+    @property
+    def pool_stats(self):
+        """
+        ``Dict[str, int]`` -> live and allocated slots of the animation data
+        pool (``data_size``, ``data_capacity``) and of the slab holding
+        Interval, Animation and Sequence objects (``object_size``,
+        ``object_capacity``).
+        """
+        return deref(__am).pool_stats()
+
     cdef void clean_up(self):
         cdef char c
         cdef list r = []
@@ -456,6 +456,7 @@ class App(FSM):
                 if self.__stats.frames == 0:
                     self.__loading.hide()
                 self.__systems.renderer.render()
+                scene.SGDH.reset_arena()
                 frame_clock.tick()
                 sleep_time = max(0.0, FRAME_TIME - frame_clock.get_dt())
                 if sleep_time:
@@ -529,7 +530,21 @@ class App(FSM):
         self.__systems.sprite_loader = spriteloader.SpriteLoader(
             self.__systems.factory,
             self.__cfg.get('base', 'asset_dir', fallback='assets/'),
-            self.__cfg.get('base', 'cache_dir', fallback=None)
+            self.__cfg.get('base', 'cache_dir', fallback=None),
+            atlas_size=self.__cfg.getint('base', 'atlas_size', fallback=0),
+            atlas_pages=self.__cfg.getint('base', 'atlas_pages', fallback=4),
+            sdf_text=self.__cfg.getboolean('base', 'sdf_text', fallback=False),
+            texture_budget=self.__cfg.getint('base', 'texture_budget_mb',
+                                             fallback=0) * 1024 * 1024,
+            async_workers=self.__cfg.getint('base', 'async_workers',
+                                            fallback=0),
+            upload_budget=self.__cfg.getint('base', 'upload_budget_kb',
+                                            fallback=4096) * 1024,
+            raw_cache=self.__cfg.getboolean('base', 'raw_cache',
+                                            fallback=False),
+            raw_compress=self.__cfg.getboolean('base', 'raw_cache_lz4',
+                                               fallback=False),
+            archive=self.__cfg.get('base', 'asset_archive', fallback=None)
         )
         scene.SPRITE_LOADER = self.__systems.sprite_loader
         self.__systems.renderer.root_node = self.__nodes.root
@@ -537,6 +552,12 @@ class App(FSM):
         self.__systems.renderer.asset_pixel_ratio = \
             self.__cfg.getint('base', 'asset_pixel_ratio')
         self.__systems.renderer.sprite_loader = self.__systems.sprite_loader
+        self.__systems.renderer.batch_geometry = self.__cfg.getboolean(
+            'base', 'batch_geometry', fallback=False
+        )
+        self.__systems.renderer.partial_redraw = self.__cfg.getboolean(
+            'base', 'partial_redraw', fallback=False
+        )
         self.__systems.ui_handler.set_window(self.__systems.window)
 
     def __del__(self):
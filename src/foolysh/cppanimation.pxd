@@ -47,8 +47,6 @@ cdef extern from "src/animation.hpp" namespace "foolysh::animation":
         void loop(const bool)
 
     cdef cppclass AnimationType(AnimationBase):
-        AnimationType() except +
-
         void set_node(Node)
         void set_blend(BlendType)
 
@@ -111,6 +109,12 @@ cdef extern from "src/animation.hpp" namespace "foolysh::animation":
     cdef cppclass Sequence(AnimationBase):
         pass
 
+    cdef struct PoolStats:
+        int data_size
+        int data_capacity
+        size_t object_size
+        size_t object_capacity
+
     cdef cppclass AnimationManager:
         int new_interval()
         int new_animation()
@@ -139,3 +143,4 @@ cdef extern from "src/animation.hpp" namespace "foolysh::animation":
         void append(const int, const int)
 
         void animate(const double)
+        PoolStats pool_stats()
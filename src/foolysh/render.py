@@ -3,15 +3,19 @@ SDL2 TextureSpriteRenderSystem
 """
 
 from collections import namedtuple
+import ctypes
 from typing import Dict
 from typing import Tuple
 
 import sdl2.ext
+from sdl2 import blendmode
+from sdl2 import pixels
 from sdl2 import rect
 from sdl2 import render
 
 from .tools import common
 from .scene import node
+from .scene import SGDH
 from .tools import aabb
 from .tools import spriteloader
 from .tools import vec2
@@ -62,10 +66,39 @@ class HWRenderer(sdl2.ext.TextureSpriteRenderSystem):
         self._view_aabb = aabb.AABB(0.0, 0.0, 0.0, 0.0)
         self._dirty = True
         self._last_w_size = 0, 0  # window.size
+        self._image_scale = 0.0, 0.0
+        self._atlas_generation = 0
         self._sprites = {}  # type: Dict[int, Sprite]
-        self._texts = {}  # type: Dict[int, str]
-        self._rcopy = render.SDL_RenderCopyEx
-        self._rect = rect.SDL_Rect(0, 0, 0, 0)
+        self._pending = {}  # type: Dict[int, node.ImageNode]
+        self._draw_list = node.DrawList()
+        self._renderer_ptr = ctypes.cast(self.renderer, ctypes.c_void_p).value
+        self._rcopy_ptr = ctypes.cast(render.SDL_RenderCopyEx,
+                                      ctypes.c_void_p).value
+        # SDL_RenderGeometry requires SDL >= 2.0.18
+        geometry = getattr(render, 'SDL_RenderGeometry', None)
+        self._geometry_ptr = 0
+        if geometry is not None:
+            self._geometry_ptr = ctypes.cast(geometry, ctypes.c_void_p).value
+        self._batch_geometry = False
+        self._partial_redraw = False
+        self._target = None
+        self._target_size = 0, 0
+        self._targets_supported = bool(
+            render.SDL_RenderTargetSupported(self.renderer)
+        )
+        self._caches = {}  # type: Dict[int, Tuple[object, Tuple[int, int]]]
+        # Cached bitmaps hold premultiplied color after rendering into them
+        compose = getattr(blendmode, 'SDL_ComposeCustomBlendMode', None)
+        self._cache_blend = blendmode.SDL_BLENDMODE_BLEND
+        if compose is not None:
+            self._cache_blend = compose(
+                blendmode.SDL_BLENDFACTOR_ONE,
+                blendmode.SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                blendmode.SDL_BLENDOPERATION_ADD,
+                blendmode.SDL_BLENDFACTOR_ONE,
+                blendmode.SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                blendmode.SDL_BLENDOPERATION_ADD
+            )
 
     def set_dirty(self):
         self._dirty = True
@@ -80,103 +113,238 @@ class HWRenderer(sdl2.ext.TextureSpriteRenderSystem):
         w = min(self.window_size)
         image_scale = self._base_scale * self._zoom
         image_scale = image_scale, image_scale
+        generation = self.sprite_loader.atlas_generation
+        if resize or image_scale != self._image_scale \
+              or generation != self._atlas_generation:
+            self._draw_list.clear_textures()
+            self._sprites.clear()
+            self._pending.clear()
+            self._clear_caches()
+            self._image_scale = image_scale
+            self._atlas_generation = generation
+        for n_id in node.changed_sprites():
+            self._draw_list.remove_texture(n_id)
+            self._sprites.pop(n_id, None)
+            self._pending.pop(n_id, None)
+            SGDH.invalidate_cache(n_id)
         for nd in unsized:
-            if isinstance(nd, node.TextNode) and not nd.text:
-                continue
             self._load_sprite(nd, image_scale, w)
-        if not self.root_node.traverse() and not self._dirty \
-              and not self.uiroot.traverse():
+        if self._pending and self.sprite_loader.upload_pending():
+            self._load_uploaded(image_scale, w)
+        changed = self.root_node.traverse()
+        changed = self.uiroot.traverse() or changed
+        if not changed and not self._dirty:
             return
         if self._dirty:
             self._update_view_aabb()
 
-        x = int(self._view_pos.x * w * self._zoom)
-        y = int(self._view_pos.y * w * self._zoom)
-        self._renderer.clear()
-        for nd in self.root_node.query(self._view_aabb):
-            if isinstance(nd, node.ImageNode):
-                if nd.tiled and resize:
-                    self._load_sprite(nd, image_scale, w)
-                self._render_image(nd, w, image_scale, x, y)
-            elif isinstance(nd, node.TextNode):
-                self._render_text(nd, w, image_scale, x, y)
+        SGDH.update_render(w, self._zoom, self._view_pos.x, self._view_pos.y)
         ui_aabb = aabb.AABB(*self._view_aabb.size, *self._view_aabb.size)
-        ui_nodes = self.uiroot.query(ui_aabb)
-        for nd in ui_nodes:
+        for nd in self.uiroot.query(ui_aabb):
             if isinstance(nd, uinode.UINode):
                 nd.update()
-        for nd in ui_nodes:
-            if isinstance(nd, node.ImageNode):
-                self._render_image(nd, w, image_scale, x, y)
-            elif isinstance(nd, node.TextNode):
-                self._render_text(nd, w, image_scale, x, y)
+        if self.uiroot.traverse():
+            SGDH.update_render(w, self._zoom, self._view_pos.x,
+                               self._view_pos.y)
+        self._build_draw_list(w, image_scale, ui_aabb)
+        damage = self._draw_list.update_damage()
+        target = self._partial_redraw and self._ensure_target()
+        if target and damage is None and not self._dirty:
+            return
+        clip = None
+        if target:
+            render.SDL_SetRenderTarget(self.renderer, self._target)
+        if target and not self._dirty:
+            clip = damage
+            clip_rect = rect.SDL_Rect(*damage)
+            # SDL_RenderClear ignores the clip rect
+            render.SDL_RenderSetClipRect(self.renderer, clip_rect)
+            render.SDL_RenderFillRect(self.renderer, clip_rect)
+        else:
+            self._renderer.clear()
+        if self._batch_geometry and self._geometry_ptr:
+            ret = self._draw_list.submit_geometry(self._renderer_ptr,
+                                                  self._geometry_ptr, clip)
+        else:
+            ret = self._draw_list.submit(self._renderer_ptr, self._rcopy_ptr,
+                                         clip)
+        if ret != 0:
+            raise sdl2.ext.common.SDLError()
+        if target:
+            render.SDL_RenderSetClipRect(self.renderer, None)
+            render.SDL_SetRenderTarget(self.renderer, None)
+            render.SDL_RenderCopy(self.renderer, self._target, None, None)
         self._dirty = False
         render.SDL_RenderPresent(self.renderer)
-
-    def _render_text(self, nd, w, image_scale, x, y):
-        if not nd.text:
+        if self.sprite_loader.texture_budget > 0:
+            self._trim_sprites()
+
+    def _trim_sprites(self):
+        """
+        Pin the sprites drawn this frame and release the ones the sprite loader
+        evicts to meet its texture budget. Nodes of released sprites are
+        loaded again once they are drawn.
+        """
+        sprites = self._sprites
+        self.sprite_loader.pin([sprites[i].sprite
+                                for i in self._draw_list.node_ids
+                                if i in sprites])
+        evicted = {id(sprite) for sprite in self.sprite_loader.trim()}
+        if not evicted:
             return
-        scale_x, scale_y = nd.relative_scale
-        n_id = nd.node_id
-        if n_id not in self._sprites or n_id not in self._texts \
-              or nd.hashkey != self._texts[n_id] \
-              or self._sprites[n_id].scale != image_scale:
-            self._load_sprite(nd, image_scale)
-            self._texts[n_id] = nd.hashkey
-        sprite = self._sprites[n_id].sprite
-        rel_pos = nd.relative_pos
-        self._rect.x = x + int(w * rel_pos.x * self._zoom + 0.5)
-        self._rect.y = y + int(w * rel_pos.y * self._zoom + 0.5)
-        self._rect.w, self._rect.h = sprite.size
-        rot_center = nd.rotation_center
-        center = rect.SDL_Point(
-            int(rot_center.x * w * scale_x * self._zoom + 0.5),
-            int(rot_center.y * w * scale_y * self._zoom + 0.5)
+        for n_id in [i for i, s in sprites.items() if id(s.sprite) in evicted]:
+            self._draw_list.remove_texture(n_id)
+            del sprites[n_id]
+
+    def _ensure_target(self):
+        """
+        Create the window sized target texture that keeps the last frame for
+        partial redraws, a new target forces a full redraw. Returns ``False``
+        if render targets are not supported.
+        """
+        size = self._window.size
+        if self._target is not None and self._target_size == size:
+            return True
+        if self._target is not None:
+            render.SDL_DestroyTexture(self._target)
+            self._target = None
+        if not render.SDL_RenderTargetSupported(self.renderer):
+            self._partial_redraw = False
+            return False
+        target = render.SDL_CreateTexture(
+            self.renderer, pixels.SDL_PIXELFORMAT_RGBA8888,
+            render.SDL_TEXTUREACCESS_TARGET, size[0], size[1]
         )
-        if self._rcopy(self.renderer, sprite.texture, None, self._rect,
-                       nd.relative_angle, center, sprite.flip) == -1:
+        if not target:
             raise sdl2.ext.common.SDLError()
-
-    def _render_image(self, nd, w, image_scale, x, y):
-        scale_x, scale_y = nd.relative_scale
-        n_id = nd.node_id
-        if n_id not in self._sprites or n_id not in self._texts \
-              or self._sprites[n_id].index != nd.index \
-              or self._sprites[n_id].scale != image_scale \
-              or self._sprites[n_id].name != nd.image:
+        self._target = target
+        self._target_size = size
+        self._dirty = True
+        return True
+
+    def _build_draw_list(self, w, image_scale, ui_aabb):
+        """
+        Build the draw commands for the visible scene and ui nodes. Nodes
+        without a registered texture are loaded and the list is rebuilt, as
+        loading changes the node size. Stale caches are rendered and the list
+        is rebuilt to draw them from their bitmap.
+        """
+        while True:
+            self._draw_list.clear()
+            self._draw_list.build(self.root_node, self._view_aabb)
+            self._draw_list.build(self.uiroot, ui_aabb)
+            missing = self._draw_list.missing
+            if missing:
+                self._load_missing(missing, w, image_scale)
+                continue
+            stale = self._draw_list.stale_caches
+            if not stale or not self._targets_supported:
+                return
+            for nd in stale:
+                self._render_cache(nd, w, image_scale)
+
+    def _load_missing(self, missing, w, image_scale):
+        for nd in missing:
             self._load_sprite(nd, image_scale, w)
-        sprite = self._sprites[n_id].sprite
-        rel_pos = nd.relative_pos
-        self._rect.x = x + int(w * rel_pos.x * self._zoom + 0.5)
-        self._rect.y = y + int(w * rel_pos.y * self._zoom + 0.5)
-        self._rect.w, self._rect.h = (
-            int(sprite.size[0] * scale_x + 0.5),
-            int(sprite.size[1] * scale_y + 0.5)
-        )
-        rot_center = nd.rotation_center
-        center = rect.SDL_Point(
-            int(rot_center.x * w * scale_x * self._zoom + 0.5),
-            int(rot_center.y * w * scale_y * self._zoom + 0.5)
-        )
-        if self._rcopy(self.renderer, sprite.texture, None, self._rect,
-                       nd.relative_angle, center, sprite.flip) == -1:
+        self.root_node.traverse()
+        self.uiroot.traverse()
+        SGDH.update_render(w, self._zoom, self._view_pos.x, self._view_pos.y)
+
+    def _render_cache(self, nd, w, image_scale):
+        """
+        Render the whole subtree of ``nd`` into its cache texture and register
+        it with the draw list. Leaves the draw list with the subtree commands.
+        """
+        everything = aabb.AABB(0.0, 0.0, 1e9, 1e9)
+        while True:
+            self._draw_list.clear()
+            self._draw_list.build(nd, everything, False)
+            missing = self._draw_list.missing
+            if not missing:
+                break
+            self._load_missing(missing, w, image_scale)
+        extent = self._draw_list.extent()
+        if extent is None:
+            self._draw_list.set_cache(nd.node_id, 0, (0, 0, 0, 0))
+            nd.validate_cache()
+            return
+        x, y, width, height = extent
+        texture, size = self._caches.get(nd.node_id, (None, None))
+        if size != (width, height):
+            if texture is not None:
+                render.SDL_DestroyTexture(texture)
+            texture = render.SDL_CreateTexture(
+                self.renderer, pixels.SDL_PIXELFORMAT_RGBA8888,
+                render.SDL_TEXTUREACCESS_TARGET, width, height
+            )
+            if not texture:
+                self._caches.pop(nd.node_id, None)
+                raise sdl2.ext.common.SDLError()
+            render.SDL_SetTextureBlendMode(texture, self._cache_blend)
+            self._caches[nd.node_id] = texture, (width, height)
+        self._draw_list.translate(-x, -y)
+        render.SDL_SetRenderTarget(self.renderer, texture)
+        self._renderer.clear(sdl2.ext.Color(0, 0, 0, 0))
+        if self._batch_geometry and self._geometry_ptr:
+            ret = self._draw_list.submit_geometry(self._renderer_ptr,
+                                                  self._geometry_ptr)
+        else:
+            ret = self._draw_list.submit(self._renderer_ptr, self._rcopy_ptr)
+        render.SDL_SetRenderTarget(self.renderer, None)
+        if ret != 0:
             raise sdl2.ext.common.SDLError()
+        r_x, r_y = nd.render_rect[:2]
+        self._draw_list.set_cache(
+            nd.node_id,
+            ctypes.cast(texture, ctypes.c_void_p).value,
+            (x - r_x, y - r_y, width, height)
+        )
+        nd.validate_cache()
+
+    def _clear_caches(self):
+        for texture, _ in self._caches.values():
+            render.SDL_DestroyTexture(texture)
+        self._caches.clear()
+        self._draw_list.clear_caches()
+
+    def _load_uploaded(self, scale, w):
+        """Load pending nodes again, now that some of their images are ready."""
+        pending = self._pending
+        self._pending = {}
+        for nd in pending.values():
+            self._load_sprite(nd, scale, w)
+            SGDH.invalidate_cache(nd.node_id)
+        self._dirty = True
+
+    def _load_image(self, nd, scale, w):
+        """
+        Sprite of ``nd`` or ``None`` while its image is decoded asynchronously,
+        an empty texture of the final size is registered meanwhile.
+        """
+        image_str = nd.image
+        if image_str.find(':F:') > -1:  # Pass world unit to float SDF
+            image_str += f':w={w}'
+        if image_str.startswith('SDF:'):
+            return self.sprite_loader.load_image(image_str, scale)
+        sprite = self.sprite_loader.load_image_async(image_str, scale)
+        if sprite is None:
+            self._pending[nd.node_id] = nd
+            self._draw_list.set_texture(nd.node_id, 0, 0, 0)
+            if nd.tiled:
+                self._set_size(nd, *self._window.size, scaled=True)
+            else:
+                self._set_size(nd, *self.sprite_loader.imagesize(image_str,
+                                                                 scale))
+        return sprite
 
     def _load_sprite(self, nd, scale, w=None):
         if isinstance(nd, node.ImageNode):
-            image_str = nd.image
-            if image_str.find(':F:') > -1:  # Pass world unit to float SDF
-                image_str += f':w={w}'
-            res = None
-            if nd.tiled:
-                res = self._window.size
-            self._sprites[nd.node_id] = Sprite(
-                scale,
-                self.sprite_loader.load_image(image_str, scale, res),
-                nd.index,
-                nd.image
-            )
-        elif isinstance(nd, node.TextNode):
+            sprite = self._load_image(nd, scale, w)
+            if sprite is None:
+                return
+            self._sprites[nd.node_id] = Sprite(scale, sprite, nd.index,
+                                               nd.image)
+        elif isinstance(nd, node.TextNode) and nd.text:
             size = int(
                 nd.font_size * nd.relative_scale[1] * min(self.window_size)
             )
@@ -189,12 +357,59 @@ class HWRenderer(sdl2.ext.TextureSpriteRenderSystem):
                 0,
                 ''
             )
-        x, y = self._sprites[nd.node_id].sprite.size
+        else:
+            self._draw_list.set_texture(nd.node_id, 0, 0, 0)
+            return
+        sprite = self._sprites[nd.node_id].sprite
+        x, y = sprite.size
+        if isinstance(nd, node.ImageNode) and nd.tiled:
+            self._set_tiled(nd, sprite)
+            return
+        self._draw_list.set_texture(
+            nd.node_id,
+            ctypes.cast(sprite.texture, ctypes.c_void_p).value,
+            x,
+            y,
+            sprite.flip,
+            isinstance(nd, node.TextNode),
+            getattr(sprite, 'src', None),
+            getattr(sprite, 'tex_size', None)
+        )
+        self._set_size(nd, x, y, isinstance(nd, node.TextNode))
+
+    def _set_tiled(self, nd, sprite):
+        """
+        Register ``sprite`` as tile, repeated natively across the window
+        instead of pasting it into a window sized image.
+        """
+        x, y = sprite.size
         sx, sy = nd.relative_scale
-        nd.size = (
-            round(x * sx, 0) / min(self._window.size),
-            round(y * sy, 0) / min(self._window.size)
+        self._draw_list.set_texture(
+            nd.node_id,
+            ctypes.cast(sprite.texture, ctypes.c_void_p).value,
+            max(int(round(x * sx)), 1),
+            max(int(round(y * sy)), 1),
+            sprite.flip,
+            False,
+            getattr(sprite, 'src', None),
+            getattr(sprite, 'tex_size', (x, y)),
+            True
         )
+        self._set_size(nd, *self._window.size, scaled=True)
+
+    def _set_size(self, nd, x, y, scaled=False):
+        """
+        Size ``nd`` to display ``x`` by ``y`` pixel of its texture at a
+        relative scale of 1, so later scale changes apply to the drawn size.
+        With ``scaled``, ``x`` and ``y`` are the pixel size at its current
+        relative scale instead (e.g. text rasterized at its final size).
+        """
+        if scaled:
+            sx, sy = nd.relative_scale
+            x = x / sx if sx else 0.0
+            y = y / sy if sy else 0.0
+        unit = min(self._window.size)
+        nd.size = x / unit, y / unit
 
     def _update_view_aabb(self):
         # type: () -> aabb.AABB
@@ -275,6 +490,52 @@ class HWRenderer(sdl2.ext.TextureSpriteRenderSystem):
             self._zoom = value
             self._dirty = True
 
+    @property
+    def batch_geometry(self):
+        # type: () -> bool
+        """
+        Whether to draw through ``SDL_RenderGeometry``, batching consecutive
+        sprites that share a texture (e.g. an atlas page). Ignored when SDL is
+        older than 2.0.18.
+        """
+        return self._batch_geometry
+
+    @batch_geometry.setter
+    def batch_geometry(self, value):
+        # type: (bool) -> None
+        if not isinstance(value, bool):
+            raise TypeError
+        self._batch_geometry = value
+
+    @property
+    def partial_redraw(self):
+        # type: () -> bool
+        """
+        Whether to keep the last frame in a render target and only redraw the
+        area that changed since. Pays off when most of the scene is static,
+        call :meth:`set_dirty` to force a full redraw (e.g. after the render
+        targets were reset).
+        """
+        return self._partial_redraw
+
+    @partial_redraw.setter
+    def partial_redraw(self, value):
+        # type: (bool) -> None
+        if not isinstance(value, bool):
+            raise TypeError
+        if value != self._partial_redraw:
+            self._partial_redraw = value
+            self._dirty = True
+            if not value and self._target is not None:
+                render.SDL_DestroyTexture(self._target)
+                self._target = None
+
+    @property
+    def draw_list(self):
+        # type: () -> node.DrawList
+        """The :class:`~foolysh.scene.node.DrawList` of the last frame."""
+        return self._draw_list
+
     @property
     def view_pos(self):
         # type: () -> vec2.Vec2
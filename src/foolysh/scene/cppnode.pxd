@@ -6,6 +6,8 @@ NodePath implementation.
 from ..tools.cppvec2 cimport Vec2
 from ..tools.cppaabb cimport AABB
 
+from libcpp.vector cimport vector
+
 __author__ = 'Tiziano Bettio'
 __license__ = 'MIT'
 __version__ = '0.1'
@@ -38,6 +40,15 @@ cdef extern from "src/quadtree.cpp":
 cdef extern from "src/quadtree.hpp":
     pass
 
+cdef extern from "src/arena.hpp" namespace "foolysh::tools":
+    cdef cppclass FrameArena:
+        FrameArena()
+        void reset()
+        size_t used()
+        size_t capacity()
+        size_t high_water_mark()
+        size_t block_count()
+
 cdef extern from "src/list_t.hpp" namespace "foolysh::tools":
     cdef cppclass FreeList[T]:
         FreeList()
@@ -54,15 +65,6 @@ cdef extern from "src/list_t.hpp" namespace "foolysh::tools":
         int size()
         T& operator[](int)
 
-    cdef cppclass ExtFreeList[T]:
-        ExtFreeList()
-        int insert(T&)
-        void erase(int)
-        void clear()
-        int range()
-        bint active(int)
-        T& operator[](int)
-
 cdef extern from "src/node.cpp":
     pass
 
@@ -94,8 +96,21 @@ cdef extern from "src/node.hpp" namespace "foolysh::scene":
         bint operator==(const double)
         bint operator!=(const double)
 
+    cdef cppclass ViewTransform:
+        double unit, zoom, view_x, view_y
+
+    cdef cppclass RenderRect:
+        int x, y, w, h, cx, cy
+        double angle
+
     cdef cppclass SceneGraphDataHandler:
-        pass
+        FrameArena arena
+        bint fast_trig
+        void reset_arena()
+        size_t size()
+
+    void process_render(SceneGraphDataHandler&, const ViewTransform&)
+    void invalidate_cache(SceneGraphDataHandler&, const size_t)
 
     cdef cppclass Node:
         Node(SceneGraphDataHandler&) except +
@@ -110,6 +125,7 @@ cdef extern from "src/node.hpp" namespace "foolysh::scene":
         void hide()
         void show()
         void propagate_dirty()
+        SmallList[size_t] remove() except +
 
         size_t get_id()
         size_t get_parent_id()
@@ -154,5 +170,82 @@ cdef extern from "src/node.hpp" namespace "foolysh::scene":
         Size get_size()
         void set_distance_relative(const bint)
         bint get_distance_relative()
+        void set_cache_as_bitmap(const bint)
+        bint get_cache_as_bitmap()
+        bint cache_valid()
+        void validate_cache()
 
         AABB get_aabb()
+        RenderRect get_render_rect() except +
+
+cdef extern from "src/drawlist.cpp":
+    pass
+
+cdef extern from "src/drawlist.hpp" namespace "foolysh::scene":
+    cdef cppclass DrawRect:
+        int x, y, w, h
+
+    cdef cppclass DrawPoint:
+        int x, y
+
+    cdef cppclass DrawVertex:
+        float x, y
+        unsigned char r, g, b, a
+        float u, v
+
+    ctypedef int (*RenderCopyEx)(void*, void*, const DrawRect*,
+                                 const DrawRect*, double, const DrawPoint*,
+                                 int)
+
+    ctypedef int (*RenderGeometry)(void*, void*, const DrawVertex*, int,
+                                   const int*, int)
+
+    cdef cppclass DrawTexture:
+        void* texture
+        DrawRect src
+        int w, h
+        int tex_w, tex_h
+        int flip
+        bint fixed_size
+        bint tiled
+
+    cdef cppclass DrawCache:
+        void* texture
+        DrawRect rect
+
+    cdef cppclass DrawCommand:
+        void* texture
+        DrawRect src
+        DrawRect dst
+        double angle
+        DrawPoint center
+        int flip
+        int tex_w, tex_h
+        int tile_w, tile_h
+        int depth
+        DrawRect bounds
+        size_t node_id
+
+    cdef cppclass DrawList:
+        DrawList() except +
+        void set_texture(const size_t, const DrawTexture&) except +
+        void remove_texture(const size_t)
+        bint has_texture(const size_t)
+        void clear_textures()
+        void set_cache(const size_t, const DrawCache&) except +
+        void remove_cache(const size_t)
+        bint has_cache(const size_t)
+        void clear_caches()
+        void build(SceneGraphDataHandler&, SmallList[size_t]&,
+                   const bint) except +
+        void clear()
+        DrawRect extent()
+        void translate(const int, const int)
+        int submit(void*, RenderCopyEx, const DrawRect*)
+        int submit_geometry(void*, RenderGeometry, const DrawRect*)
+        size_t batch_count()
+        DrawRect update_damage()
+        size_t size()
+        const DrawCommand& get(const size_t) except +
+        vector[size_t] missing()
+        vector[size_t] stale_caches()
@@ -8,6 +8,17 @@ from .cppnode cimport SceneGraphDataHandler as _SceneGraphDataHandler
 from .cppnode cimport SmallList
 from .cppnode cimport Scale
 from .cppnode cimport Size
+from .cppnode cimport RenderRect
+from .cppnode cimport ViewTransform
+from .cppnode cimport process_render
+from .cppnode cimport invalidate_cache
+from .cppnode cimport DrawList as _DrawList
+from .cppnode cimport DrawTexture
+from .cppnode cimport DrawCache
+from .cppnode cimport DrawCommand
+from .cppnode cimport DrawRect
+from .cppnode cimport RenderCopyEx
+from .cppnode cimport RenderGeometry
 from .cppnode cimport Origin as _Origin
 from ..tools.cppaabb cimport AABB as _AABB
 from ..tools.aabb cimport AABB
@@ -17,6 +28,7 @@ from ..tools.common import Origin
 
 from cython.operator cimport dereference as deref
 
+from libc.stdint cimport uintptr_t
 from libcpp.memory cimport unique_ptr
 
 __author__ = 'Tiziano Bettio'
@@ -44,6 +56,7 @@ SOFTWARE."""
 
 cdef dict _nodes = {}
 cdef list _need_size = []
+cdef list _sprite_dirty = []
 
 
 def unsized_nodes():
@@ -59,10 +72,334 @@ def unsized_nodes():
     return nodes
 
 
+def changed_sprites():
+    """
+    Returns a list of node ids whose image or text changed or that were
+    removed, i.e. whose texture must be reloaded before drawing them again.
+
+    .. warning::
+        The list is cleared after each call to this function!
+    """
+    ids = list(_sprite_dirty)
+    _sprite_dirty.clear()
+    return ids
+
+
 cdef class SceneGraphDataHandler:
     def __cinit__(self):
         self.thisptr.reset(new _SceneGraphDataHandler())
 
+    def reset_arena(self):
+        """
+        Release the scratch memory used by traversal and queries. Called once
+        per frame by :class:`foolysh.app.App` after rendering.
+        """
+        deref(self.thisptr).reset_arena()
+
+    @property
+    def arena_stats(self):
+        """
+        ``dict`` -> bytes ``used``, ``capacity``, ``high_water_mark`` and
+        number of ``blocks`` of the per-frame arena.
+        """
+        return {
+            'used': deref(self.thisptr).arena.used(),
+            'capacity': deref(self.thisptr).arena.capacity(),
+            'high_water_mark': deref(self.thisptr).arena.high_water_mark(),
+            'blocks': deref(self.thisptr).arena.block_count()
+        }
+
+    def update_render(self, double unit, double zoom, double view_x,
+                      double view_y):
+        """
+        Compute the pixel snapped render rectangle of all nodes in one native
+        pass, readable afterwards through :attr:`Node.render_rect`. Call after
+        traversal.
+
+        Args:
+            unit: ``float`` pixels per world unit (smaller window dimension).
+            zoom: ``float`` zoom factor.
+            view_x: ``float`` horizontal view offset in world units.
+            view_y: ``float`` vertical view offset in world units.
+        """
+        cdef ViewTransform view
+        view.unit = unit
+        view.zoom = zoom
+        view.view_x = view_x
+        view.view_y = view_y
+        process_render(deref(self.thisptr), view)
+
+    def invalidate_cache(self, size_t node_id):
+        """
+        Invalidate the cached bitmaps of all ancestors of ``node_id``, e.g.
+        after its sprite changed.
+        """
+        if node_id < deref(self.thisptr).size():
+            invalidate_cache(deref(self.thisptr), node_id)
+
+    @property
+    def fast_trig(self):
+        """
+        ``bool`` -> whether transforms and bounding boxes use a fast sine and
+        cosine approximation (absolute error below 1e-7) instead of libm.
+        Affects nodes processed after the change.
+        """
+        return deref(self.thisptr).fast_trig
+
+    @fast_trig.setter
+    def fast_trig(self, value):
+        deref(self.thisptr).fast_trig = bool(value)
+
+
+cdef class DrawList:
+    """
+    Packed list of draw commands for the nodes returned by a depth sorted
+    query. Textures are registered per node as raw ``SDL_Texture`` addresses,
+    :meth:`submit` issues the whole list natively. :meth:`update_damage`
+    reports the screen area that changed since the previous frame, which can
+    be passed as ``clip`` to only redraw that part.
+    """
+    cdef unique_ptr[_DrawList] thisptr
+
+    def __cinit__(self):
+        self.thisptr.reset(new _DrawList())
+
+    def set_texture(self, size_t node_id, uintptr_t texture, int w, int h,
+                    int flip=0, bint fixed_size=False, src=None,
+                    tex_size=None, bint tiled=False):
+        """
+        Register the texture to draw for a node.
+
+        Args:
+            node_id: ``int``
+            texture: ``int`` -> address of the texture, 0 if the node has
+                nothing to draw.
+            w: ``int`` texture width in pixels.
+            h: ``int`` texture height in pixels.
+            flip: ``int`` -> ``SDL_RendererFlip`` value.
+            fixed_size: ``bool`` -> draw at ``w``/``h`` instead of the size
+                of the node.
+            src: ``Optional[Tuple[int, int, int, int]]`` -> source rectangle,
+                defaults to the whole texture.
+            tex_size: ``Optional[Tuple[int, int]]`` -> size of the whole
+                texture, defaults to ``w, h``. Used by :meth:`submit_geometry`.
+            tiled: ``bool`` -> repeat the texture at ``w``/``h`` across the
+                size of the node instead of stretching it.
+        """
+        cdef DrawTexture t
+        t.texture = <void*> texture
+        t.w = w
+        t.h = h
+        t.flip = flip
+        t.fixed_size = fixed_size
+        t.tiled = tiled
+        t.tex_w, t.tex_h = (w, h) if tex_size is None else tex_size
+        if src is None:
+            t.src.x = t.src.y = t.src.w = t.src.h = 0
+        else:
+            t.src.x, t.src.y, t.src.w, t.src.h = src
+        deref(self.thisptr).set_texture(node_id, t)
+
+    def remove_texture(self, size_t node_id):
+        deref(self.thisptr).remove_texture(node_id)
+
+    def has_texture(self, size_t node_id):
+        return deref(self.thisptr).has_texture(node_id)
+
+    def clear_textures(self):
+        """Forget all registered textures."""
+        deref(self.thisptr).clear_textures()
+
+    def set_cache(self, size_t node_id, uintptr_t texture, rect):
+        """
+        Register the cached bitmap of the subtree of ``node_id``.
+
+        Args:
+            node_id: ``int`` -> id of a Node with :attr:`Node.cache_as_bitmap`.
+            texture: ``int`` -> address of the ``SDL_Texture``, 0 if the
+                subtree has nothing to draw.
+            rect: ``Tuple[int, int, int, int]`` -> offset relative to the
+                render position of the Node and size of the bitmap.
+        """
+        cdef DrawCache c
+        c.texture = <void*> texture
+        c.rect.x, c.rect.y, c.rect.w, c.rect.h = rect
+        deref(self.thisptr).set_cache(node_id, c)
+
+    def remove_cache(self, size_t node_id):
+        deref(self.thisptr).remove_cache(node_id)
+
+    def has_cache(self, size_t node_id):
+        return deref(self.thisptr).has_cache(node_id)
+
+    def clear_caches(self):
+        """Forget all registered caches."""
+        deref(self.thisptr).clear_caches()
+
+    def build(self, Node root, AABB aabb, bint use_caches=True):
+        """
+        Append commands for all nodes below ``root`` that intersect ``aabb``,
+        in depth order. Requires an up to date render column, see
+        :meth:`SceneGraphDataHandler.update_render`.
+
+        Args:
+            root: :class:`Node`
+            aabb: :class:`foolysh.tools.aabb.AABB`
+            use_caches: ``bool`` -> draw subtrees of nodes with a valid cache
+                as one command from the cached bitmap.
+        """
+        cdef SceneGraphDataHandler sgdh
+        from . import SGDH
+        sgdh = SGDH
+        cdef SmallList[size_t] r = deref(root.thisptr).query(
+            deref(aabb.thisptr),
+            True
+        )
+        deref(self.thisptr).build(deref(sgdh.thisptr), r, use_caches)
+
+    def clear(self):
+        """Drop all commands, registered textures are kept."""
+        deref(self.thisptr).clear()
+
+    def extent(self):
+        """
+        ``Optional[Tuple[int, int, int, int]]`` -> pixel rectangle covering
+        all commands, ``None`` if empty.
+        """
+        cdef DrawRect r = deref(self.thisptr).extent()
+        if r.w == 0:
+            return None
+        return r.x, r.y, r.w, r.h
+
+    def translate(self, int dx, int dy):
+        """Move all commands by ``dx``/``dy`` pixels."""
+        deref(self.thisptr).translate(dx, dy)
+
+    @property
+    def missing(self):
+        """
+        ``list`` of :class:`Node` that were skipped by :meth:`build` because
+        they have no registered texture.
+        """
+        cdef size_t i
+        return [_nodes[i] for i in deref(self.thisptr).missing()
+                if i in _nodes]
+
+    @property
+    def stale_caches(self):
+        """
+        ``list`` of :class:`Node` with :attr:`Node.cache_as_bitmap` whose
+        subtree was drawn node by node by :meth:`build`, because the cache is
+        invalid or not registered yet.
+        """
+        cdef size_t i
+        return [_nodes[i] for i in deref(self.thisptr).stale_caches()
+                if i in _nodes]
+
+    @property
+    def node_ids(self):
+        """``list`` of the node ids of all commands, in draw order."""
+        cdef size_t i
+        return [deref(self.thisptr).get(i).node_id
+                for i in range(deref(self.thisptr).size())]
+
+    def submit(self, uintptr_t renderer, uintptr_t render_copy_ex,
+               clip=None):
+        """
+        Draw all commands.
+
+        Args:
+            renderer: ``int`` -> address of the ``SDL_Renderer``.
+            render_copy_ex: ``int`` -> address of ``SDL_RenderCopyEx``.
+            clip: optional ``Tuple[int, int, int, int]`` -> only draw
+                commands whose bounds overlap this pixel rectangle.
+
+        Returns:
+            ``int`` -> 0 on success, otherwise the first error code.
+        """
+        cdef DrawRect r
+        if clip is None:
+            return deref(self.thisptr).submit(<void*> renderer,
+                                              <RenderCopyEx> render_copy_ex,
+                                              NULL)
+        r.x, r.y, r.w, r.h = clip
+        return deref(self.thisptr).submit(<void*> renderer,
+                                          <RenderCopyEx> render_copy_ex, &r)
+
+    def submit_geometry(self, uintptr_t renderer, uintptr_t render_geometry,
+                        clip=None):
+        """
+        Draw all commands as rotated quads, one call per run of commands that
+        share a texture.
+
+        Args:
+            renderer: ``int`` -> address of the ``SDL_Renderer``.
+            render_geometry: ``int`` -> address of ``SDL_RenderGeometry``.
+            clip: optional ``Tuple[int, int, int, int]`` -> only draw
+                commands whose bounds overlap this pixel rectangle.
+
+        Returns:
+            ``int`` -> 0 on success, otherwise the first error code.
+        """
+        cdef DrawRect r
+        if clip is None:
+            return deref(self.thisptr).submit_geometry(
+                <void*> renderer,
+                <RenderGeometry> render_geometry,
+                NULL
+            )
+        r.x, r.y, r.w, r.h = clip
+        return deref(self.thisptr).submit_geometry(
+            <void*> renderer,
+            <RenderGeometry> render_geometry,
+            &r
+        )
+
+    def update_damage(self):
+        """
+        Compare the current commands with the previous call.
+
+        Returns:
+            ``Optional[Tuple[int, int, int, int]]`` -> pixel rectangle
+            covering old and new bounds of every added, removed or changed
+            command, ``None`` if nothing changed.
+        """
+        cdef DrawRect r = deref(self.thisptr).update_damage()
+        if r.w == 0:
+            return None
+        return r.x, r.y, r.w, r.h
+
+    @property
+    def batch_count(self):
+        """``int`` -> number of batches issued by the last geometry submit."""
+        return deref(self.thisptr).batch_count()
+
+    def __len__(self):
+        return deref(self.thisptr).size()
+
+    def __getitem__(self, Py_ssize_t item):
+        cdef Py_ssize_t size = deref(self.thisptr).size()
+        if item < 0:
+            item += size
+        if not -1 < item < size:
+            raise IndexError('Invalid index')
+        cdef DrawCommand c = deref(self.thisptr).get(item)
+        return {
+            'node_id': c.node_id,
+            'texture': <uintptr_t> c.texture,
+            'src': (c.src.x, c.src.y, c.src.w, c.src.h),
+            'dst': (c.dst.x, c.dst.y, c.dst.w, c.dst.h),
+            'angle': c.angle,
+            'center': (c.center.x, c.center.y),
+            'flip': c.flip,
+            'tile': (c.tile_w, c.tile_h),
+            'bounds': (c.bounds.x, c.bounds.y, c.bounds.w, c.bounds.h)
+        }
+
+    def __iter__(self):
+        for i in range(len(self)):
+            yield self[i]
+
 
 cdef class Node:
     """
@@ -131,12 +468,16 @@ cdef class Node:
         """
         return deref(self.thisptr).get_parent_id()
 
-    cpdef void remove(self):  # TODO: Fix removing of nodes
+    cpdef void remove(self):
         """
-        Removes the cyclic reference to the wrapped Node so it can get garbage
-        collected.
+        Removes this Node and all its descendants from the scene and drops the
+        cyclic references to the wrapped Nodes so they can get garbage
+        collected. Instances still referenced elsewhere become detached roots.
         """
-        _nodes.pop(deref(self.thisptr).get_id())
+        cdef SmallList[size_t] r = deref(self.thisptr).remove()
+        for i in range(r.size()):
+            _nodes.pop(r[i], None)
+            _sprite_dirty.append(r[i])
 
     def attach_node(self, name='Unnamed Node'):
         """
@@ -675,6 +1016,16 @@ cdef class Node:
         cdef _Vec2 v = deref(self.thisptr).get_relative_pos()
         return Vec2(v[0], v[1])
 
+    @property
+    def render_rect(self):
+        """
+        ``tuple`` -> pixel ``x, y, w, h``, rotation center ``cx, cy`` and
+        ``angle`` as computed by the last
+        :meth:`SceneGraphDataHandler.update_render`.
+        """
+        cdef RenderRect r = deref(self.thisptr).get_render_rect()
+        return r.x, r.y, r.w, r.h, r.cx, r.cy, r.angle
+
     @property
     def relative_scale(self):
         """
@@ -748,6 +1099,33 @@ cdef class Node:
         else:
             raise TypeError
 
+    @property
+    def cache_as_bitmap(self):
+        """
+        ``bool`` whether this Node and its subtree are rendered once into a
+        texture and drawn from there, until any node in the subtree changes.
+        Worth it for complex, mostly static subtrees like ui panels.
+        """
+        return deref(self.thisptr).get_cache_as_bitmap()
+
+    @cache_as_bitmap.setter
+    def cache_as_bitmap(self, v):
+        if isinstance(v, bool):
+            deref(self.thisptr).set_cache_as_bitmap(v)
+        else:
+            raise TypeError
+
+    @property
+    def cache_valid(self):
+        """
+        ``bool`` whether the cached bitmap of this Node is up to date.
+        """
+        return deref(self.thisptr).cache_valid()
+
+    def validate_cache(self):
+        """Mark the cached bitmap as up to date, used by the renderer."""
+        deref(self.thisptr).validate_cache()
+
     @property
     def relative_size(self):
         """
@@ -827,11 +1205,15 @@ cdef class ImageNode(Node):
         if value != self._current_index:
             self._current_index = value
             self.propagate_dirty()
+            _sprite_dirty.append(self.node_id)
 
     @property
     def tiled(self):
         # type: () -> bool
-        """Whether this is a tiled image that spans the screen."""
+        """
+        Whether this is a tiled image that spans the screen. The image is
+        repeated at its own size instead of being stretched.
+        """
         return self._tiled
 
     @tiled.setter
@@ -839,7 +1221,10 @@ cdef class ImageNode(Node):
         # type: (bool) -> None
         if not isinstance(value, bool):
             raise TypeError
-        self._tiled = value
+        if value != self._tiled:
+            self._tiled = value
+            self.propagate_dirty()
+            _sprite_dirty.append(self.node_id)
 
     def add_image(self, image):
         # type: (str) -> int
@@ -862,6 +1247,7 @@ cdef class ImageNode(Node):
         """Removes all images stored in this node."""
         self._images = []
         self._current_index = -1
+        _sprite_dirty.append(self.node_id)
 
     def __getitem__(self, item):
         return self._images[item]
@@ -871,6 +1257,7 @@ cdef class ImageNode(Node):
             self._images[item] = value
             if item == self._current_index:
                 self.propagate_dirty()
+                _sprite_dirty.append(self.node_id)
 
 
 cdef class TextNode(Node):
@@ -935,6 +1322,7 @@ cdef class TextNode(Node):
         if self._text != value:
             self._text = value
             self.propagate_dirty()
+            _sprite_dirty.append(self.node_id)
             if self.node_id not in _need_size:
                 _need_size.append(self.node_id)
 
@@ -952,6 +1340,7 @@ cdef class TextNode(Node):
         if not isinstance(value, str):
             raise TypeError
         self._font = value
+        _sprite_dirty.append(self.node_id)
 
     @property
     def font_size(self):
@@ -967,6 +1356,7 @@ cdef class TextNode(Node):
         if value <= 0.0:
             raise ValueError('Expected positive, non zero float.')
         self._font_size = float(value)
+        _sprite_dirty.append(self.node_id)
 
     @property
     def text_color(self):
@@ -1001,6 +1391,7 @@ cdef class TextNode(Node):
         else:
             raise TypeError
         self._text_color = value
+        _sprite_dirty.append(self.node_id)
 
     @property
     def align(self):
@@ -1016,6 +1407,7 @@ cdef class TextNode(Node):
         if value not in ('left', 'center', 'right'):
             raise ValueError('Expected one of "left", "center", "right".')
         self._align = value
+        _sprite_dirty.append(self.node_id)
 
     @property
     def spacing(self):
@@ -1031,6 +1423,7 @@ cdef class TextNode(Node):
         if value < 0:
             raise ValueError('Expected positive float.')
         self._spacing = value
+        _sprite_dirty.append(self.node_id)
 
     @property
     def multiline(self):
@@ -1044,3 +1437,4 @@ cdef class TextNode(Node):
         if not isinstance(value, bool):
             raise TypeError
         self._multiline = value
+        _sprite_dirty.append(self.node_id)
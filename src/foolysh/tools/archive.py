@@ -0,0 +1,201 @@
+"""
+Provides a packed asset archive with a precomputed index.
+
+:func:`pack` stores every image and font of an asset directory in a single
+file, along with an index of path, image size, format and location. At run
+time :class:`Archive` reads the header and index and maps the file, so
+opening it costs one file open, no matter how many assets it holds. Entries
+are only decoded when they are used.
+
+Build an archive with::
+
+    python -m foolysh.tools.archive <asset_dir> <archive>
+"""
+
+import io
+import json
+import mmap
+import os
+import pathlib
+import struct
+import sys
+import threading
+from typing import BinaryIO
+from typing import Dict
+from typing import List
+from typing import Optional
+from typing import Tuple
+
+from PIL import Image
+
+__author__ = 'Tiziano Bettio'
+__license__ = 'MIT'
+__version__ = '0.1'
+__copyright__ = """Copyright (c) 2020 Tiziano Bettio
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE."""
+
+MAGIC = b'FPAK'
+VERSION = 1
+FONT_SUFFIXES = ('ttf', 'otf')
+_HEADER = struct.Struct('<4sHHQQ')
+_ALIGN = 16
+
+
+class Entry:
+    """Index entry of an archived file."""
+    __slots__ = ('path', 'offset', 'length', 'size', 'format')
+
+    def __init__(self, path, offset, length, size, fmt):
+        # type: (str, int, int, Tuple[int, int], str) -> None
+        self.path = path
+        self.offset = offset
+        self.length = length
+        self.size = size
+        self.format = fmt
+
+
+def _scan(asset_dir):
+    # type: (str) -> List[Tuple[str, Tuple[int, int], str]]
+    """Relative path, size and format of every valid asset in asset_dir."""
+    result = []
+    root = pathlib.Path(asset_dir)
+    for path in sorted(root.glob('**/*.*')):
+        if not path.is_file():
+            continue
+        rel = path.relative_to(root).as_posix()
+        if rel.split('.')[-1].lower() in FONT_SUFFIXES:
+            result.append((rel, (0, 0), 'font'))
+            continue
+        try:
+            with Image.open(str(path)) as img:
+                result.append((rel, img.size, img.format))
+        except IOError:
+            continue
+    return result
+
+
+def pack(asset_dir, archive_path):
+    # type: (str, str) -> int
+    """
+    Pack all images and fonts of ``asset_dir`` into ``archive_path``. Files
+    are stored as they are, in their original encoding.
+
+    Returns:
+        ``int`` number of packed files.
+    """
+    entries = []
+    tmp = f'{archive_path}.{os.getpid()}.{threading.get_ident()}.tmp'
+    with open(tmp, 'wb') as fhandle:
+        fhandle.write(bytes(_HEADER.size))
+        for rel, size, fmt in _scan(asset_dir):
+            offset = fhandle.tell()
+            pad = -offset % _ALIGN
+            fhandle.write(bytes(pad))
+            offset += pad
+            with open(os.path.join(asset_dir, rel), 'rb') as src:
+                data = src.read()
+            fhandle.write(data)
+            entries.append([rel, offset, len(data), list(size), fmt])
+        index = json.dumps(entries, separators=(',', ':')).encode()
+        index_offset = fhandle.tell()
+        fhandle.write(index)
+        fhandle.seek(0)
+        fhandle.write(_HEADER.pack(MAGIC, VERSION, 0, index_offset,
+                                   len(index)))
+    os.replace(tmp, archive_path)
+    return len(entries)
+
+
+class Archive:
+    """
+    Read only view of an archive created by :func:`pack`.
+
+    Args:
+        path: ``str`` -> path of the archive.
+    """
+    def __init__(self, path):
+        # type: (str) -> None
+        self.path = path
+        with open(path, 'rb') as fhandle:
+            header = fhandle.read(_HEADER.size)
+            if len(header) < _HEADER.size:
+                raise ValueError(f'Not an asset archive "{path}".')
+            magic, version, _, index_offset, index_length = \
+                _HEADER.unpack(header)
+            if magic != MAGIC or version != VERSION:
+                raise ValueError(f'Not an asset archive "{path}".')
+            self._mmap = mmap.mmap(fhandle.fileno(), 0,
+                                   access=mmap.ACCESS_READ)
+        index = json.loads(
+            self._mmap[index_offset:index_offset + index_length].decode()
+        )
+        self._entries = {
+            rel: Entry(rel, offset, length, tuple(size), fmt)
+            for rel, offset, length, size, fmt in index
+        }  # type: Dict[str, Entry]
+
+    @property
+    def entries(self):
+        # type: () -> Dict[str, Entry]
+        """All entries by relative path."""
+        return self._entries
+
+    def read(self, rel_path):
+        # type: (str) -> bytes
+        """Stored bytes of ``rel_path``."""
+        entry = self._entries[rel_path]
+        return self._mmap[entry.offset:entry.offset + entry.length]
+
+    def open(self, rel_path):
+        # type: (str) -> BinaryIO
+        """File like object of ``rel_path``."""
+        return io.BytesIO(self.read(rel_path))
+
+    def open_image(self, rel_path):
+        # type: (str) -> Image.Image
+        """Lazily decoded PIL ``Image`` of ``rel_path``."""
+        return Image.open(self.open(rel_path))
+
+    def close(self):
+        # type: () -> None
+        """Unmap the archive."""
+        self._mmap.close()
+
+    def __contains__(self, rel_path):
+        return rel_path in self._entries
+
+    def __len__(self):
+        return len(self._entries)
+
+
+def main(argv=None):
+    # type: (Optional[List[str]]) -> int
+    """Command line entry point: ``<asset_dir> <archive>``."""
+    argv = sys.argv[1:] if argv is None else argv
+    if len(argv) != 2 or not os.path.isdir(argv[0]):
+        print('usage: python -m foolysh.tools.archive <asset_dir> <archive>')
+        return 1
+    count = pack(argv[0], argv[1])
+    print(f'Packed {count} assets into "{argv[1]}".')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
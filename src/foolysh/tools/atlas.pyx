@@ -0,0 +1,183 @@
+# distutils: language = c++
+"""
+Rectangle packing for texture atlases.
+
+:class:`Atlas` packs rectangles (images, rendered text, glyphs) into a few
+fixed size pages, so they can share one texture per page and draws can be
+batched by page. Removed rectangles are reused by later inserts that fit and
+full pages can be evicted as a whole.
+"""
+
+from cython.operator cimport dereference as deref
+from libcpp.memory cimport unique_ptr
+from libcpp.vector cimport vector
+
+from .cppatlas cimport AtlasEntry
+from .cppatlas cimport AtlasRect
+from .cppatlas cimport SkylinePacker as _SkylinePacker
+from .cppatlas cimport TextureAtlas
+
+__author__ = 'Tiziano Bettio'
+__license__ = 'MIT'
+__version__ = '0.1'
+__copyright__ = """Copyright (c) 2020 Tiziano Bettio
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE."""
+
+
+cdef class SkylinePacker:
+    """
+    Packs rectangles into a single ``width`` x ``height`` area along a
+    skyline.
+    """
+    cdef unique_ptr[_SkylinePacker] thisptr
+
+    def __cinit__(self, int width=1024, int height=1024):
+        self.thisptr.reset(new _SkylinePacker(width, height))
+
+    def insert(self, int w, int h):
+        """
+        Place a ``w`` x ``h`` rectangle.
+
+        Returns:
+            ``Optional[Tuple[int, int, int, int]]`` -> ``x, y, w, h`` or
+            ``None`` if it doesn't fit.
+        """
+        cdef AtlasRect r
+        if not deref(self.thisptr).insert(w, h, r):
+            return None
+        return r.x, r.y, r.w, r.h
+
+    def clear(self):
+        deref(self.thisptr).clear()
+
+    @property
+    def size(self):
+        return deref(self.thisptr).width(), deref(self.thisptr).height()
+
+    @property
+    def used_area(self):
+        """``int`` -> area covered by placed rectangles."""
+        return deref(self.thisptr).used_area()
+
+
+cdef class Atlas:
+    """
+    Maps hashable keys to a page and rectangle in a set of fixed size pages.
+
+    Args:
+        page_size: ``int`` -> width and height of a page in pixels.
+        max_pages: ``int`` -> maximum number of pages.
+        padding: ``int`` -> gap in pixels kept to the right and below each
+            rectangle, avoids bleeding when sampling with filtering.
+    """
+    cdef unique_ptr[TextureAtlas] thisptr
+    cdef dict _ids
+    cdef dict _keys
+    cdef long _next_id
+
+    def __cinit__(self, int page_size=1024, int max_pages=4, int padding=1):
+        self.thisptr.reset(new TextureAtlas(page_size, max_pages, padding))
+        self._ids = {}
+        self._keys = {}
+        self._next_id = 0
+
+    def insert(self, key, int w, int h):
+        """
+        Reserve a ``w`` x ``h`` rectangle for ``key``.
+
+        Returns:
+            ``Optional[Tuple[int, Tuple[int, int, int, int]]]`` -> page and
+            ``x, y, w, h`` or ``None`` if there is no room left.
+
+        Raises:
+            ``ValueError`` if ``key`` is already present.
+        """
+        cdef AtlasEntry e
+        if key in self._ids:
+            raise ValueError(f'Key {key!r} already in atlas.')
+        if not deref(self.thisptr).insert(self._next_id, w, h, e):
+            return None
+        self._ids[key] = self._next_id
+        self._keys[self._next_id] = key
+        self._next_id += 1
+        return e.page, (e.rect.x, e.rect.y, e.rect.w, e.rect.h)
+
+    def remove(self, key):
+        """Release the rectangle of ``key``, returns ``False`` if absent."""
+        if key not in self._ids:
+            return False
+        cdef long i = self._ids.pop(key)
+        self._keys.pop(i)
+        return deref(self.thisptr).remove(i)
+
+    def get(self, key):
+        """
+        Returns:
+            ``Optional[Tuple[int, Tuple[int, int, int, int]]]`` -> page and
+            rectangle of ``key``.
+        """
+        cdef AtlasEntry e
+        if key not in self._ids:
+            return None
+        deref(self.thisptr).find(self._ids[key], e)
+        return e.page, (e.rect.x, e.rect.y, e.rect.w, e.rect.h)
+
+    def evict_page(self, int page):
+        """
+        Remove all rectangles on ``page``.
+
+        Returns:
+            ``list`` of the evicted keys.
+        """
+        cdef vector[long] ids = deref(self.thisptr).evict_page(page)
+        cdef list keys = []
+        for i in ids:
+            key = self._keys.pop(i)
+            del self._ids[key]
+            keys.append(key)
+        return keys
+
+    def clear(self):
+        deref(self.thisptr).clear()
+        self._ids.clear()
+        self._keys.clear()
+
+    def occupancy(self, int page):
+        """``float`` -> fraction of ``page`` in use."""
+        return deref(self.thisptr).occupancy(page)
+
+    @property
+    def page_size(self):
+        return deref(self.thisptr).page_size()
+
+    @property
+    def page_count(self):
+        """``int`` -> number of pages opened so far."""
+        return deref(self.thisptr).page_count()
+
+    @property
+    def max_pages(self):
+        return deref(self.thisptr).max_pages()
+
+    def __contains__(self, key):
+        return key in self._ids
+
+    def __len__(self):
+        return deref(self.thisptr).size()
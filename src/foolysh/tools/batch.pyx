@@ -0,0 +1,261 @@
+# distutils: language = c++
+"""
+Batch kernels for contiguous arrays of points and boxes.
+
+Points are passed as arrays of shape ``(n, 2)`` holding ``x, y`` and boxes as
+arrays of shape ``(n, 4)`` holding ``x, y, hw, hh`` (center and half extents,
+like :class:`~foolysh.tools.aabb.AABB`). Any object supporting the buffer
+protocol is accepted, inputs that are not C-contiguous ``float64`` arrays are
+converted first. Results are written to ``out`` when given (which may be one of
+the inputs), otherwise a new ``numpy.ndarray`` is returned.
+
+The kernels use AVX when the CPU supports it.
+"""
+
+from libc.stdint cimport uint8_t
+
+from .aabb cimport AABB
+from .cppaabb cimport AABB as _AABB
+from . cimport cppbatch
+from .cppbatch cimport Vec2d, ConstPoints, Points, ConstBoxes, Mask
+from .cppbatch cimport ConstDoubles, Doubles
+
+import numpy as np
+
+__author__ = 'Tiziano Bettio'
+__license__ = 'MIT'
+__version__ = '0.1'
+__copyright__ = """Copyright (c) 2020 Tiziano Bettio
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE."""
+
+_LEVELS = {'scalar': cppbatch.SCALAR, 'avx': cppbatch.AVX}
+
+
+def simd_level():
+    """
+    Returns:
+        ``str`` name of the instruction set used by the kernels.
+    """
+    cdef cppbatch.SimdLevel level = cppbatch.simd_level()
+    for k, v in _LEVELS.items():
+        if v == level:
+            return k
+    return 'scalar'
+
+
+def set_simd_level(level):
+    """
+    Select the instruction set used by the kernels, capped at what the CPU
+    supports. Mainly useful for testing and benchmarking.
+
+    Args:
+        level: ``str`` one of ``'scalar'`` or ``'avx'``.
+    """
+    if level not in _LEVELS:
+        raise ValueError(f'Unknown SIMD level "{level}".')
+    cppbatch.set_simd_level(_LEVELS[level])
+
+
+def add(a, b, out=None):
+    """
+    Returns:
+        ``a + b`` for two arrays of points.
+    """
+    a, b = _points(a), _points(b)
+    out = _points_out(a, out)
+    cppbatch.add(_cpoints(a), _cpoints(b), _mpoints(out))
+    return out
+
+
+def scale(a, double s, out=None):
+    """
+    Returns:
+        ``a * s`` for an array of points.
+    """
+    a = _points(a)
+    out = _points_out(a, out)
+    cppbatch.scale(_cpoints(a), s, _mpoints(out))
+    return out
+
+
+def rotate(a, double angle, center=(0.0, 0.0), bint radians=False, out=None):
+    """
+    Rotate an array of points around ``center``, same convention as
+    :meth:`~foolysh.tools.vec2.Vec2.rotate`.
+
+    Args:
+        a: array of points.
+        angle: ``float`` angle in degrees or radians.
+        center: ``tuple`` of two ``float``, the center of rotation.
+        radians: ``bool`` whether ``angle`` is in radians.
+        out: optional output array.
+    """
+    cdef Vec2d c
+    c.x, c.y = center
+    a = _points(a)
+    out = _points_out(a, out)
+    cppbatch.rotate(_cpoints(a), angle, c, _mpoints(out), radians)
+    return out
+
+
+def normalize(a, out=None):
+    """
+    Returns:
+        Array of points normalized to unit length. Points of zero length are
+        returned unchanged.
+    """
+    a = _points(a)
+    out = _points_out(a, out)
+    cppbatch.normalize(_cpoints(a), _mpoints(out))
+    return out
+
+
+def lerp(a, b, double t, out=None):
+    """
+    Returns:
+        ``a + (b - a) * t`` for two arrays of points.
+    """
+    a, b = _points(a), _points(b)
+    out = _points_out(a, out)
+    cppbatch.lerp(_cpoints(a), _cpoints(b), t, _mpoints(out))
+    return out
+
+
+def sin_cos(angles):
+    """
+    Approximate sine and cosine (absolute error below 1e-7).
+
+    Args:
+        angles: 1D array of angles in radians.
+
+    Returns:
+        ``tuple`` of two arrays, sine and cosine of ``angles``.
+    """
+    angles = np.ascontiguousarray(angles, dtype=np.float64)
+    if angles.ndim != 1:
+        raise ValueError(f'Expected a 1D array, got {angles.shape}.')
+    s, c = np.empty_like(angles), np.empty_like(angles)
+    cppbatch.sin_cos(_cdoubles(angles), _mdoubles(s), _mdoubles(c))
+    return s, c
+
+
+def overlap(boxes, AABB query, out=None):
+    """
+    Returns:
+        ``bool`` array, ``True`` where a box overlaps ``query``.
+    """
+    boxes = _boxes(boxes)
+    out = _mask_out(boxes, out)
+    cppbatch.overlap(_cboxes(boxes), query.aabb(), _mmask(out))
+    return out
+
+
+def contains(boxes, double x, double y, out=None):
+    """
+    Returns:
+        ``bool`` array, ``True`` where a box contains the point ``x, y``.
+    """
+    cdef Vec2d p
+    p.x = x
+    p.y = y
+    boxes = _boxes(boxes)
+    out = _mask_out(boxes, out)
+    cppbatch.contains(_cboxes(boxes), p, _mmask(out))
+    return out
+
+
+def union(boxes):
+    """
+    Returns:
+        :class:`~foolysh.tools.aabb.AABB` enclosing all boxes.
+    """
+    cdef _AABB r = cppbatch.bounds_union(_cboxes(_boxes(boxes)))
+    return AABB(r.x, r.y, r.hw, r.hh)
+
+
+def _points(a):
+    a = np.ascontiguousarray(a, dtype=np.float64)
+    if a.ndim != 2 or a.shape[1] != 2:
+        raise ValueError(f'Expected an array of shape (n, 2), got {a.shape}.')
+    return a
+
+
+def _boxes(a):
+    a = np.ascontiguousarray(a, dtype=np.float64)
+    if a.ndim != 2 or a.shape[1] != 4:
+        raise ValueError(f'Expected an array of shape (n, 4), got {a.shape}.')
+    return a
+
+
+def _points_out(a, out):
+    if out is None:
+        return np.empty_like(a)
+    if not isinstance(out, np.ndarray) or out.dtype != np.float64 \
+       or out.shape != a.shape or not out.flags.c_contiguous:
+        raise ValueError('out must be a C-contiguous float64 array of shape '
+                         f'{a.shape}.')
+    return out
+
+
+def _mask_out(a, out):
+    if out is None:
+        return np.empty(a.shape[0], dtype=np.bool_)
+    if not isinstance(out, np.ndarray) or out.dtype != np.bool_ \
+       or out.shape != (a.shape[0], ) or not out.flags.c_contiguous:
+        raise ValueError('out must be a C-contiguous bool array of shape '
+                         f'({a.shape[0]}, ).')
+    return out
+
+
+cdef ConstPoints _cpoints(const double[:, ::1] a):
+    if a.shape[0] == 0:
+        return ConstPoints(NULL, 0)
+    return ConstPoints(<const Vec2d*> &a[0, 0], a.shape[0])
+
+
+cdef Points _mpoints(double[:, ::1] a):
+    if a.shape[0] == 0:
+        return Points(NULL, 0)
+    return Points(<Vec2d*> &a[0, 0], a.shape[0])
+
+
+cdef ConstDoubles _cdoubles(const double[::1] a):
+    if a.shape[0] == 0:
+        return ConstDoubles(NULL, 0)
+    return ConstDoubles(&a[0], a.shape[0])
+
+
+cdef Doubles _mdoubles(double[::1] a):
+    if a.shape[0] == 0:
+        return Doubles(NULL, 0)
+    return Doubles(&a[0], a.shape[0])
+
+
+cdef ConstBoxes _cboxes(const double[:, ::1] a):
+    if a.shape[0] == 0:
+        return ConstBoxes(NULL, 0)
+    return ConstBoxes(<const _AABB*> &a[0, 0], a.shape[0])
+
+
+cdef Mask _mmask(out):
+    cdef uint8_t[::1] m = out.view(np.uint8)
+    if m.shape[0] == 0:
+        return Mask(NULL, 0)
+    return Mask(&m[0], m.shape[0])
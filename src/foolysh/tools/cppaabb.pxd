@@ -44,5 +44,5 @@ cdef extern from "src/aabb.hpp" namespace "foolysh::tools":
         bint inside(double, double)
         bint overlap(AABB)
         AABB split(Quadrant)
-        AABB split(double, double, Quadrant)
+        AABB split(double, double, Quadrant) except +
         double x, y, hw, hh
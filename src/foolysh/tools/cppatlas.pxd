@@ -0,0 +1,63 @@
+# distutils: language = c++
+"""
+Rectangle packing for texture atlases.
+"""
+
+__author__ = 'Tiziano Bettio'
+__license__ = 'MIT'
+__version__ = '0.1'
+__copyright__ = """Copyright (c) 2020 Tiziano Bettio
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE."""
+
+
+from libcpp cimport bool
+from libcpp.vector cimport vector
+
+cdef extern from "src/atlas.cpp":
+    pass
+
+cdef extern from "src/atlas.hpp" namespace "foolysh::tools":
+    cdef cppclass AtlasRect:
+        int x, y, w, h
+
+    cdef cppclass AtlasEntry:
+        int page
+        AtlasRect rect
+
+    cdef cppclass SkylinePacker:
+        SkylinePacker(const int, const int) except +
+        bool insert(const int, const int, AtlasRect&)
+        void clear()
+        int width()
+        int height()
+        long used_area()
+
+    cdef cppclass TextureAtlas:
+        TextureAtlas(const int, const int, const int) except +
+        bool insert(const long, const int, const int, AtlasEntry&) except +
+        bool remove(const long)
+        bool find(const long, AtlasEntry&)
+        vector[long] evict_page(const int) except +
+        void clear()
+        int page_size()
+        int page_count()
+        int max_pages()
+        size_t size()
+        double occupancy(const int) except +
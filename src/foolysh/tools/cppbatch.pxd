@@ -0,0 +1,80 @@
+# distutils: language = c++
+"""
+Batch kernels for contiguous arrays of points and boxes.
+"""
+
+__author__ = 'Tiziano Bettio'
+__license__ = 'MIT'
+__version__ = '0.1'
+__copyright__ = """Copyright (c) 2020 Tiziano Bettio
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE."""
+
+
+from libc.stdint cimport uint8_t
+
+from .cppaabb cimport AABB
+
+cdef extern from "src/batch.cpp":
+    pass
+
+cdef extern from "src/vec2t.hpp" namespace "foolysh::tools":
+    cdef cppclass Vec2d:
+        double x, y
+
+cdef extern from "src/batch.hpp" namespace "foolysh::tools::batch":
+    cdef enum SimdLevel "foolysh::tools::batch::SimdLevel":
+        SCALAR,
+        AVX
+
+    cdef cppclass ConstPoints "foolysh::tools::batch::Span<const foolysh::tools::Vec2d>":
+        ConstPoints()
+        ConstPoints(const Vec2d*, size_t)
+
+    cdef cppclass Points "foolysh::tools::batch::Span<foolysh::tools::Vec2d>":
+        Points()
+        Points(Vec2d*, size_t)
+
+    cdef cppclass ConstDoubles "foolysh::tools::batch::Span<const double>":
+        ConstDoubles()
+        ConstDoubles(const double*, size_t)
+
+    cdef cppclass Doubles "foolysh::tools::batch::Span<double>":
+        Doubles()
+        Doubles(double*, size_t)
+
+    cdef cppclass ConstBoxes "foolysh::tools::batch::Span<const foolysh::tools::AABB>":
+        ConstBoxes()
+        ConstBoxes(const AABB*, size_t)
+
+    cdef cppclass Mask "foolysh::tools::batch::Span<uint8_t>":
+        Mask()
+        Mask(uint8_t*, size_t)
+
+    SimdLevel simd_level()
+    void set_simd_level(SimdLevel)
+    void add(ConstPoints, ConstPoints, Points) except +
+    void scale(ConstPoints, double, Points) except +
+    void rotate(ConstPoints, double, const Vec2d&, Points, bint) except +
+    void normalize(ConstPoints, Points) except +
+    void lerp(ConstPoints, ConstPoints, double, Points) except +
+    void sin_cos(ConstDoubles, Doubles, Doubles) except +
+    size_t overlap(ConstBoxes, const AABB&, Mask) except +
+    size_t contains(ConstBoxes, const Vec2d&, Mask) except +
+    AABB bounds_union(ConstBoxes) except +
@@ -0,0 +1,51 @@
+# distutils: language = c++
+"""
+Native RGBA image resampling.
+"""
+
+__author__ = 'Tiziano Bettio'
+__license__ = 'MIT'
+__version__ = '0.1'
+__copyright__ = """Copyright (c) 2020 Tiziano Bettio
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE."""
+
+
+from libc.stdint cimport uint8_t
+
+cdef extern from "src/resample.cpp":
+    pass
+
+cdef extern from "src/resample.hpp" namespace "foolysh::tools::resample" nogil:
+    cdef enum Filter "foolysh::tools::resample::Filter":
+        BOX,
+        BILINEAR,
+        BICUBIC,
+        LANCZOS
+
+    cdef cppclass ConstPixels "foolysh::tools::resample::Span<const uint8_t>":
+        ConstPixels()
+        ConstPixels(const uint8_t*, size_t)
+
+    cdef cppclass Pixels "foolysh::tools::resample::Span<uint8_t>":
+        Pixels()
+        Pixels(uint8_t*, size_t)
+
+    void resize(ConstPixels, const int, const int, Pixels, const int,
+                const int, const Filter, const int) except +
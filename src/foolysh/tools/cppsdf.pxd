@@ -0,0 +1,58 @@
+# distutils: language = c++
+"""
+Native SDF shape rasterizer.
+"""
+
+__author__ = 'Tiziano Bettio'
+__license__ = 'MIT'
+__version__ = '0.1'
+__copyright__ = """Copyright (c) 2020 Tiziano Bettio
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE."""
+
+
+from libc.stdint cimport uint8_t
+
+cdef extern from "src/batch.hpp" namespace "foolysh::tools::batch":
+    cdef enum SimdLevel "foolysh::tools::batch::SimdLevel":
+        SCALAR,
+        AVX
+
+cdef extern from "src/sdf.cpp":
+    pass
+
+cdef extern from "src/sdf.hpp" namespace "foolysh::tools::sdf":
+    cdef cppclass Pixels "foolysh::tools::sdf::Span<uint8_t>":
+        Pixels()
+        Pixels(uint8_t*, size_t)
+
+    cdef cppclass Rgba:
+        uint8_t r, g, b, a
+
+    cdef cppclass Style:
+        Rgba fill
+        Rgba border
+        double border_thickness
+        bint premultiplied
+
+    SimdLevel simd_level()
+    void set_simd_level(SimdLevel)
+    void box(Pixels, const int, const int, const double, const Style&,
+             const int) except +
+    void circle(Pixels, const int, const Style&, const int) except +
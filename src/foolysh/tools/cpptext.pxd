@@ -0,0 +1,94 @@
+# distutils: language = c++
+"""
+Glyph storage and text layout.
+"""
+
+__author__ = 'Tiziano Bettio'
+__license__ = 'MIT'
+__version__ = '0.1'
+__copyright__ = """Copyright (c) 2020 Tiziano Bettio
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE."""
+
+
+from libc.stdint cimport uint8_t, uint32_t
+from libcpp.vector cimport vector
+
+cdef extern from "src/sdf.hpp" namespace "foolysh::tools::sdf":
+    cdef cppclass Rgba:
+        uint8_t r, g, b, a
+
+cdef extern from "src/atlas.cpp":
+    pass
+
+cdef extern from "src/text.cpp":
+    pass
+
+cdef extern from "src/text.hpp" namespace "foolysh::tools::text":
+    cdef enum Align "foolysh::tools::text::Align":
+        LEFT,
+        CENTER,
+        RIGHT
+
+    cdef cppclass ConstBytes "foolysh::tools::text::Span<const uint8_t>":
+        ConstBytes()
+        ConstBytes(const uint8_t*, size_t)
+
+    cdef cppclass Bytes "foolysh::tools::text::Span<uint8_t>":
+        Bytes()
+        Bytes(uint8_t*, size_t)
+
+    cdef cppclass GlyphMetrics:
+        double advance
+        int x, y, w, h
+
+    cdef cppclass TextLayout:
+        double width, height
+
+    cdef cppclass SdfFont:
+        SdfFont(const int, const int, const int) except +
+        void set_metrics(const int, const int)
+        void add_glyph(const uint32_t, const GlyphMetrics&,
+                       ConstBytes) except +
+        bint has_glyph(const uint32_t)
+        vector[uint32_t] missing(const vector[uint32_t]&)
+        TextLayout layout(const vector[uint32_t]&, const double, const double,
+                          const Align, const double)
+        void render(const TextLayout&, Bytes, const int, const int,
+                    const Rgba&) except +
+        int size()
+        int spread()
+        int atlas_size()
+        int atlas_height()
+        size_t glyph_count()
+
+    cdef cppclass GlyphCache:
+        GlyphCache(const int) except +
+        void set_metrics(const int, const int)
+        void add_glyph(const uint32_t, const GlyphMetrics&,
+                       ConstBytes) except +
+        bint has_glyph(const uint32_t)
+        vector[uint32_t] missing(const vector[uint32_t]&)
+        TextLayout layout(const vector[uint32_t]&, const double, const Align,
+                          const double)
+        void render(const TextLayout&, Bytes, const int, const int,
+                    const Rgba&) except +
+        int size()
+        size_t glyph_count()
+        size_t bytes()
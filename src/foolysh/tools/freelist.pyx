@@ -0,0 +1,79 @@
+# distutils: language = c++
+"""
+Python access to the native lock-free free list.
+
+:class:`ConcurrentFreeList` wraps the list that hands out stable indices to
+several threads. Its ``insert`` and ``erase`` release the GIL, so
+Python threads use the list concurrently.
+"""
+
+from cython.operator cimport dereference as deref
+from libcpp cimport bool
+from libcpp.memory cimport unique_ptr
+
+from .cppfreelist cimport ConcurrentFreeList as _ConcurrentFreeList
+
+__author__ = 'Tiziano Bettio'
+__license__ = 'MIT'
+__version__ = '0.1'
+__copyright__ = """Copyright (c) 2020 Tiziano Bettio
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE."""
+
+
+cdef class ConcurrentFreeList:
+    """
+    Lock-free free list of ``int`` values with stable indices.
+    """
+    cdef unique_ptr[_ConcurrentFreeList[long]] thisptr
+
+    def __cinit__(self):
+        self.thisptr.reset(new _ConcurrentFreeList[long]())
+
+    def insert(self, long value):
+        """
+        Returns:
+            ``int`` -> index of ``value``, released indices are reused first.
+        """
+        cdef int n
+        with nogil:
+            n = deref(self.thisptr).insert(value)
+        return n
+
+    def erase(self, int n):
+        """Release index ``n``."""
+        cdef bool released
+        with nogil:
+            released = deref(self.thisptr).erase(n)
+        if not released:
+            raise IndexError('Invalid index')
+
+    def active(self, int n):
+        """``bool`` -> whether index ``n`` holds a value."""
+        return deref(self.thisptr).active(n)
+
+    @property
+    def range(self):
+        """``int`` -> upper bound of the indices handed out so far."""
+        return deref(self.thisptr).range()
+
+    def __getitem__(self, int n):
+        if not deref(self.thisptr).active(n):
+            raise IndexError('Invalid index')
+        return deref(self.thisptr)[n]
@@ -0,0 +1,162 @@
+"""
+Provides a raw, memory mappable pixel cache format.
+
+A cache file starts with a header padded to ``PAGE_SIZE`` bytes, followed by
+the RGBA8 rows of the image. Uncompressed files are mapped read only and the
+pixels are handed to SDL straight from the mapping, so loading costs little
+more than the texture upload. With the optional ``lz4`` package installed,
+files can be LZ4 frame compressed instead, trading decompression time for disk
+space.
+
+Header (little endian): ``b'FRAW'``, ``uint16`` version, ``uint16`` flags,
+``uint32`` width, height and pitch, ``uint64`` payload size.
+"""
+
+import ctypes
+import mmap
+import os
+import struct
+import threading
+from typing import Optional
+from typing import Tuple
+
+from PIL import Image
+
+try:
+    import lz4.frame as lz4frame
+except ImportError:  # pragma: no cover
+    lz4frame = None
+
+__author__ = 'Tiziano Bettio'
+__license__ = 'MIT'
+__version__ = '0.1'
+__copyright__ = """Copyright (c) 2020 Tiziano Bettio
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE."""
+
+MAGIC = b'FRAW'
+VERSION = 1
+FLAG_LZ4 = 1
+PAGE_SIZE = 4096
+_HEADER = struct.Struct('<4sHHIIIQ')
+
+
+def lz4_available():
+    # type: () -> bool
+    """Whether LZ4 compressed files can be written and read."""
+    return lz4frame is not None
+
+
+def write(path, image, compress=False):
+    # type: (str, Image.Image, Optional[bool]) -> None
+    """
+    Write ``image`` as raw RGBA8 cache file to ``path``. The file is replaced
+    atomically, so concurrent readers never see a partial file. ``compress``
+    is ignored if LZ4 is not available.
+    """
+    if image.mode != 'RGBA':
+        image = image.convert('RGBA')
+    width, height = image.size
+    payload = image.tobytes()
+    flags = 0
+    if compress and lz4frame is not None:
+        payload = lz4frame.compress(payload)
+        flags |= FLAG_LZ4
+    header = _HEADER.pack(MAGIC, VERSION, flags, width, height, width * 4,
+                          len(payload))
+    tmp = f'{path}.{os.getpid()}.{threading.get_ident()}.tmp'
+    with open(tmp, 'wb') as fhandle:
+        fhandle.write(header.ljust(PAGE_SIZE, b'\0'))
+        fhandle.write(payload)
+    os.replace(tmp, path)
+
+
+class RawImage:
+    """
+    Pixels of a raw cache file. Uncompressed files stay mapped until
+    :meth:`close`, :attr:`address` points to the first row.
+
+    Args:
+        path: ``str`` -> path of a file written by :func:`write`.
+    """
+    def __init__(self, path):
+        # type: (str) -> None
+        self._mmap = None
+        self._buffer = None
+        with open(path, 'rb') as fhandle:
+            header = fhandle.read(_HEADER.size)
+            if len(header) < _HEADER.size:
+                raise ValueError(f'Truncated raw cache file "{path}".')
+            magic, version, flags, width, height, pitch, length = \
+                _HEADER.unpack(header)
+            if magic != MAGIC or version != VERSION:
+                raise ValueError(f'Not a raw cache file "{path}".')
+            if flags & FLAG_LZ4:
+                if lz4frame is None:
+                    raise RuntimeError('LZ4 compressed raw cache requires the '
+                                       'lz4 package.')
+                fhandle.seek(PAGE_SIZE)
+                data = bytearray(lz4frame.decompress(fhandle.read(length)))
+            else:
+                # Private mapping, pages are only copied if written to
+                self._mmap = mmap.mmap(fhandle.fileno(), 0,
+                                       access=mmap.ACCESS_COPY)
+                if hasattr(self._mmap, 'madvise'):
+                    self._mmap.madvise(mmap.MADV_WILLNEED)
+                data = memoryview(self._mmap)[PAGE_SIZE:PAGE_SIZE + length]
+        self._buffer = data
+        if len(data) < pitch * height:
+            self.close()
+            raise ValueError(f'Truncated raw cache file "{path}".')
+        self.size = width, height  # type: Tuple[int, int]
+        self.pitch = pitch
+        self.mode = 'RGBA'
+
+    @property
+    def pixels(self):
+        """Writable buffer of the RGBA8 rows."""
+        return self._buffer
+
+    @property
+    def address(self):
+        # type: () -> int
+        """Memory address of the first row."""
+        return ctypes.addressof(ctypes.c_char.from_buffer(self._buffer))
+
+    def to_image(self):
+        # type: () -> Image.Image
+        """Copy of the pixels as PIL ``Image``."""
+        return Image.frombytes('RGBA', self.size, bytes(self._buffer), 'raw',
+                               'RGBA', self.pitch)
+
+    def close(self):
+        # type: () -> None
+        """Release the mapping, :attr:`pixels` must not be used afterwards."""
+        if isinstance(self._buffer, memoryview):
+            self._buffer.release()
+        self._buffer = None
+        if self._mmap is not None:
+            self._mmap.close()
+            self._mmap = None
+
+
+def read(path):
+    # type: (str) -> RawImage
+    """Map or decompress the raw cache file at ``path``."""
+    return RawImage(path)
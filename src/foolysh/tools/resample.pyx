@@ -0,0 +1,148 @@
+# distutils: language = c++
+"""
+Native RGBA image resampling, see :func:`resize` and :class:`MipChain`.
+
+Images are filtered separately in x and y on premultiplied colors, using
+SSE2 where available and several threads for large images.
+"""
+
+from libc.stdint cimport uint8_t
+
+from . cimport cppresample
+from .cppresample cimport ConstPixels, Pixels, Filter
+
+import threading
+
+import numpy as np
+
+__author__ = 'Tiziano Bettio'
+__license__ = 'MIT'
+__version__ = '0.1'
+__copyright__ = """Copyright (c) 2020 Tiziano Bettio
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE."""
+
+FILTERS = {
+    'box': cppresample.BOX,
+    'bilinear': cppresample.BILINEAR,
+    'bicubic': cppresample.BICUBIC,
+    'lanczos': cppresample.LANCZOS
+}
+
+
+def resize(image, size, method='bicubic', int threads=0):
+    """
+    Resample an RGBA image. The GIL is released while resampling.
+
+    Args:
+        image: ``np.ndarray`` of shape (height, width, 4) and dtype ``uint8``
+            or ``PIL.Image.Image`` (converted to RGBA).
+        size: ``Tuple[int, int]`` -> width and height of the result.
+        method: ``str`` one of ``'box'``, ``'bilinear'``, ``'bicubic'`` or
+            ``'lanczos'``.
+        threads: ``int`` -> maximum number of threads, 0 = one per CPU.
+
+    Returns:
+        ``np.ndarray`` of shape (`size[1]`, `size[0]`, 4) and dtype ``uint8``.
+    """
+    if method not in FILTERS:
+        raise ValueError(f'Unknown resampling method "{method}".')
+    cdef Filter f = FILTERS[method]
+    cdef int dw, dh
+    dw, dh = size
+    if dw <= 0 or dh <= 0:
+        raise ValueError('Expected positive size.')
+    src = _rgba(image)
+    cdef int sw = src.shape[1], sh = src.shape[0]
+    out = np.empty((dh, dw, 4), dtype=np.uint8)
+    cdef const uint8_t[::1] s = src.reshape(-1)
+    cdef uint8_t[::1] d = out.reshape(-1)
+    with nogil:
+        cppresample.resize(ConstPixels(&s[0], s.shape[0]), sw, sh,
+                           Pixels(&d[0], d.shape[0]), dw, dh, f, threads)
+    return out
+
+
+class MipChain:
+    """
+    Successive halvings of an image, to scale it to many sizes without
+    filtering the full resolution image every time. Levels are created on
+    first use, :meth:`resize` starts from the smallest level that is at least
+    twice the requested size. Thread safe.
+
+    Args:
+        image: see :func:`resize`.
+        threads: ``int`` -> maximum number of threads, 0 = one per CPU.
+    """
+    def __init__(self, image, threads=0):
+        self._levels = [_rgba(image)]
+        self._threads = threads
+        self._lock = threading.Lock()
+
+    @property
+    def size(self):
+        """Width and height of the original image."""
+        height, width = self._levels[0].shape[:2]
+        return width, height
+
+    @property
+    def nbytes(self):
+        """Memory used by the levels created so far."""
+        with self._lock:
+            return sum(level.nbytes for level in self._levels)
+
+    def level(self, n):
+        """
+        Returns:
+            ``np.ndarray`` of the image halved ``n`` times, the 1x1 level for
+            larger ``n``.
+        """
+        with self._lock:
+            while len(self._levels) <= n:
+                height, width = self._levels[-1].shape[:2]
+                if width == 1 and height == 1:
+                    break
+                self._levels.append(
+                    resize(self._levels[-1], (max(width // 2, 1),
+                                              max(height // 2, 1)),
+                           'box', self._threads))
+            return self._levels[min(n, len(self._levels) - 1)]
+
+    def resize(self, size, method='bicubic'):
+        """
+        Resample the image to ``size``, see :func:`resize`.
+        """
+        width, height = self.size
+        n = 0
+        while width >> (n + 1) >= size[0] * 2 \
+                and height >> (n + 1) >= size[1] * 2:
+            n += 1
+        return resize(self.level(n), size, method, self._threads)
+
+
+def _rgba(image):
+    if not isinstance(image, np.ndarray):
+        if image.mode != 'RGBA':
+            image = image.convert('RGBA')
+        image = np.asarray(image)
+    if image.ndim != 3 or image.shape[2] != 4 or image.dtype != np.uint8:
+        raise ValueError('Expected an RGBA8 image of shape (h, w, 4).')
+    if image.shape[0] == 0 or image.shape[1] == 0:
+        raise ValueError('Expected a non empty image.')
+    return np.ascontiguousarray(image)
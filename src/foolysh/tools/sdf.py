@@ -1,6 +1,10 @@
 """
 Provides functions to generate signed distance fields and Pillow Image objects
 of such.
+
+The ``*_im`` functions rasterize natively through
+:mod:`~foolysh.tools.sdfraster`, the NumPy distance fields are kept for custom
+use.
 """
 
 from typing import Optional
@@ -10,6 +14,8 @@ from typing import Union
 from PIL import Image
 import numpy as np
 
+from . import sdfraster
+
 __author__ = 'Tiziano Bettio'
 __license__ = 'MIT'
 __version__ = '0.1'
@@ -87,47 +93,23 @@ def framed_box_im(width: int, height: int, corner_radius: Optional[int] = 0,
             frame. Values in [0, 255].
         border_color: ``Optional[Tuple[int, int, int]]`` -> RGB color of the
             border. Values in [0, 255].
-        multi_sampling: ``Optional[int]`` -> multiplier for the distance_field
-            resolution.
+        multi_sampling: ``Optional[int]`` -> kept for compatibility, edges
+            are anti-aliased analytically.
         alpha: ``Optional[int]`` -> max alpha of the applied color.
 
     Returns:
         ``PIL.Image.Image`` of size (`width` x `height`) in mode ``RGBA``.
     """
-    # pylint: disable=too-many-arguments,too-many-locals
+    # pylint: disable=too-many-arguments
     if multi_sampling < 1:
         raise ValueError('Expected positive, non zero value for '
                          'multi_sampling.')
-    target_res = width, height
-    sdf_res = width * multi_sampling, height * multi_sampling
-    corner_radius *= multi_sampling
-    if border_thickness == 0:
-        frame = box(*sdf_res, corner_radius)
-        img = sdf2image(frame, frame_color, alpha)
-        if multi_sampling > 1:
-            return img.resize(target_res, Image.BICUBIC)
-        return img
-
-    border_thickness = (border_thickness or (max(sdf_res) // 100))
-    border_thickness *= multi_sampling
-    half_thickness = max(border_thickness - 1, 1) * 2
-
-    border = box(*sdf_res, corner_radius, border_thickness)
-    frame = box(
-        sdf_res[0] - half_thickness,
-        sdf_res[1] - half_thickness,
-        corner_radius - half_thickness
-    )
-
-    border_im = sdf2image(border, border_color, alpha)
-    frame_im = sdf2image(frame, frame_color, alpha)
-
-    img = Image.new('RGBA', sdf_res)
-    img.paste(frame_im, (half_thickness // 2, half_thickness // 2), frame_im)
-    img.alpha_composite(border_im)
-    if multi_sampling > 1:
-        return img.resize(target_res, Image.BICUBIC)
-    return img
+    if border_thickness != 0:
+        border_thickness = border_thickness or max(width, height) // 100
+    arr = sdfraster.box(width, height, corner_radius, border_thickness,
+                        tuple(frame_color) + (alpha, ),
+                        tuple(border_color) + (alpha, ))
+    return Image.fromarray(arr, 'RGBA')
 
 
 def framed_box_str(width: NumT, height: NumT, corner_radius: NumT = 0,
@@ -219,8 +201,8 @@ def framed_circle_im(radius: int, border_thickness: Optional[int] = None,
             frame. Values in [0, 255].
         border_color: ``Optional[Tuple[int, int, int]]`` -> RGB color of the
             border. Values in [0, 255].
-        multi_sampling: ``Optional[int]`` -> multiplier for the distance_field
-            resolution.
+        multi_sampling: ``Optional[int]`` -> kept for compatibility, edges
+            are anti-aliased analytically.
         alpha: ``Optional[int]`` -> max alpha of the applied color.
 
     Returns:
@@ -229,30 +211,12 @@ def framed_circle_im(radius: int, border_thickness: Optional[int] = None,
     if multi_sampling < 1:
         raise ValueError('Expected positive, non zero value for '
                          'multi_sampling.')
-    target_res = (radius * 2, ) * 2
-    sdf_res = (radius * 2 * multi_sampling, ) * 2
-    if border_thickness == 0:
-        frame = circle(radius * multi_sampling)
-        img = sdf2image(frame, frame_color, alpha)
-        if multi_sampling > 1:
-            return img.resize(target_res, Image.BICUBIC)
-        return img
-
-    border_thickness = (border_thickness or (radius // 50)) * multi_sampling
-    half_t = max(border_thickness - 1, 1)
-    radius = radius * multi_sampling
-    border = circle(radius, border_thickness)
-    frame = circle(radius - half_t)
-
-    frame_im = sdf2image(frame, frame_color, alpha)
-    border_im = sdf2image(border, border_color, alpha)
-
-    img = Image.new('RGBA', sdf_res)
-    img.paste(frame_im, (half_t, half_t), frame_im)
-    img.alpha_composite(border_im)
-    if multi_sampling > 1:
-        return img.resize(target_res, Image.BICUBIC)
-    return img
+    if border_thickness != 0:
+        border_thickness = border_thickness or radius // 50
+    arr = sdfraster.circle(radius, border_thickness,
+                           tuple(frame_color) + (alpha, ),
+                           tuple(border_color) + (alpha, ))
+    return Image.fromarray(arr, 'RGBA')
 
 
 def framed_circle_str(radius: NumT, border_thickness: Optional[NumT] = None,
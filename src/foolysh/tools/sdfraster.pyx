@@ -0,0 +1,137 @@
+# distutils: language = c++
+"""
+Native rasterizer for SDF shapes.
+
+Boxes, rounded boxes, circles and their frames are written straight into RGBA8
+pixels with analytic anti-aliasing, which makes supersampling unnecessary.
+Large images are split between threads, the distance pass uses AVX when the
+CPU supports it.
+"""
+
+from libc.stdint cimport uint8_t
+
+from . cimport cppsdf
+from .cppsdf cimport Pixels, Style
+
+import numpy as np
+
+__author__ = 'Tiziano Bettio'
+__license__ = 'MIT'
+__version__ = '0.1'
+__copyright__ = """Copyright (c) 2020 Tiziano Bettio
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE."""
+
+_LEVELS = {'scalar': cppsdf.SCALAR, 'avx': cppsdf.AVX}
+
+
+def simd_level():
+    """
+    Returns:
+        ``str`` name of the instruction set used by the distance pass.
+    """
+    cdef cppsdf.SimdLevel level = cppsdf.simd_level()
+    for k, v in _LEVELS.items():
+        if v == level:
+            return k
+    return 'scalar'
+
+
+def set_simd_level(level):
+    """
+    Select the instruction set used by the distance pass, capped at what the
+    CPU supports. Mainly useful for testing and benchmarking.
+
+    Args:
+        level: ``str`` one of ``'scalar'`` or ``'avx'``.
+    """
+    if level not in _LEVELS:
+        raise ValueError(f'Unknown SIMD level "{level}".')
+    cppsdf.set_simd_level(_LEVELS[level])
+
+
+def box(int width, int height, double corner_radius=0.0,
+        double border_thickness=0.0, fill=(255, 255, 255, 255),
+        border=(255, 255, 255, 255), bint premultiplied=False,
+        int threads=0):
+    """
+    Rasterize a box.
+
+    Args:
+        width: ``int`` -> width in pixel.
+        height: ``int`` -> height in pixel.
+        corner_radius: ``float`` -> corner radius in pixel.
+        border_thickness: ``float`` -> thickness of the border in pixel, 0 for
+            no border.
+        fill: ``Tuple[int, int, int, int]`` -> RGBA color of the fill.
+        border: ``Tuple[int, int, int, int]`` -> RGBA color of the border.
+        premultiplied: ``bool`` -> whether to premultiply color by alpha.
+        threads: ``int`` -> maximum number of threads, 0 = one per CPU.
+
+    Returns:
+        ``np.ndarray`` of shape (`height`, `width`, 4) and dtype ``uint8``.
+    """
+    out = np.empty((height, width, 4), dtype=np.uint8) \
+        if width > 0 and height > 0 else np.empty(0, dtype=np.uint8)
+    cppsdf.box(_pixels(out), width, height, corner_radius,
+               _style(fill, border, border_thickness, premultiplied), threads)
+    return out
+
+
+def circle(int radius, double border_thickness=0.0,
+           fill=(255, 255, 255, 255), border=(255, 255, 255, 255),
+           bint premultiplied=False, int threads=0):
+    """
+    Rasterize a circle.
+
+    Args:
+        radius: ``int`` -> radius in pixel.
+        border_thickness: ``float`` -> thickness of the border in pixel, 0 for
+            no border.
+        fill: ``Tuple[int, int, int, int]`` -> RGBA color of the fill.
+        border: ``Tuple[int, int, int, int]`` -> RGBA color of the border.
+        premultiplied: ``bool`` -> whether to premultiply color by alpha.
+        threads: ``int`` -> maximum number of threads, 0 = one per CPU.
+
+    Returns:
+        ``np.ndarray`` of shape (`2 * radius`, `2 * radius`, 4) and dtype
+        ``uint8``.
+    """
+    out = np.empty((radius * 2, radius * 2, 4), dtype=np.uint8) \
+        if radius > 0 else np.empty(0, dtype=np.uint8)
+    cppsdf.circle(_pixels(out), radius,
+                  _style(fill, border, border_thickness, premultiplied),
+                  threads)
+    return out
+
+
+cdef Style _style(fill, border, double border_thickness, bint premultiplied):
+    cdef Style s
+    s.fill.r, s.fill.g, s.fill.b, s.fill.a = fill
+    s.border.r, s.border.g, s.border.b, s.border.a = border
+    s.border_thickness = border_thickness
+    s.premultiplied = premultiplied
+    return s
+
+
+cdef Pixels _pixels(out):
+    cdef uint8_t[::1] flat = out.reshape(-1)
+    if flat.shape[0] == 0:
+        return Pixels(NULL, 0)
+    return Pixels(&flat[0], flat.shape[0])
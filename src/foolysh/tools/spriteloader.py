@@ -1,24 +1,37 @@
 """
 Provides the SpriteLoader class, that handles loading and caching of assets.
 """
+from collections import OrderedDict
+from concurrent.futures import ThreadPoolExecutor
+import ctypes
 import pathlib
 import hashlib
-from math import ceil
 import os
+import threading
+import warnings
 from typing import Optional
 from typing import Tuple
+from typing import Union
 
 from PIL import Image
-from PIL import ImageDraw
 from PIL import ImageFont
 from sdl2.ext import SpriteFactory
 from sdl2.ext import TextureSprite
+from sdl2 import blendmode
 from sdl2 import endian
+from sdl2 import rect
+from sdl2 import render
 from sdl2 import surface
 from sdl2 import pixels
 from sdl2.ext import SDLError
 
+from . import archive as asset_archive
+from . import atlas
+from . import rawcache
+from . import resample
 from . import sdf
+from . import text as textlayout
+from . import texturecache
 from . import vec2
 from .common import SCALE
 
@@ -46,6 +59,15 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE."""
 
 COLOR = Tuple[int, int, int, int]
+SDF_FONT_SIZE = 64
+MIP_CHAINS = 8
+# PIL resize filters with a native equivalent in foolysh.tools.resample
+_NATIVE_FILTERS = {
+    Image.BOX: 'box',
+    Image.BILINEAR: 'bilinear',
+    Image.BICUBIC: 'bicubic',
+    Image.LANCZOS: 'lanczos'
+}
 
 
 # This function is adapted directly from the PySDL2 package, to perform the
@@ -129,6 +151,41 @@ def _image2sprite(image, factory):
     return factory.from_surface(imgsurface, free=True)
 
 
+def _raw2sprite(raw, factory):
+    """Sprite of a :class:`~foolysh.tools.rawcache.RawImage`, without copy."""
+    if endian.SDL_BYTEORDER == endian.SDL_LIL_ENDIAN:
+        masks = 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000
+    else:
+        masks = 0xFF000000, 0x00FF0000, 0x0000FF00, 0x000000FF
+    imgsurface = surface.SDL_CreateRGBSurfaceFrom(raw.address, *raw.size, 32,
+                                                  raw.pitch, *masks)
+    if not imgsurface:
+        raise SDLError()
+    return factory.from_surface(imgsurface.contents, free=True)
+
+
+def _decode(asset, scale):
+    """Cache path and fully decoded image of ``asset`` at ``scale``."""
+    return asset.load(scale)
+
+
+class AtlasSprite:
+    """
+    Region ``src`` (``x, y, w, h``) of the atlas ``page`` texture of size
+    ``tex_size``. Provides the ``texture``, ``size`` and ``flip`` attributes of
+    a ``TextureSprite``.
+    """
+    __slots__ = ('texture', 'page', 'src', 'tex_size', 'size', 'flip')
+
+    def __init__(self, texture, page, src, tex_size):
+        self.texture = texture
+        self.page = page
+        self.src = src
+        self.tex_size = tex_size
+        self.size = src[2], src[3]
+        self.flip = 0
+
+
 def parse_sdf_str(sdf_str):
     """
     Parses SDF strings to get SDF type and keyword arguments for the function
@@ -208,18 +265,67 @@ class SpriteLoader:
     the cache directory can be specified, otherwise a 'cache' directory,
     relative to ``os.getcwd()`` will be used. The cache_dir will be created if
     absent on init.
+
+    With ``atlas_size > 0``, images, SDFs and text up to half the page size are
+    packed into shared ``atlas_size`` x ``atlas_size`` textures and returned as
+    :class:`AtlasSprite`. When all ``atlas_pages`` are full, the oldest page is
+    evicted and :attr:`atlas_generation` is incremented, previously returned
+    sprites of that page must then be loaded again.
+
+    Text is composed natively from glyph bitmaps cached per font and size, so
+    only glyphs that were never used before are rasterized with PIL. With
+    ``sdf_text=True``, fonts are instead rasterized once at ``SDF_FONT_SIZE``
+    into signed distance field glyph atlases and text of any size is rendered
+    from those.
+
+    Loaded sprites are kept in a :class:`~foolysh.tools.texturecache.
+    TextureCache`. With ``texture_budget > 0`` (bytes), :meth:`trim` evicts
+    the least recently used sprites that are not pinned, until the textures
+    fit the budget. Sprites packed into the atlas don't count towards the
+    budget, its memory is bounded by ``atlas_pages``.
+
+    With ``async_workers > 0``, :meth:`load_image_async` decodes and resizes
+    image assets on worker threads (Pillow releases the GIL while doing so).
+    Finished images are turned into textures on the calling thread by
+    :meth:`upload_pending`, at most ``upload_budget`` bytes per call.
+
+    With ``raw_cache=True``, scaled images are cached in the mappable format
+    of :mod:`~foolysh.tools.rawcache` instead of PNG and uploaded straight from
+    the mapping, ``raw_compress`` LZ4 compresses them if available.
+
+    With ``archive`` set to a file created by :func:`foolysh.tools.archive.
+    pack`, assets are read from the archive and its index, instead of
+    scanning and opening every file in ``asset_dir`` on start up. Paths
+    missing from the archive are still looked up in ``asset_dir``.
+
+    Scaled variants are resampled natively from a :class:`~foolysh.tools.
+    resample.MipChain` of the original when ``resize_type`` is one of
+    ``Image.BOX``, ``Image.BILINEAR``, ``Image.BICUBIC`` or ``Image.LANCZOS``,
+    other filters fall back to PIL. The chains of the ``MIP_CHAINS`` most
+    recently scaled assets are kept, so the original is decoded only once
+    when an asset is needed at several sizes.
     """
+    # pylint: disable=too-many-instance-attributes
     def __init__(
             self,
             factory,                    # type: SpriteFactory
             asset_dir,                  # type: str
             cache_dir=None,             # type: Optional[str]
-            resize_type=Image.BICUBIC   # type: Optional[int]
+            resize_type=Image.BICUBIC,  # type: Optional[int]
+            atlas_size=0,               # type: Optional[int]
+            atlas_pages=4,              # type: Optional[int]
+            sdf_text=False,             # type: Optional[bool]
+            texture_budget=0,           # type: Optional[int]
+            async_workers=0,            # type: Optional[int]
+            upload_budget=4 << 20,      # type: Optional[int]
+            raw_cache=False,            # type: Optional[bool]
+            raw_compress=False,         # type: Optional[bool]
+            archive=None                # type: Optional[str]
     ):
         # type: (...) -> None
         if not isinstance(factory, SpriteFactory):
             raise TypeError('expected sdl2.ext.SpriteFactory for factory')
-        if not os.path.isdir(asset_dir):
+        if archive is None and not os.path.isdir(asset_dir):
             raise NotADirectoryError(f'Invalid asset_dir')
         self.factory = factory
         self.asset_dir = asset_dir
@@ -228,11 +334,41 @@ class SpriteLoader:
             os.makedirs(self.cache_dir)
         self.resize_type = resize_type
         self._assets = {}
-        self._sprite_cache = {}
+        self._sprite_cache = texturecache.TextureCache(texture_budget)
         self._font_cache = {}
+        self._glyph_caches = {}
+        self._sdf_fonts = {}
+        self.sdf_text = sdf_text
+        self._atlas = None
+        if atlas_size > 0:
+            self._atlas = atlas.Atlas(atlas_size, atlas_pages)
+        self._atlas_textures = []
+        self._evict_next = 0
+        self.atlas_generation = 0
+        self._executor = None
+        if async_workers > 0:
+            self._executor = ThreadPoolExecutor(async_workers)
+        self._jobs = {}
+        self._failed = {}
+        self.upload_budget = upload_budget
+        self.raw_cache = raw_cache
+        self.raw_compress = raw_compress
+        self.archive = None
+        if archive is not None:
+            self.archive = asset_archive.Archive(archive)
+        self._mip_chains = OrderedDict()
+        self._mip_lock = threading.Lock()
         self._refresh_assets()
 
     def _refresh_assets(self):
+        if self.archive is not None:
+            self._assets = {}
+            for k, entry in self.archive.entries.items():
+                if entry.format == 'font':
+                    self._assets[k] = k
+                else:
+                    self._assets[k] = Asset(k, self, entry.size)
+            return
         paths = pathlib.Path(self.asset_dir).glob('**/*.*')
         paths = [str(f) for f in paths]
         paths = [
@@ -246,61 +382,136 @@ class SpriteLoader:
                 self._assets[k] = os.path.join(self.asset_dir, k)
                 continue
             try:
-                _ = Image.open(os.path.join(self.asset_dir, k))
+                with Image.open(os.path.join(self.asset_dir, k)) as img:
+                    size = img.size
             except IsADirectoryError:
                 continue
             except IOError:
                 continue
-            self._assets[k] = Asset(k, self)
+            self._assets[k] = Asset(k, self, size)
 
     def load_image(self, asset_path: str, scale: SCALE = 1.0,
-                   res: Tuple[int, int] = None, retry: bool = False):
+                   retry: bool = False):
         """
         Loads asset_path at specified scale or generates (if necessary) a SDF
         if `asset_path` starts with "SDF:" (SDF strings are case sensitive!).
+        Tiled images are drawn by repeating this sprite, see
+        :meth:`foolysh.scene.node.DrawList.set_texture`.
         """
-        if res is not None:
-            impath = self._assets[asset_path][scale]
-            k = impath + str(res)
-            if k not in self._sprite_cache:
-                orig = Image.open(impath)
-                img = Image.new(orig.mode, res)
-                for i in range(ceil(res[0] / orig.size[0])):
-                    for j in range(ceil(res[1] / orig.size[1])):
-                        img.paste(orig, (i * orig.size[0], j * orig.size[1]))
-                self._sprite_cache[k] = _image2sprite(img, self.factory)
-            return self._sprite_cache[k]
         if asset_path.startswith('SDF:'):
             return self._load_sdf(asset_path)
         if asset_path in self._assets:
             k = self._assets[asset_path][scale]
-            if k not in self._sprite_cache:
-                self._sprite_cache[k] = _image2sprite(
-                    Image.open(k),
-                    self.factory
-                )
-            return self._sprite_cache[k]
+            sprite = self._sprite_cache.get(k)
+            if sprite is None:
+                sprite = self._make_sprite(k, self._assets[asset_path].load(
+                    scale
+                )[1])
+                self._cache_sprite(k, sprite)
+            return sprite
         elif not retry:
-            self._refresh_assets()
-            return self.load_image(asset_path, scale, res, retry=True)
+            self._find_asset(asset_path)
+            return self.load_image(asset_path, scale, retry=True)
         raise ValueError(f'asset_path must be a valid path relative to '
                          f'"{self.asset_dir}" without leading "/". Got '
                          f'"{asset_path}".')
 
-    def load_text(self, text, font, size, color, align, spacing, multiline):
-        # type: (str, str, int, COLOR, str, int, bool) -> TextureSprite
-        """Load """
+    def load_image_async(self, asset_path: str, scale: SCALE = 1.0):
+        """
+        Like :meth:`load_image` for plain image assets, but returns ``None``
+        and schedules the image to be decoded on a worker thread if it is not
+        loaded yet. Once :meth:`upload_pending` uploaded it, the sprite is
+        returned. Loads synchronously if ``async_workers`` is ``0``. Images
+        that failed to decode are not scheduled again, see :attr:`failed`.
+        """
+        asset = self._assets.get(asset_path)
+        if self._executor is None or asset is None:
+            return self.load_image(asset_path, scale)
+        size = asset.scaled_size(scale)
+        k = asset.cached_path(size)
+        if k is not None:
+            sprite = self._sprite_cache.get(k)
+            if sprite is not None:
+                return sprite
+        job = asset_path, size
+        if job not in self._jobs and job not in self._failed:
+            self._jobs[job] = self._executor.submit(_decode, asset, scale)
+        return None
+
+    def upload_pending(self):
+        """
+        Create textures of images decoded by :meth:`load_image_async`, until
+        ``upload_budget`` bytes were uploaded. Must be called from the thread
+        that owns the renderer. Exceptions raised while decoding are reported
+        as a warning and stored in :attr:`failed`.
+
+        Returns:
+            ``int`` number of uploaded images.
+        """
+        uploaded = 0
+        nbytes = 0
+        for job, future in list(self._jobs.items()):
+            if nbytes >= self.upload_budget:
+                break
+            if not future.done():
+                continue
+            del self._jobs[job]
+            try:
+                k, img = future.result()
+            except Exception as err:  # pylint: disable=broad-except
+                self._failed[job] = err
+                warnings.warn(f'Unable to decode "{job[0]}" at size {job[1]}: '
+                              f'{err!r}')
+                continue
+            if k in self._sprite_cache:
+                if isinstance(img, rawcache.RawImage):
+                    img.close()
+                continue
+            self._cache_sprite(k, self._make_sprite(k, img))
+            nbytes += img.size[0] * img.size[1] * 4
+            uploaded += 1
+        return uploaded
+
+    @property
+    def async_loading(self):
+        """``bool`` -> whether images are decoded on worker threads."""
+        return self._executor is not None
+
+    @property
+    def pending(self):
+        """``int`` -> number of images scheduled or waiting for upload."""
+        return len(self._jobs)
+
+    @property
+    def failed(self):
+        """
+        ``Dict[Tuple[str, Tuple[int, int]], Exception]`` -> exceptions of
+        images that failed to decode on a worker thread, by asset path and
+        size.
+        """
+        return dict(self._failed)
+
+    def load_text(self, text, font, size, color, align, spacing, multiline,
+                  wrap=0):
+        # type: (str, str, int, COLOR, str, int, bool, int) -> TextureSprite
+        """
+        Load a sprite of ``text``. Lines are separated by "\\n" and, if
+        ``wrap`` is positive, broken at spaces to fit ``wrap`` pixel.
+        """
         # pylint: disable=too-many-arguments
         return self._cache_text(text, font, size, color, align, spacing,
-                                multiline)
+                                multiline, wrap)
 
-    def textsize(self, text, font, size, spacing, multiline):
+    def textsize(self, text, font, size, spacing, multiline, wrap=0):
         """Returns the canvas size for the provided arguments."""
+        # pylint: disable=too-many-arguments,unused-argument
         if not text:
             return 0, 0
-        size, _ = self._compute_text_size_pos(text, font, size, spacing,
-                                              multiline)
-        return size
+        sdf_font = self._load_sdf_font(font, text) if self.sdf_text else None
+        if sdf_font is not None:
+            return sdf_font.measure(text, size, spacing, wrap)
+        return self._load_glyph_cache(font, size, text).measure(text, spacing,
+                                                                wrap)
 
     def imagesize(self, asset_path, scale=1.0):
         """Return the image size for a given asset and scale."""
@@ -308,14 +519,46 @@ class SpriteLoader:
             kwargs, _ = parse_sdf_str(asset_path)
             return kwargs['width'], kwargs['height']
         if asset_path in self._assets:
-            k = self._assets[asset_path][scale]
-            if k in self._sprite_cache:
-                return self._sprite_cache[k].size
-            return Image.open(k).size
+            return self._assets[asset_path].scaled_size(scale)
         raise ValueError(f'asset_path must be a valid path relative to '
                          f'"{self.asset_dir}" without leading "/". Got '
                          f'"{asset_path}".')
 
+    def mip_chain(self, asset):
+        # type: (Asset) -> resample.MipChain
+        """
+        Returns:
+            The :class:`~foolysh.tools.resample.MipChain` of ``asset``, created
+            from its original image if it isn't among the ``MIP_CHAINS`` most
+            recently used.
+        """
+        key = asset.relative_path
+        with self._mip_lock:
+            if key in self._mip_chains:
+                self._mip_chains.move_to_end(key)
+                return self._mip_chains[key]
+        chain = resample.MipChain(asset.open())
+        with self._mip_lock:
+            chain = self._mip_chains.setdefault(key, chain)
+            while len(self._mip_chains) > MIP_CHAINS:
+                self._mip_chains.popitem(last=False)
+        return chain
+
+    def _find_asset(self, asset_path):
+        """Look for assets added after start up."""
+        if self.archive is None:
+            self._refresh_assets()
+            return
+        path = os.path.join(self.asset_dir, asset_path)
+        if not os.path.isfile(path):
+            return
+        try:
+            with Image.open(path) as img:
+                size = img.size
+        except IOError:
+            return
+        self._assets[asset_path] = Asset(asset_path, self, size, path)
+
     def valid_asset(self, asset_path):
         """Verify that a given asset path is valid."""
         return asset_path in self._assets
@@ -325,37 +568,26 @@ class SpriteLoader:
         for asset in self._assets.values():
             asset.empty_cache()
 
-    def _compute_text_size_pos(self, text, font, size, spacing, multiline):
-        fnt = self._load_font(font, size)
-        if multiline:
-            im_sz = fnt.getsize_multiline(text, spacing=spacing)
-            pos = 0, 0
-        else:
-            left, top, right, bottom = fnt.getmask(text).getbbox()
-            pos = fnt.getoffset(text)
-            pos = -(left + pos[0]), -(top + pos[1])
-            im_sz = right - left, bottom - top
-        return im_sz, pos
-
-    def _cache_text(self, text, font, size, color, align, spacing, multiline):
-        # pylint: disable=too-many-arguments
-        k = f'{text}{font}{size}{color}{align}{spacing}{multiline}'
-        if k not in self._sprite_cache:
-            im_sz, pos = self._compute_text_size_pos(text, font, size, spacing,
-                                                     multiline)
-            fnt = self._load_font(font, size)
-            img = Image.new('RGBA', im_sz)
-            draw = ImageDraw.Draw(img)
-            func = draw.multiline_text if multiline else draw.text
-            func(pos, text=text, fill=color, font=fnt, spacing=spacing,
-                 align=align)
-            try:
-                img.tobytes()
-            except SystemError:
-                img = img.crop((0, 0, im_sz[0] - 1, im_sz[1] - 1))
-                print(f'Something went wrong with {k}')
-            self._sprite_cache[k] = _image2sprite(img, self.factory)
-        return self._sprite_cache[k]
+    def _cache_text(self, text, font, size, color, align, spacing, multiline,
+                    wrap):
+        # pylint: disable=too-many-arguments,unused-argument
+        k = f'{text}{font}{size}{color}{align}{spacing}{multiline}{wrap}'
+        sprite = self._sprite_cache.get(k)
+        if sprite is None:
+            color = tuple(color) + (255, ) * (4 - len(color))
+            sdf_font = None
+            if self.sdf_text:
+                sdf_font = self._load_sdf_font(font, text)
+            if sdf_font is not None:
+                arr = sdf_font.render(text, size, spacing, align, color, wrap)
+            else:
+                arr = self._load_glyph_cache(font, size, text).render(
+                    text, spacing, align, color, wrap
+                )
+            img = Image.fromarray(arr, 'RGBA')
+            sprite = self._make_sprite(k, img)
+            self._cache_sprite(k, sprite)
+        return sprite
 
     def _load_font(self, font, size):
         if font not in self._assets:
@@ -364,12 +596,41 @@ class SpriteLoader:
                              f'"{font}".')
         font_k = font, size
         if font_k not in self._font_cache:
-            self._font_cache[font_k] = ImageFont.truetype(
-                os.path.join(self.asset_dir, font),
-                size
-            )
+            if self.archive is not None and font in self.archive:
+                source = self.archive.open(font)
+            else:
+                source = os.path.join(self.asset_dir, font)
+            self._font_cache[font_k] = ImageFont.truetype(source, size)
         return self._font_cache[font_k]
 
+    def _load_glyph_cache(self, font, size, text):
+        """Glyph cache of ``font`` at ``size``, holding the glyphs of text."""
+        font_k = font, size
+        if font_k not in self._glyph_caches:
+            self._glyph_caches[font_k] = textlayout.GlyphCache(size)
+        cache = self._glyph_caches[font_k]
+        if cache.missing(text.replace('\n', '')):
+            textlayout.add_glyphs(cache, self._load_font(font, size), text)
+        return cache
+
+    def _load_sdf_font(self, font, text):
+        """
+        SDF glyph atlas of ``font``, holding at least the glyphs of text.
+        ``None`` if a glyph is too wide for the atlas, the text is then
+        composed from a :class:`~foolysh.tools.text.GlyphCache` instead.
+        """
+        if font not in self._sdf_fonts:
+            self._sdf_fonts[font] = textlayout.SdfFont(SDF_FONT_SIZE)
+        sdf_font = self._sdf_fonts[font]
+        if sdf_font.missing(text.replace('\n', '')):
+            try:
+                textlayout.add_glyphs(sdf_font,
+                                      self._load_font(font, SDF_FONT_SIZE),
+                                      text)
+            except ValueError:
+                return None
+        return sdf_font
+
     def _load_sdf(self, sdf_str):
         """
         Adds the appropriate SDF to the sprite cache.
@@ -382,7 +643,8 @@ class SpriteLoader:
             self.cache_dir,
             f'SDF/{sdf_t}/{cache_name[:2]}/{cache_name[2:]}.png'
         )
-        if path not in self._sprite_cache:
+        sprite = self._sprite_cache.get(path)
+        if sprite is None:
             if not os.path.isfile(path):
                 cache_dir = os.path.split(path)[0]
                 if not os.path.isdir(cache_dir):
@@ -394,13 +656,108 @@ class SpriteLoader:
                 else:
                     raise ValueError(f'Unknown SDF type: "{sdf_t}"')
                 image.save(path)
-                self._sprite_cache[path] = _image2sprite(image, self.factory)
             else:
-                self._sprite_cache[path] = _image2sprite(
-                    Image.open(path),
-                    self.factory
-                )
-        return self._sprite_cache[path]
+                image = Image.open(path)
+            sprite = self._make_sprite(path, image)
+            self._cache_sprite(path, sprite)
+        return sprite
+
+    def pin(self, sprites):
+        """Protect ``sprites`` (e.g. the ones on screen) from eviction."""
+        self._sprite_cache.pin(sprites)
+
+    def trim(self):
+        """
+        Evict sprites until the texture budget is met.
+
+        Returns:
+            ``List`` of evicted sprites, users must drop their references for
+            the textures to be released.
+        """
+        return self._sprite_cache.trim()
+
+    @property
+    def texture_budget(self):
+        """``int`` -> texture memory budget in bytes, ``0`` = unbounded."""
+        return self._sprite_cache.budget
+
+    @texture_budget.setter
+    def texture_budget(self, value):
+        self._sprite_cache.budget = value
+
+    @property
+    def cache_stats(self):
+        """
+        ``Dict[str, int]`` -> texture cache hits, misses, evictions, bytes in
+        use, budget and sprite count.
+        """
+        return self._sprite_cache.stats
+
+    def _cache_sprite(self, key, sprite):
+        nbytes = 0
+        if not isinstance(sprite, AtlasSprite):
+            nbytes = sprite.size[0] * sprite.size[1] * 4
+        self._sprite_cache.put(key, sprite, nbytes)
+
+    def _make_sprite(self, key, image):
+        """
+        Sprite of ``image``, packed into the atlas if enabled and small. Closes
+        ``image`` if it is a :class:`~foolysh.tools.rawcache.RawImage`.
+        """
+        if not isinstance(image, rawcache.RawImage):
+            return self._upload(key, image)
+        try:
+            return self._upload(key, image)
+        finally:
+            image.close()
+
+    def _upload(self, key, image):
+        if self._atlas is None \
+              or max(image.size) > self._atlas.page_size // 2 \
+              or min(image.size) < 1:
+            if isinstance(image, rawcache.RawImage):
+                return _raw2sprite(image, self.factory)
+            return _image2sprite(image, self.factory)
+        entry = self._atlas.insert(key, *image.size)
+        if entry is None:
+            for k in self._atlas.evict_page(self._evict_next):
+                self._sprite_cache.pop(k)
+            self._evict_next = (self._evict_next + 1) % self._atlas.max_pages
+            self.atlas_generation += 1
+            entry = self._atlas.insert(key, *image.size)
+        page, src = entry
+        while len(self._atlas_textures) <= page:
+            self._atlas_textures.append(self._create_atlas_texture())
+        texture = self._atlas_textures[page].texture
+        if isinstance(image, rawcache.RawImage):
+            data, pitch = ctypes.c_void_p(image.address), image.pitch
+        else:
+            data, pitch = image.convert('RGBA').tobytes(), src[2] * 4
+        if render.SDL_UpdateTexture(texture, rect.SDL_Rect(*src), data,
+                                    pitch) != 0:
+            raise SDLError()
+        page_size = self._atlas.page_size
+        return AtlasSprite(texture, page, src, (page_size, page_size))
+
+    def _create_atlas_texture(self):
+        if endian.SDL_BYTEORDER == endian.SDL_LIL_ENDIAN:
+            pformat = pixels.SDL_PIXELFORMAT_ABGR8888  # RGBA byte order
+        else:
+            pformat = pixels.SDL_PIXELFORMAT_RGBA8888
+        size = self._atlas.page_size
+        sprite = self.factory.create_texture_sprite(
+            self.factory.default_args['renderer'],
+            (size, size),
+            pformat=pformat,
+            access=render.SDL_TEXTUREACCESS_STATIC
+        )
+        if render.SDL_SetTextureBlendMode(sprite.texture,
+                                          blendmode.SDL_BLENDMODE_BLEND) != 0:
+            raise SDLError()
+        if render.SDL_UpdateTexture(sprite.texture, None,
+                                    bytes(size * size * 4), size * 4) != 0:
+            raise SDLError()
+        return sprite
 
 
 class Asset:
@@ -410,56 +767,114 @@ class Asset:
     """
     # pylint: disable=too-many-instance-attributes
 
-    def __init__(self, relative_path, parent):
-        # type: (str, SpriteLoader) -> None
+    def __init__(self, relative_path, parent, size=None, abs_path=None):
+        # type: (str, SpriteLoader, Optional[Tuple[int, int]], str) -> None
         self.relative_path = relative_path
         cache_name = hashlib.sha3_224(relative_path.encode()).hexdigest()
         self.cache_sub_dir = os.path.join(parent.cache_dir, cache_name[:2])
         self.cache_prefix = cache_name[2:]
         self.cache_suffix = '.' + relative_path.split('.')[-1]
-        self.abs_path = os.path.join(parent.asset_dir, relative_path)
-        self._img_size = vec2.Point2(Image.open(self.abs_path).size)
-        self._cached_items = {}
+        if parent.raw_cache:
+            self.cache_suffix = '.raw'
+        self.abs_path = abs_path or os.path.join(parent.asset_dir,
+                                                 relative_path)
         self.parent = parent
-        self._refresh_cached()
+        self._archived = abs_path is None and parent.archive is not None
+        if size is None:
+            size = self.open().size
+        self._img_size = vec2.Point2(size)
+        self._cached_items = None
+
+    def open(self):
+        # type: () -> Image.Image
+        """Open the original image."""
+        if self._archived:
+            return self.parent.archive.open_image(self.relative_path)
+        return Image.open(self.abs_path)
 
     def _refresh_cached(self):
-        self._cached_items = {}
-        files = pathlib.Path(self.cache_sub_dir).glob(f'{self.cache_prefix}*')
+        """Scan the cache directory, done lazily on first use."""
+        cached_items = {}
+        files = pathlib.Path(self.cache_sub_dir).glob(
+            f'{self.cache_prefix}*{self.cache_suffix}'
+        )
         files = [str(f) for f in files]
         for file in files:
             res = file.split('.')[-2][-10:]
             res = int(res[:5]), int(res[5:])
-            self._cached_items[res] = file
+            cached_items[res] = file
+        self._cached_items = cached_items
 
     @property
     def size(self):
         """Original image size."""
         return self._img_size
 
+    def scaled_size(self, scale):
+        # type: (SCALE) -> Tuple[int, int]
+        """Pixel size of the image at ``scale``."""
+        if isinstance(scale, float):
+            return int(self.size.x * scale), int(self.size.y * scale)
+        if isinstance(scale, tuple) and len(scale) == 2 and \
+                isinstance(scale[0], float) and isinstance(scale[1], float):
+            return int(self.size.x * scale[0]), int(self.size.y * scale[1])
+        raise TypeError('expected type Union[float, Tuple[float, float]]')
+
+    def cached_path(self, size):
+        # type: (Tuple[int, int]) -> Optional[str]
+        """Path of the cached image of ``size`` or ``None`` if absent."""
+        if self._cached_items is None:
+            self._refresh_cached()
+        return self._cached_items.get(size)
+
     def __getitem__(self, item):
         # type: (SCALE) -> str
-        if isinstance(item, float):
-            k = (int(self.size.x * item), int(self.size.y * item))
-        elif isinstance(item, tuple) and len(item) == 2 and \
-                isinstance(item[0], float) and isinstance(item[1], float):
-            k = (int(self.size.x * item[0]), int(self.size.y * item[1]))
-        else:
-            raise TypeError('expected type Union[float, Tuple[float, float]]')
+        k = self.scaled_size(item)
+        if self._cached_items is None:
+            self._refresh_cached()
         if k not in self._cached_items:
             self._cache(k)
         return self._cached_items[k]
 
     def _cache(self, k):
-        if not os.path.isdir(self.cache_sub_dir):
-            os.makedirs(self.cache_sub_dir)
+        os.makedirs(self.cache_sub_dir, exist_ok=True)
         fname = f'{self.cache_prefix}{k[0]:05d}{k[1]:05d}{self.cache_suffix}'
         pth = os.path.join(self.cache_sub_dir, fname)
-        Image.open(self.abs_path).resize(k, self.parent.resize_type).save(pth)
+        img = self._resize(k)
+        if self.parent.raw_cache:
+            rawcache.write(pth, img, self.parent.raw_compress)
+        else:
+            img.save(pth)
         self._cached_items[k] = pth
 
+    def _resize(self, size):
+        # type: (Tuple[int, int]) -> Image.Image
+        method = _NATIVE_FILTERS.get(self.parent.resize_type)
+        if method is None:
+            return self.open().resize(size, self.parent.resize_type)
+        pixels = self.parent.mip_chain(self).resize(size, method)
+        if pixels[..., 3].min() == 255:
+            # Keep opaque images RGB, smaller to cache and required for JPEG
+            return Image.fromarray(pixels[..., :3], 'RGB')
+        return Image.fromarray(pixels, 'RGBA')
+
+    def load(self, scale):
+        # type: (SCALE) -> Tuple[str, Union[Image.Image, rawcache.RawImage]]
+        """
+        Cache path and decoded image at ``scale``, a mapped
+        :class:`~foolysh.tools.rawcache.RawImage` when using the raw cache.
+        """
+        k = self[scale]
+        if self.parent.raw_cache:
+            return k, rawcache.read(k)
+        img = Image.open(k)
+        img.load()
+        return k, img
+
     def empty_cache(self):
         """Delete all cached files from disk."""
+        if self._cached_items is None:
+            self._refresh_cached()
         for pth in self._cached_items.values():
             os.remove(pth)
         try:
@@ -0,0 +1,285 @@
+# distutils: language = c++
+"""
+Glyph storage and text layout.
+
+:class:`SdfFont` keeps signed distance fields of glyphs rasterized once at a
+reference size. Text of any size is laid out natively and rendered from the
+distance fields, without rasterizing the font again.
+
+:class:`GlyphCache` keeps the glyph bitmaps of one font size and composes text
+from those, only glyphs that were never used before need to be rasterized.
+"""
+
+from libc.stdint cimport uint8_t
+from libcpp.memory cimport unique_ptr
+from cython.operator cimport dereference as deref
+
+from . cimport cpptext
+from .cpptext cimport Bytes, ConstBytes, GlyphMetrics, Rgba, TextLayout
+from .cpptext cimport Align
+
+import numpy as np
+
+__author__ = 'Tiziano Bettio'
+__license__ = 'MIT'
+__version__ = '0.1'
+__copyright__ = """Copyright (c) 2020 Tiziano Bettio
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE."""
+
+_ALIGN = {'left': cpptext.LEFT, 'center': cpptext.CENTER,
+          'right': cpptext.RIGHT}
+
+
+cdef Align _align(align) except *:
+    if align not in _ALIGN:
+        raise ValueError(f'Unknown align "{align}".')
+    return _ALIGN[align]
+
+
+cdef Rgba _rgba(color):
+    cdef Rgba c
+    c.r, c.g, c.b, c.a = color
+    return c
+
+
+cdef Bytes _bytes(out):
+    cdef uint8_t[::1] flat = out.reshape(-1)
+    if flat.shape[0]:
+        return Bytes(&flat[0], flat.shape[0])
+    return Bytes()
+
+
+cdef tuple _image_size(const TextLayout& l):
+    return int(l.width + 0.999), int(l.height + 0.999)
+
+
+cdef class SdfFont:
+    """
+    Signed distance field glyph atlas of one font.
+
+    Args:
+        size: ``int`` -> reference size in pixel, glyphs are added as masks
+            rasterized at this size.
+        spread: ``int`` -> distance in pixel covered by the field on either
+            side of a glyph edge.
+        atlas_size: ``int`` -> width and initial height of the atlas, the
+            height doubles whenever the atlas is full.
+    """
+    cdef unique_ptr[cpptext.SdfFont] thisptr
+
+    def __cinit__(self, int size, int spread=8, int atlas_size=1024):
+        self.thisptr.reset(new cpptext.SdfFont(size, spread, atlas_size))
+
+    def set_metrics(self, int ascent, int descent):
+        """Set ascent and descent in pixel at the reference size."""
+        deref(self.thisptr).set_metrics(ascent, descent)
+
+    def add_glyph(self, str char, double advance, int x, int y, int w, int h,
+                  const uint8_t[::1] mask):
+        """
+        Add a glyph.
+
+        Args:
+            char: ``str`` -> the character.
+            advance: ``float`` -> pen advance in pixel.
+            x: ``int`` -> horizontal offset of the mask from the pen.
+            y: ``int`` -> vertical offset of the mask from the ascender line.
+            w: ``int`` -> mask width.
+            h: ``int`` -> mask height.
+            mask: ``bytes`` -> ``w * h`` coverage values.
+        """
+        cdef GlyphMetrics m
+        m.advance = advance
+        m.x, m.y, m.w, m.h = x, y, w, h
+        cdef ConstBytes b
+        if mask.shape[0]:
+            b = ConstBytes(&mask[0], mask.shape[0])
+        deref(self.thisptr).add_glyph(ord(char), m, b)
+
+    def has_glyph(self, str char):
+        return deref(self.thisptr).has_glyph(ord(char))
+
+    def missing(self, str text):
+        """
+        Returns:
+            ``str`` of the unique characters in ``text`` without a glyph.
+        """
+        return ''.join(chr(i) for i in deref(self.thisptr).missing(
+            [ord(ch) for ch in text]
+        ))
+
+    def measure(self, str text, double size, double spacing=0.0,
+                double wrap=0.0):
+        """
+        Returns:
+            ``Tuple[int, int]`` -> pixel size of ``text`` at ``size``.
+        """
+        cdef TextLayout l = deref(self.thisptr).layout(
+            [ord(ch) for ch in text], size, spacing, cpptext.LEFT, wrap
+        )
+        return _image_size(l)
+
+    def render(self, str text, double size, double spacing=0.0,
+               align='left', color=(255, 255, 255, 255), double wrap=0.0):
+        """
+        Render ``text`` at ``size`` pixel.
+
+        Args:
+            text: ``str`` -> lines separated by "\\n".
+            size: ``float`` -> font size in pixel.
+            spacing: ``float`` -> additional pixel between lines.
+            align: ``str`` -> one of "left", "center" or "right".
+            color: ``Tuple[int, int, int, int]`` -> RGBA color.
+            wrap: ``float`` -> break lines at spaces to fit this width in
+                pixel, if positive.
+
+        Returns:
+            ``np.ndarray`` of shape (`height`, `width`, 4) and dtype ``uint8``.
+        """
+        cdef TextLayout l = deref(self.thisptr).layout(
+            [ord(ch) for ch in text], size, spacing, _align(align), wrap
+        )
+        cdef int w, h
+        w, h = _image_size(l)
+        out = np.zeros((h, w, 4), dtype=np.uint8)
+        deref(self.thisptr).render(l, _bytes(out), w, h, _rgba(color))
+        return out
+
+    @property
+    def size(self):
+        """``int`` -> reference size in pixel."""
+        return deref(self.thisptr).size()
+
+    @property
+    def spread(self):
+        """``int`` -> spread of the distance field in pixel."""
+        return deref(self.thisptr).spread()
+
+    @property
+    def atlas_size(self):
+        """``Tuple[int, int]`` -> current width and height of the atlas."""
+        return (deref(self.thisptr).atlas_size(),
+                deref(self.thisptr).atlas_height())
+
+    @property
+    def glyph_count(self):
+        """``int`` -> number of glyphs."""
+        return deref(self.thisptr).glyph_count()
+
+
+cdef class GlyphCache:
+    """
+    Glyph bitmaps and metrics of one font at one size.
+
+    Args:
+        size: ``int`` -> font size in pixel, glyphs are added as masks
+            rasterized at this size.
+    """
+    cdef unique_ptr[cpptext.GlyphCache] thisptr
+
+    def __cinit__(self, int size):
+        self.thisptr.reset(new cpptext.GlyphCache(size))
+
+    def set_metrics(self, int ascent, int descent):
+        """Set ascent and descent in pixel."""
+        deref(self.thisptr).set_metrics(ascent, descent)
+
+    def add_glyph(self, str char, double advance, int x, int y, int w, int h,
+                  const uint8_t[::1] mask):
+        """Add a glyph, see :meth:`SdfFont.add_glyph`."""
+        cdef GlyphMetrics m
+        m.advance = advance
+        m.x, m.y, m.w, m.h = x, y, w, h
+        cdef ConstBytes b
+        if mask.shape[0]:
+            b = ConstBytes(&mask[0], mask.shape[0])
+        deref(self.thisptr).add_glyph(ord(char), m, b)
+
+    def has_glyph(self, str char):
+        return deref(self.thisptr).has_glyph(ord(char))
+
+    def missing(self, str text):
+        """
+        Returns:
+            ``str`` of the unique characters in ``text`` without a glyph.
+        """
+        return ''.join(chr(i) for i in deref(self.thisptr).missing(
+            [ord(c) for c in text]
+        ))
+
+    def measure(self, str text, double spacing=0.0, double wrap=0.0):
+        """
+        Returns:
+            ``Tuple[int, int]`` -> pixel size of ``text``.
+        """
+        cdef TextLayout l = deref(self.thisptr).layout(
+            [ord(ch) for ch in text], spacing, cpptext.LEFT, wrap
+        )
+        return _image_size(l)
+
+    def render(self, str text, double spacing=0.0, align='left',
+               color=(255, 255, 255, 255), double wrap=0.0):
+        """
+        Render ``text`` from the cached glyphs, see :meth:`SdfFont.render`.
+
+        Returns:
+            ``np.ndarray`` of shape (`height`, `width`, 4) and dtype ``uint8``.
+        """
+        cdef TextLayout l = deref(self.thisptr).layout(
+            [ord(ch) for ch in text], spacing, _align(align), wrap
+        )
+        cdef int w, h
+        w, h = _image_size(l)
+        out = np.zeros((h, w, 4), dtype=np.uint8)
+        deref(self.thisptr).render(l, _bytes(out), w, h, _rgba(color))
+        return out
+
+    @property
+    def size(self):
+        """``int`` -> font size in pixel."""
+        return deref(self.thisptr).size()
+
+    @property
+    def glyph_count(self):
+        """``int`` -> number of glyphs."""
+        return deref(self.thisptr).glyph_count()
+
+    @property
+    def nbytes(self):
+        """``int`` -> bytes used by glyph bitmaps."""
+        return deref(self.thisptr).bytes()
+
+
+def add_glyphs(font, pil_font, str chars):
+    """
+    Rasterize the glyphs of ``chars`` that are not yet present in ``font``.
+
+    Args:
+        font: :class:`SdfFont` or :class:`GlyphCache` -> the target, its size
+            must match the size of ``pil_font``.
+        pil_font: ``PIL.ImageFont.FreeTypeFont`` -> the source font.
+        chars: ``str`` -> characters to add, line breaks are ignored.
+    """
+    if not font.glyph_count:
+        font.set_metrics(*pil_font.getmetrics())
+    for char in font.missing(chars.replace('\n', '')):
+        mask, (x, y) = pil_font.getmask2(char, 'L', anchor='la')
+        w, h = mask.size
+        font.add_glyph(char, pil_font.getlength(char), x, y, w, h, bytes(mask))
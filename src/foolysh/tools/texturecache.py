@@ -0,0 +1,139 @@
+"""
+Provides a bounded least recently used cache for texture sprites.
+"""
+
+from collections import OrderedDict
+from typing import Any
+from typing import Dict
+from typing import Hashable
+from typing import Iterable
+from typing import List
+from typing import Optional
+
+__author__ = 'Tiziano Bettio'
+__license__ = 'MIT'
+__version__ = '0.1'
+__copyright__ = """Copyright (c) 2020 Tiziano Bettio
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE."""
+
+
+class TextureCache:
+    """
+    Maps keys to sprites and keeps track of the texture memory they use. When
+    a ``budget`` in bytes is set, :meth:`trim` evicts the least recently used
+    sprites until the cache fits the budget. Pinned sprites, typically the
+    ones currently on screen, are never evicted.
+
+    Args:
+        budget: ``int`` -> texture memory budget in bytes, ``0`` = unbounded.
+    """
+    def __init__(self, budget=0):
+        # type: (Optional[int]) -> None
+        self.budget = budget
+        self._entries = OrderedDict()  # type: OrderedDict
+        self._pinned = set()
+        self.nbytes = 0
+        self.hits = 0
+        self.misses = 0
+        self.evictions = 0
+
+    def get(self, key):
+        # type: (Hashable) -> Any
+        """
+        Returns the sprite of ``key`` and marks it as most recently used or
+        ``None`` if ``key`` is not cached.
+        """
+        entry = self._entries.get(key)
+        if entry is None:
+            self.misses += 1
+            return None
+        self.hits += 1
+        self._entries.move_to_end(key)
+        return entry[0]
+
+    def peek(self, key):
+        # type: (Hashable) -> Any
+        """Like :meth:`get` without affecting recency or counters."""
+        entry = self._entries.get(key)
+        return None if entry is None else entry[0]
+
+    def put(self, key, sprite, nbytes):
+        # type: (Hashable, Any, int) -> None
+        """Add or replace ``key`` with a sprite that uses ``nbytes``."""
+        self.pop(key)
+        self._entries[key] = sprite, nbytes
+        self.nbytes += nbytes
+
+    def pop(self, key):
+        # type: (Hashable) -> Any
+        """Remove ``key`` and return its sprite or ``None``."""
+        entry = self._entries.pop(key, None)
+        if entry is None:
+            return None
+        self.nbytes -= entry[1]
+        return entry[0]
+
+    def pin(self, sprites):
+        # type: (Iterable[Any]) -> None
+        """Replace the set of sprites that must not be evicted."""
+        self._pinned = {id(sprite) for sprite in sprites}
+
+    def trim(self):
+        # type: () -> List[Any]
+        """
+        Evict least recently used, unpinned sprites until the cache fits the
+        budget. Entries without bytes are kept, they don't free anything.
+
+        Returns:
+            ``List`` of the evicted sprites.
+        """
+        evicted = []
+        if self.budget <= 0 or self.nbytes <= self.budget:
+            return evicted
+        for key, (sprite, nbytes) in list(self._entries.items()):
+            if self.nbytes <= self.budget:
+                break
+            if nbytes == 0 or id(sprite) in self._pinned:
+                continue
+            del self._entries[key]
+            self.nbytes -= nbytes
+            self.evictions += 1
+            evicted.append(sprite)
+        return evicted
+
+    def clear(self):
+        # type: () -> None
+        """Remove all entries, counters are kept."""
+        self._entries.clear()
+        self.nbytes = 0
+
+    @property
+    def stats(self):
+        # type: () -> Dict[str, int]
+        """Hit, miss and eviction counters, memory use and budget."""
+        return {'hits': self.hits, 'misses': self.misses,
+                'evictions': self.evictions, 'bytes': self.nbytes,
+                'budget': self.budget, 'count': len(self._entries)}
+
+    def __contains__(self, key):
+        return key in self._entries
+
+    def __len__(self):
+        return len(self._entries)
@@ -0,0 +1,111 @@
+# distutils: language = c++
+"""
+Test access to ``SoA<char, double, short>``, built by ``test_tools.test_soa``
+through pyximport, so the container can be checked without a public wrapper.
+"""
+
+from libc.stdint cimport uintptr_t
+from libcpp.vector cimport vector
+
+__author__ = 'Tiziano Bettio'
+__license__ = 'MIT'
+__version__ = '0.1'
+__copyright__ = """Copyright (c) 2020 Tiziano Bettio
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE."""
+
+
+cdef extern from "src/soa.hpp" namespace "foolysh::tools":
+    cdef cppclass ColumnView[T]:
+        T* data
+        size_t count
+
+cdef extern from "src/soa.hpp":
+    cdef cppclass SoA "foolysh::tools::SoA<char, double, short>":
+        size_t push_back(char, double, short)
+        void resize(size_t)
+        void reserve(size_t)
+        void swap_remove(size_t) except +
+        size_t compact(bint (*)(size_t) noexcept)
+        void clear()
+        size_t size()
+        size_t capacity()
+        char* column0 "column<0>"()
+        double* column1 "column<1>"()
+        short* column2 "column<2>"()
+        ColumnView[double] view1 "view<1>"()
+
+
+cdef vector[bint] _keep
+
+
+cdef bint _keep_row(size_t n) noexcept:
+    return _keep[n]
+
+
+cdef class Table:
+    """Rows of ``(int, float, int)`` in a native SoA."""
+    cdef SoA thisobj
+
+    def append(self, int a, double b, int c):
+        """Returns: ``int`` -> index of the new row."""
+        return self.thisobj.push_back(<char> a, b, <short> c)
+
+    def resize(self, size_t n):
+        self.thisobj.resize(n)
+
+    def reserve(self, size_t n):
+        self.thisobj.reserve(n)
+
+    def swap_remove(self, size_t n):
+        self.thisobj.swap_remove(n)
+
+    def compact(self, keep):
+        """Keep the rows for which ``keep`` is true, returns the new size."""
+        global _keep
+        _keep = keep
+        return self.thisobj.compact(_keep_row)
+
+    def clear(self):
+        self.thisobj.clear()
+
+    @property
+    def capacity(self):
+        return self.thisobj.capacity()
+
+    @property
+    def addresses(self):
+        """``List[int]`` -> address of each column."""
+        return [<uintptr_t> self.thisobj.column0(),
+                <uintptr_t> self.thisobj.column1(),
+                <uintptr_t> self.thisobj.column2()]
+
+    def view(self):
+        """``Tuple[int, int]`` -> address and size of a view of column 1."""
+        cdef ColumnView[double] v = self.thisobj.view1()
+        return <uintptr_t> v.data, v.count
+
+    def __len__(self):
+        return self.thisobj.size()
+
+    def __getitem__(self, size_t n):
+        if n >= self.thisobj.size():
+            raise IndexError('Invalid row')
+        return (self.thisobj.column0()[n], self.thisobj.column1()[n],
+                self.thisobj.column2()[n])
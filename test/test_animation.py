@@ -224,3 +224,39 @@ def test_depth_animation():
     assert nd.traverse() is True
     assert nd.depth == e
     nd.remove()
+
+
+def test_sequence_recycling():
+    """Verify pooled animation slots are reused and released after playing."""
+    nd = node.Node()
+    aam = animation.AnimationManager()
+    before = aam.pool_stats
+    for _ in range(200):
+        animation.PosInterval(nd, 1.0, vec2.Vec2(0), vec2.Vec2(1))
+    stats = aam.pool_stats
+    assert stats['data_size'] == before['data_size']
+    assert stats['object_size'] == before['object_size']
+    # Each interval released its slots before the next one was created
+    assert stats['data_capacity'] < 200 and stats['object_capacity'] < 200
+    for _ in range(200):
+        animation.PosInterval(nd, 1.0, vec2.Vec2(0), vec2.Vec2(1))
+    assert aam.pool_stats == stats
+
+    seq = animation.Sequence(
+        animation.PosInterval(nd, 1.0, vec2.Vec2(0), vec2.Vec2(1)),
+        animation.PosInterval(nd, 1.0, vec2.Vec2(1), vec2.Vec2(0))
+    )
+    seq.play()
+    playing = aam.pool_stats
+    assert playing['data_size'] > before['data_size']
+    assert playing['object_size'] > before['object_size']
+    aam.animate(1.5)
+    assert nd.traverse() is True
+    assert nd.pos == vec2.Vec2(0.5)
+    aam.animate(0.5)
+    assert nd.traverse() is True
+    assert nd.pos == vec2.Vec2(0)
+    assert seq.status() == 0
+    del seq
+    assert aam.pool_stats == stats
+    nd.remove()
@@ -1,6 +1,9 @@
 """
 Unittests for foolysh.scene
 """
+import ctypes
+import types
+
 # noinspection PyPackageRequirements
 import pytest
 
@@ -41,6 +44,75 @@ def create_empty_nd():
     return nd
 
 
+class _Rect(ctypes.Structure):
+    """``SDL_Rect``."""
+    # pylint: disable=too-few-public-methods
+    _fields_ = [(i, ctypes.c_int) for i in 'xywh']
+
+
+class _Vertex(ctypes.Structure):
+    """``SDL_Vertex``."""
+    # pylint: disable=too-few-public-methods
+    _fields_ = [('x', ctypes.c_float), ('y', ctypes.c_float),
+                ('color', ctypes.c_ubyte * 4),
+                ('u', ctypes.c_float), ('v', ctypes.c_float)]
+
+
+_COPY_EX = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p,
+                            ctypes.POINTER(_Rect), ctypes.POINTER(_Rect),
+                            ctypes.c_double, ctypes.c_void_p, ctypes.c_int)
+_GEOMETRY = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p,
+                             ctypes.POINTER(_Vertex), ctypes.c_int,
+                             ctypes.POINTER(ctypes.c_int), ctypes.c_int)
+
+
+def _rect(ptr):
+    """``SDL_Rect`` pointer as tuple, ``None`` if not set."""
+    return (ptr.contents.x, ptr.contents.y, ptr.contents.w, ptr.contents.h) \
+        if ptr else None
+
+
+def _copy_ex_recorder():
+    """
+    ``SDL_RenderCopyEx`` stand-in, records ``(renderer, texture, src, dst)``
+    in ``calls``. Pass ``address`` to :meth:`DrawList.submit`.
+    """
+    calls = []
+
+    def render_copy(renderer, texture, src, dst, *_):
+        calls.append((renderer, texture, _rect(src), _rect(dst)))
+        return 0
+    callback = _COPY_EX(render_copy)
+    return types.SimpleNamespace(
+        calls=calls, callback=callback,
+        address=ctypes.cast(callback, ctypes.c_void_p).value
+    )
+
+
+def _geometry_recorder():
+    """
+    ``SDL_RenderGeometry`` stand-in, records ``(texture, vertices, indices)``
+    in ``calls`` with vertices as ``(x, y, u, v)``. Pass ``address`` to
+    :meth:`DrawList.submit_geometry`.
+    """
+    calls = []
+
+    def render_geometry(_, texture, vertices, num_vertices, indices,
+                        num_indices):
+        calls.append((
+            texture,
+            [(vertices[i].x, vertices[i].y, vertices[i].u, vertices[i].v)
+             for i in range(num_vertices)],
+            [indices[i] for i in range(num_indices)]
+        ))
+        return 0
+    callback = _GEOMETRY(render_geometry)
+    return types.SimpleNamespace(
+        calls=calls, callback=callback,
+        address=ctypes.cast(callback, ctypes.c_void_p).value
+    )
+
+
 def test_node_relative_pos():
     """Verify relative positioning."""
     nd = create_empty_nd()
@@ -99,6 +171,394 @@ def test_node_dirty():
     nd.remove()
 
 
+def test_node_remove():
+    """Verify subtree removal and querying of a recycled node id."""
+    nd = create_empty_nd()
+    parent = nd.attach_node()
+    child = parent.attach_node()
+    grandchild = child.attach_node()
+    for i in (parent, child, grandchild):
+        i.size = 0.25, 0.25
+    freed = {parent.node_id, grandchild.node_id}
+    child_id = child.node_id
+    parent.remove()
+    assert child.parent_id == child_id
+    del parent, grandchild, i
+    recycled = nd.attach_node()
+    recycled.size = 0.25, 0.25
+    assert recycled.node_id in freed
+    again = recycled.attach_node()
+    again.size = 0.25, 0.25
+    assert again.node_id in freed
+    nd.traverse()
+    result = nd.query(aabb.AABB(0.5, 0.5, 0.5, 0.5))
+    assert len(result) == 3
+    assert recycled in result and again in result
+    assert child_id not in [i.node_id for i in result]
+    assert nd.query(aabb.AABB(0.5, 0.5, 0.5, 0.5)) == result
+    assert recycled.parent_id == nd.node_id
+    nd.remove()
+    assert child.node_id == child_id
+
+
+def test_frame_arena():
+    """Verify scratch memory is released on arena reset."""
+    from foolysh.scene import SGDH
+    nd = create_empty_nd()
+    child = nd
+    for _ in range(300):
+        child = child.attach_node()
+        child.size = 1.0, 1.0
+    assert nd.traverse() is True
+    assert len(nd.query(aabb.AABB(0.5, 0.5, 0.5, 0.5))) == 301
+    stats = SGDH.arena_stats
+    assert stats['used'] == 0
+    assert stats['high_water_mark'] > 0
+    assert stats['capacity'] >= stats['high_water_mark']
+    SGDH.reset_arena()
+    stats = SGDH.arena_stats
+    assert stats['used'] == 0
+    assert stats['blocks'] <= 1
+    nd.remove()
+
+
+def test_fast_trig():
+    """Verify the approximated trigonometry stays close to libm."""
+    from foolysh.scene import SGDH
+    nd = create_empty_nd()
+    child = nd
+    for i in range(20):
+        child = child.attach_node()
+        child.pos = 0.1, 0.2
+        child.size = 1.0, 0.5
+        child.angle = 17.0 * i - 170.0
+    assert nd.traverse() is True
+    precise_pos = child.relative_pos
+    precise_aabb = child.aabb
+    SGDH.fast_trig = True
+    nd.angle = 0.0001
+    nd.angle = 0.0
+    assert nd.traverse() is True
+    fast_pos = child.relative_pos
+    fast_aabb = child.aabb
+    SGDH.fast_trig = False
+    assert fast_pos.x == pytest.approx(precise_pos.x, abs=1e-6)
+    assert fast_pos.y == pytest.approx(precise_pos.y, abs=1e-6)
+    for fast, precise in zip(fast_aabb.pos + fast_aabb.size,
+                             precise_aabb.pos + precise_aabb.size):
+        assert fast == pytest.approx(precise, abs=1e-6)
+    nd.remove()
+
+
+def test_render_column():
+    """Verify the natively computed render rectangles."""
+    from foolysh.scene import SGDH
+    nd = create_empty_nd()
+    child = nd.attach_node()
+    child.pos = 0.25, 0.5
+    child.size = 0.5, 0.25
+    child.scale = 2.0
+    child.angle = 30.0
+    assert nd.traverse() is True
+    SGDH.update_render(100.0, 2.0, 0.1, -0.1)
+    x, y, w, h, c_x, c_y, angle = child.render_rect
+    rel_pos = child.relative_pos
+    assert x == int(0.1 * 200.0) + int(rel_pos.x * 200.0 + 0.5)
+    assert y == int(-0.1 * 200.0) + int(rel_pos.y * 200.0 + 0.5)
+    assert (w, h) == (100, 50)
+    assert (c_x, c_y) == (100, 50)
+    assert angle == pytest.approx(child.relative_angle)
+    child.scale = 0.5
+    assert nd.traverse() is True
+    SGDH.update_render(100.0, 2.0, 0.1, -0.1)
+    assert child.render_rect[2:4] == (25, 13)
+    child.rotation_center = 0.0, 0.0
+    assert nd.traverse() is True
+    SGDH.update_render(100.0, 2.0, 0.1, -0.1)
+    assert child.render_rect[4:6] == (0, 0)
+    nd.remove()
+
+
+def test_draw_list():
+    """Verify building and submitting native draw commands."""
+    from foolysh.scene import SGDH
+    nd = create_empty_nd()
+    first = nd.attach_node()
+    first.size = 0.5, 0.5
+    second = nd.attach_node()
+    second.pos = 0.25, 0.25
+    second.size = 0.5, 0.25
+    second.depth = 1
+    assert nd.traverse() is True
+    SGDH.update_render(100.0, 1.0, 0.0, 0.0)
+    draw_list = node.DrawList()
+    draw_list.set_texture(first.node_id, 0x1000, 50, 50)
+    draw_list.build(nd, aabb.AABB(0.5, 0.5, 1.0, 1.0))
+    missing = [i.node_id for i in draw_list.missing]
+    assert second.node_id in missing and first.node_id not in missing
+    assert len(draw_list) == 1
+    for n_id in missing:
+        draw_list.set_texture(n_id, 0, 0, 0)
+    draw_list.set_texture(second.node_id, 0x2000, 8, 4, fixed_size=True,
+                          src=(1, 2, 8, 4))
+    draw_list.clear()
+    draw_list.build(nd, aabb.AABB(0.5, 0.5, 1.0, 1.0))
+    assert not draw_list.missing
+    order = [i.node_id for i in nd.query(aabb.AABB(0.5, 0.5, 1.0, 1.0))]
+    assert [draw_list[i]['node_id'] for i in range(len(draw_list))] == [
+        i for i in order if i in (first.node_id, second.node_id)
+    ]
+    assert draw_list.node_ids == [draw_list[i]['node_id']
+                                  for i in range(len(draw_list))]
+    i_first = 0 if draw_list[0]['node_id'] == first.node_id else 1
+    assert draw_list[i_first]['dst'] == first.render_rect[:4]
+    assert draw_list[i_first]['src'] == (0, 0, 0, 0)
+    assert draw_list[1 - i_first]['dst'] == second.render_rect[:2] + (8, 4)
+    assert draw_list[1 - i_first]['src'] == (1, 2, 8, 4)
+    with pytest.raises(IndexError):
+        draw_list[2]
+    assert draw_list[-1] == draw_list[1]
+    assert list(draw_list) == [draw_list[0], draw_list[1]]
+
+    recorder = _copy_ex_recorder()
+    assert draw_list.submit(0x42, recorder.address) == 0
+    expected = [
+        (0x42, 0x1000, None, first.render_rect[:4]),
+        (0x42, 0x2000, (1, 2, 8, 4), second.render_rect[:2] + (8, 4))
+    ]
+    assert recorder.calls == (expected if i_first == 0 else expected[::-1])
+
+    # Scale changes after registering apply to the texture, not fixed sizes
+    first.scale = 2.0
+    second.scale = 2.0
+    nd.traverse()
+    SGDH.update_render(100.0, 1.0, 0.0, 0.0)
+    draw_list.clear()
+    draw_list.build(nd, aabb.AABB(0.5, 0.5, 1.0, 1.0))
+    dst = {draw_list[i]['node_id']: draw_list[i]['dst']
+           for i in range(len(draw_list))}
+    assert dst[first.node_id][2:] == (100, 100)
+    assert dst[second.node_id][2:] == (8, 4)
+    draw_list.remove_texture(first.node_id)
+    assert not draw_list.has_texture(first.node_id)
+    nd.remove()
+
+
+def test_draw_list_geometry():
+    """Verify quads and batches submitted through the geometry path."""
+    from foolysh.scene import SGDH
+
+    nd = create_empty_nd()
+    nodes = []
+    for i in range(4):
+        child = nd.attach_node()
+        child.pos = 0.1 * i, 0.0
+        child.size = 0.2, 0.1
+        nodes.append(child)
+    nodes[3].angle = 90.0
+    assert nd.traverse() is True
+    SGDH.update_render(100.0, 1.0, 0.0, 0.0)
+    draw_list = node.DrawList()
+    draw_list.set_texture(nd.node_id, 0, 0, 0)
+    textures = {}
+    for i, child in enumerate(nodes):
+        textures[child.node_id] = 0x1000 if i < 2 else 0x2000
+        draw_list.set_texture(child.node_id, textures[child.node_id], 20, 10,
+                              flip=1 if i == 1 else 0, src=(0, 10, 20, 10),
+                              tex_size=(40, 20))
+    draw_list.build(nd, aabb.AABB(0.5, 0.5, 1.0, 1.0))
+    order = [draw_list[i]['node_id'] for i in range(len(draw_list))]
+    runs = [textures[order[0]]]
+    for n_id in order[1:]:
+        if textures[n_id] != runs[-1]:
+            runs.append(textures[n_id])
+
+    recorder = _geometry_recorder()
+    assert draw_list.submit_geometry(0x42, recorder.address) == 0
+    assert [i[0] for i in recorder.calls] == runs
+    assert draw_list.batch_count == len(runs)
+    quads = {}
+    for _, vertices, indices in recorder.calls:
+        assert len(indices) == len(vertices) // 4 * 6
+        assert max(indices) == len(vertices) - 1
+        for i in range(0, len(vertices), 4):
+            quads[len(quads)] = vertices[i:i + 4]
+    quads = {order[i]: quads[i] for i in quads}
+
+    x, y, w, h = draw_list[order.index(nodes[0].node_id)]['dst']
+    assert quads[nodes[0].node_id] == [(x, y, 0.0, 0.5),
+                                       (x + w, y, 0.5, 0.5),
+                                       (x, y + h, 0.0, 1.0),
+                                       (x + w, y + h, 0.5, 1.0)]
+    assert [i[2] for i in quads[nodes[1].node_id]] == [0.5, 0.0, 0.5, 0.0]
+    cmd = draw_list[order.index(nodes[3].node_id)]
+    x, y, w, h = cmd['dst']
+    c_x, c_y = cmd['center']
+    top_left = quads[nodes[3].node_id][0]
+    assert top_left[0] == pytest.approx(x + c_x + c_y)
+    assert top_left[1] == pytest.approx(y + c_y - c_x)
+    nd.remove()
+
+
+def test_draw_list_damage():
+    """Verify damage tracking and clipped submits of DrawList."""
+    from foolysh.scene import SGDH
+
+    nd = create_empty_nd()
+    left = nd.attach_node()
+    left.size = 0.1, 0.1
+    right = nd.attach_node()
+    right.pos = 0.5, 0.5
+    right.size = 0.1, 0.1
+    draw_list = node.DrawList()
+    draw_list.set_texture(nd.node_id, 0, 0, 0)
+    for i in (left, right):
+        draw_list.set_texture(i.node_id, 0x1000, 10, 10)
+    view = aabb.AABB(0.5, 0.5, 1.0, 1.0)
+
+    def update():
+        nd.traverse()
+        SGDH.update_render(100.0, 1.0, 0.0, 0.0)
+        draw_list.clear()
+        draw_list.build(nd, view)
+        return draw_list.update_damage()
+
+    assert update() == (0, 0, 60, 60)
+    assert update() is None
+    left.pos = 0.2, 0.0
+    assert update() == (0, 0, 30, 10)
+    cmd = [draw_list[i] for i in range(len(draw_list))
+           if draw_list[i]['node_id'] == right.node_id][0]
+    assert cmd['bounds'] == (50, 50, 10, 10)
+    right.angle = 45.0
+    x, y, w, h = update()
+    assert x < 50 and y < 50 and x + w > 60 and y + h > 60
+    right.hide()
+    assert update() == (x, y, w, h)
+    draw_list.remove_texture(left.node_id)
+    draw_list.set_texture(left.node_id, 0x1000, 10, 10)
+    assert update() == (20, 0, 10, 10)
+
+    recorder = _copy_ex_recorder()
+    assert draw_list.submit(0x42, recorder.address, clip=(15, 0, 10, 10)) == 0
+    assert [i[3] for i in recorder.calls] == [(20, 0, 10, 10)]
+    nd.remove()
+
+
+def test_draw_list_cache():
+    """Verify cache as bitmap invalidation and drawing from the cache."""
+    from foolysh.scene import SGDH
+
+    nd = create_empty_nd()
+    panel = nd.attach_node()
+    panel.pos = 0.1, 0.1
+    panel.size = 0.3, 0.3
+    children = []
+    for i in range(3):
+        child = panel.attach_node()
+        child.pos = 0.1 * i, 0.0
+        child.size = 0.1, 0.1
+        children.append(child)
+    assert panel.cache_as_bitmap is False
+    panel.cache_as_bitmap = True
+    assert panel.cache_valid is False
+    draw_list = node.DrawList()
+    draw_list.set_texture(nd.node_id, 0, 0, 0)
+    draw_list.set_texture(panel.node_id, 0x1000, 30, 30)
+    for i in children:
+        draw_list.set_texture(i.node_id, 0x1000, 10, 10)
+    view = aabb.AABB(0.5, 0.5, 1.0, 1.0)
+
+    def update():
+        nd.traverse()
+        SGDH.update_render(100.0, 1.0, 0.0, 0.0)
+        draw_list.clear()
+        draw_list.build(nd, view)
+        return [draw_list[i]['node_id'] for i in range(len(draw_list))]
+
+    assert len(update()) == 4
+    assert [i.node_id for i in draw_list.stale_caches] == [panel.node_id]
+    draw_list.clear()
+    draw_list.build(panel, aabb.AABB(0.0, 0.0, 1e9, 1e9), False)
+    assert len(draw_list) == 4
+    assert draw_list.extent() == (10, 10, 30, 30)
+    draw_list.translate(-10, -10)
+    assert draw_list.extent() == (0, 0, 30, 30)
+    draw_list.set_cache(panel.node_id, 0x2000, (0, 0, 30, 30))
+    panel.validate_cache()
+    assert panel.cache_valid is True
+
+    assert update() == [panel.node_id]
+    assert draw_list.stale_caches == []
+    assert draw_list[0]['texture'] == 0x2000
+    assert draw_list[0]['dst'] == (10, 10, 30, 30)
+
+    panel.pos = 0.2, 0.1
+    assert update() == [panel.node_id]
+    assert panel.cache_valid is True
+    assert draw_list[0]['dst'] == (20, 10, 30, 30)
+    children[0].pos = 0.05, 0.0
+    assert panel.cache_valid is False
+    panel.validate_cache()
+    children[1].hide()
+    assert panel.cache_valid is False
+    panel.validate_cache()
+    SGDH.invalidate_cache(children[2].node_id)
+    assert panel.cache_valid is False
+    panel.validate_cache()
+    sibling = nd.attach_node()
+    draw_list.set_texture(sibling.node_id, 0, 0, 0)
+    sibling.pos = 0.5, 0.5
+    assert update() == [panel.node_id]
+    assert panel.cache_valid is True
+    panel.cache_as_bitmap = False
+    assert len(update()) == 3
+    nd.remove()
+
+
+def test_draw_list_tiled():
+    """Verify tiled textures are repeated across the node on submit."""
+    from foolysh.scene import SGDH
+
+    nd = create_empty_nd()
+    tiled = nd.attach_node()
+    tiled.size = 0.25, 0.1
+    assert nd.traverse() is True
+    SGDH.update_render(100.0, 1.0, 0.0, 0.0)
+    draw_list = node.DrawList()
+    draw_list.set_texture(nd.node_id, 0, 0, 0)
+    with pytest.raises(ValueError):
+        draw_list.set_texture(tiled.node_id, 0x1000, 0, 4, tiled=True)
+    draw_list.set_texture(tiled.node_id, 0x1000, 10, 4, src=(20, 0, 10, 4),
+                          tex_size=(40, 8), tiled=True)
+    draw_list.build(nd, aabb.AABB(0.5, 0.5, 1.0, 1.0))
+    assert len(draw_list) == 1 and draw_list[0]['tile'] == (10, 4)
+    x, y, w, h = draw_list[0]['dst']
+    assert (w, h) == (25, 10)
+
+    recorder = _copy_ex_recorder()
+    calls = recorder.calls
+    assert draw_list.submit(0x42, recorder.address) == 0
+    assert len(calls) == 9 and all(i[1] == 0x1000 for i in calls)
+    assert calls[0][2:] == ((20, 0, 10, 4), (x, y, 10, 4))
+    assert calls[2][2:] == ((20, 0, 5, 4), (x + 20, y, 5, 4))
+    assert calls[8][2:] == ((20, 0, 5, 2), (x + 20, y + 8, 5, 2))
+
+    calls.clear()
+    assert draw_list.submit(0x42, recorder.address, (x + 21, y, 4, 4)) == 0
+    assert [i[3] for i in calls] == [(x + 20, y, 5, 4)]
+
+    recorder = _geometry_recorder()
+    assert draw_list.submit_geometry(0x42, recorder.address) == 0
+    assert draw_list.batch_count == 1
+    texture, vertices, indices = recorder.calls[0]
+    assert (texture, len(vertices), len(indices)) == (0x1000, 36, 54)
+    uvs = [i[2:] for i in vertices]
+    assert uvs[:4] == [(0.5, 0.0), (0.75, 0.0), (0.5, 0.5), (0.75, 0.5)]
+    assert uvs[8:12] == [(0.5, 0.0), (0.625, 0.0), (0.5, 0.5), (0.625, 0.5)]
+    nd.remove()
+
+
 def test_grid_layout():
     """Verify GridLayout."""
     nd = create_empty_nd()
@@ -3,14 +3,27 @@ Unittests for foolysh.tools
 """
 
 import math
+import os
+import threading
 import time
+import types
 
+import numpy as np
 import pytest
 
 from foolysh.tools import vec2
 from foolysh.tools import aabb
+from foolysh.tools import archive
+from foolysh.tools import atlas
+from foolysh.tools import batch
 from foolysh.tools import clock
+from foolysh.tools import freelist
 from foolysh.tools import quadtree
+from foolysh.tools import rawcache
+from foolysh.tools import resample
+from foolysh.tools import sdfraster
+from foolysh.tools import text
+from foolysh.tools import texturecache
 
 __author__ = 'Tiziano Bettio'
 __license__ = 'MIT'
@@ -93,6 +106,206 @@ def test_quadtree():
     assert obj_a in result
 
 
+def test_quadtree_resize():
+    """Verify resize keeps exactly the live elements."""
+    qt = quadtree.Quadtree(aabb.AABB(0.0, 0.0, 1.0, 1.0), 2, 8)
+    boxes = {i: aabb.AABB(-0.9 + 0.018 * i, 0.9 - 0.018 * i, 0.005, 0.005)
+             for i in range(100)}
+    for i, box in boxes.items():
+        assert qt.insert(i, box) is True
+    for i in range(0, 100, 3):
+        assert qt.remove(i, boxes.pop(i)) is True
+    qt.resize(aabb.AABB(0.0, 0.0, 2.0, 2.0))
+    assert sorted(qt.query(aabb.AABB(0.0, 0.0, 2.0, 2.0))) == sorted(boxes)
+    assert qt.query(boxes[50]) == [50]
+    qt.insert(200, aabb.AABB(1.5, 1.5, 0.1, 0.1))
+    assert qt.query(aabb.AABB(1.5, 1.5, 0.2, 0.2)) == [200]
+
+
+def test_concurrent_free_list():
+    """Verify unique and reused indices of ConcurrentFreeList across threads."""
+    lst = freelist.ConcurrentFreeList()
+    results = [None] * 8
+    barrier = threading.Barrier(8)
+
+    def work(tag):
+        # Values are checked before their batch is erased again
+        mismatches = 0
+        held = []
+        barrier.wait()
+        for i in range(20003):
+            held.append((lst.insert(tag * 20003 + i), tag * 20003 + i))
+            if len(held) < 16:
+                continue
+            for n, value in held:
+                mismatches += lst[n] != value
+                lst.erase(n)
+            held.clear()
+        mismatches += sum(lst[n] != value for n, value in held)
+        results[tag] = mismatches, [n for n, _ in held]
+
+    threads = [threading.Thread(target=work, args=(i, )) for i in range(8)]
+    for i in threads:
+        i.start()
+    for i in threads:
+        i.join()
+    assert [mismatches for mismatches, _ in results] == [0] * 8
+    held = [n for _, indices in results for n in indices]
+    assert len(held) == len(set(held)) == 8 * (20003 % 16)
+    assert all(lst.active(n) for n in held)
+    # At most 16 live and one in flight per thread, so indices were reused
+    assert lst.range <= 8 * 17
+    for n in held:
+        lst.erase(n)
+    with pytest.raises(IndexError):
+        lst.erase(held[0])
+    with pytest.raises(IndexError):
+        lst[held[0]]
+    size = lst.range
+    indices = [lst.insert(i) for i in range(size)]
+    assert sorted(indices) == list(range(size))
+    assert lst.range == size
+    assert [lst[n] for n in indices] == list(range(size))
+
+
+def test_soa(tmp_path):
+    """Verify row removal, growth and column layout of the native SoA."""
+    pyximport = pytest.importorskip('pyximport')
+    importers = pyximport.install(build_dir=str(tmp_path), language_level=3)
+    try:
+        import soa_wrapper  # pylint: disable=import-outside-toplevel
+    finally:
+        pyximport.uninstall(*importers)
+    table = soa_wrapper.Table()
+    assert len(table) == 0 and table.capacity == 0
+    for i in range(5):
+        assert table.append(i, i * 0.5, -i) == i
+
+    # The last row moves into the removed one
+    table.swap_remove(1)
+    assert [table[i] for i in range(len(table))] == [
+        (0, 0.0, 0), (4, 2.0, -4), (2, 1.0, -2), (3, 1.5, -3)
+    ]
+    table.swap_remove(3)
+    assert len(table) == 3 and table[2] == (2, 1.0, -2)
+    with pytest.raises(ArithmeticError):
+        table.swap_remove(3)
+
+    # Order of the kept rows is preserved
+    assert table.compact([True, False, True]) == 2
+    assert [table[i] for i in range(len(table))] == [(0, 0.0, 0),
+                                                     (2, 1.0, -2)]
+    table.clear()
+    assert len(table) == 0 and table.capacity == 16
+
+    # All columns are aligned and grow together in one allocation
+    def fill(n):
+        while len(table) < n:
+            table.append(len(table), len(table) * 0.25, -len(table))
+
+    for capacity in (16, 32, 64):
+        fill(capacity // 2 + 1)
+        addresses = table.addresses
+        assert all(i % 32 == 0 for i in addresses)
+        assert addresses[1] - addresses[0] == (capacity + 31) // 32 * 32
+        assert addresses[2] - addresses[1] == capacity * 8
+        assert table.capacity == capacity
+        fill(capacity)
+        assert table.addresses == addresses
+
+    # Views keep pointing to the released allocation after growth
+    view = table.view()
+    assert view == (table.addresses[1], 64)
+    table.append(1, 2.0, 3)
+    assert table.capacity == 128
+    assert table.view() == (table.addresses[1], 65)
+    assert table.view()[0] != view[0]
+    assert [table[i] for i in (0, 63, 64)] == [(0, 0.0, 0), (63, 15.75, -63),
+                                               (1, 2.0, 3)]
+    table.resize(130)
+    assert table.capacity == 256 and table[129] == (0, 0.0, 0)
+    table.reserve(16)
+    assert table.capacity == 256 and len(table) == 130
+
+
+@pytest.mark.parametrize('level', ['scalar', 'avx'])
+def test_batch(level):
+    """Verify batch Vec2 and AABB operations against the scalar types."""
+    batch.set_simd_level(level)
+    rng = np.random.default_rng(7)
+    pts_a = rng.uniform(-10, 10, (13, 2))
+    pts_b = rng.uniform(-10, 10, (13, 2))
+    pts_a[3] = 0.0
+    assert np.allclose(batch.add(pts_a, pts_b), pts_a + pts_b)
+    assert np.allclose(batch.scale(pts_a, 2.5), pts_a * 2.5)
+    assert np.allclose(batch.lerp(pts_a, pts_b, 0.25),
+                       pts_a + (pts_b - pts_a) * 0.25)
+    lengths = np.linalg.norm(pts_a, axis=1)[:, None]
+    expected = np.divide(pts_a, lengths, out=pts_a.copy(), where=lengths > 0)
+    assert np.allclose(batch.normalize(pts_a), expected)
+    rotated = batch.rotate(pts_a, 30.0, center=(1.0, 2.0))
+    for (x, y), res in zip(pts_a, rotated):
+        v = vec2.Vec2(x - 1.0, y - 2.0)
+        v.rotate(30.0)
+        assert res[0] == pytest.approx(v.x + 1.0)
+        assert res[1] == pytest.approx(v.y + 2.0)
+    out = pts_a.copy()
+    assert batch.add(out, pts_b, out=out) is out
+    assert np.allclose(out, pts_a + pts_b)
+
+    boxes = np.column_stack([rng.uniform(-5, 5, (11, 2)),
+                             rng.uniform(0.1, 2, (11, 2))])
+    query = aabb.AABB(0.5, -0.5, 1.5, 1.0)
+    expected = [aabb.AABB(*b).overlap(query) for b in boxes]
+    assert batch.overlap(boxes, query).tolist() == expected
+    expected = [aabb.AABB(*b).inside_tup(1.0, 1.0) for b in boxes]
+    assert batch.contains(boxes, 1.0, 1.0).tolist() == expected
+    bounds = batch.union(boxes)
+    lo = (boxes[:, :2] - boxes[:, 2:]).min(axis=0)
+    hi = (boxes[:, :2] + boxes[:, 2:]).max(axis=0)
+    assert np.allclose(np.array(bounds.pos) - bounds.size, lo)
+    assert np.allclose(np.array(bounds.pos) + bounds.size, hi)
+    angles = np.linspace(-50.0, 50.0, 1001)
+    sin, cos = batch.sin_cos(angles)
+    assert np.allclose(sin, np.sin(angles), rtol=0.0, atol=1e-7)
+    assert np.allclose(cos, np.cos(angles), rtol=0.0, atol=1e-7)
+    assert batch.add(np.empty((0, 2)), np.empty((0, 2))).shape == (0, 2)
+    with pytest.raises(ValueError):
+        batch.add(pts_a, pts_b[:4])
+    with pytest.raises(ValueError):
+        batch.union(np.empty((0, 4)))
+    batch.set_simd_level('avx')
+
+
+def test_atlas():
+    """Verify skyline packing, rectangle reuse and page eviction."""
+    packer = atlas.SkylinePacker(64, 64)
+    rects = [packer.insert(16, 16) for _ in range(16)]
+    assert None not in rects
+    assert packer.insert(1, 1) is None
+    assert packer.used_area == 64 * 64
+    for i, (x_a, y_a, w_a, h_a) in enumerate(rects):
+        for x_b, y_b, w_b, h_b in rects[i + 1:]:
+            assert x_a + w_a <= x_b or x_b + w_b <= x_a \
+                or y_a + h_a <= y_b or y_b + h_b <= y_a
+
+    tex_atlas = atlas.Atlas(page_size=32, max_pages=2, padding=0)
+    assert tex_atlas.insert('big', 33, 8) is None
+    assert tex_atlas.insert('a', 32, 16) == (0, (0, 0, 32, 16))
+    assert tex_atlas.insert('b', 32, 16) == (0, (0, 16, 32, 16))
+    assert tex_atlas.insert('c', 16, 16)[0] == 1
+    with pytest.raises(ValueError):
+        tex_atlas.insert('a', 1, 1)
+    assert tex_atlas.remove('a')
+    assert 'a' not in tex_atlas
+    assert tex_atlas.insert('d', 16, 8) == (0, (0, 0, 16, 8))
+    assert tex_atlas.occupancy(0) == pytest.approx(0.625)
+    assert tex_atlas.insert('e', 32, 32) is None
+    assert sorted(tex_atlas.evict_page(0)) == ['b', 'd']
+    assert tex_atlas.insert('e', 32, 32) == (0, (0, 0, 32, 32))
+    assert len(tex_atlas) == 2 and tex_atlas.page_count == 2
+
+
 def test_clock():
     clk = clock.Clock()
     clk.tick()
@@ -105,3 +318,361 @@ def test_clock():
     clk.tick()
     stop = time.perf_counter()
     assert pytest.approx(clk.get_time(), stop - start)
+
+
+@pytest.mark.parametrize('level', ['scalar', 'avx'])
+def test_sdfraster(level):
+    """Verify the native SDF rasterizer."""
+    sdfraster.set_simd_level(level)
+    img = sdfraster.box(300, 200, 20.0, 4.0, (10, 20, 30, 255),
+                        (200, 100, 50, 128), threads=1)
+    assert img.shape == (200, 300, 4)
+    assert img[100, 150].tolist() == [10, 20, 30, 255]
+    assert img[0, 0, 3] == 0
+    assert img[100, 1].tolist() == [200, 100, 50, 128]
+    assert img[0, 150].tolist() == [200, 100, 50, 128]
+    assert np.array_equal(img, img[::-1, ::-1])
+    threaded = sdfraster.box(300, 200, 20.0, 4.0, (10, 20, 30, 255),
+                             (200, 100, 50, 128), threads=4)
+    assert np.array_equal(img, threaded)
+    pre = sdfraster.box(300, 200, 20.0, 4.0, (10, 20, 30, 255),
+                        (200, 100, 50, 128), premultiplied=True)
+    assert pre[100, 1].tolist() == [100, 50, 25, 128]
+
+    img = sdfraster.circle(50, fill=(255, 0, 0, 255))
+    assert img.shape == (100, 100, 4)
+    assert img[50, 50].tolist() == [255, 0, 0, 255]
+    assert img[2, 2, 3] == 0
+    inside = img[..., 3] == 255
+    assert abs(inside.sum() - math.pi * 50 ** 2) < 2 * math.pi * 50
+
+    with pytest.raises(ValueError):
+        sdfraster.box(0, 10)
+    sdfraster.set_simd_level('avx')
+
+
+def test_sdf_text():
+    """Verify SDF glyph atlases and native text rendering."""
+    from PIL import ImageFont
+    path = os.path.join(os.path.dirname(__file__), '..', 'samples', 'assets',
+                        'fonts', 'SpaceMono.ttf')
+    pil_font = ImageFont.truetype(path, 64)
+    font = text.SdfFont(64)
+    text.add_glyphs(font, pil_font, 'Hi there\nHI')
+    assert font.glyph_count == 8
+    assert font.missing('Hit!') == '!'
+    ascent, descent = pil_font.getmetrics()
+    w, h = font.measure('HI', 64)
+    assert w == math.ceil(pil_font.getlength('HI'))
+    assert h == ascent + descent
+    w2, h2 = font.measure('HI', 32)
+    assert abs(w2 - w / 2) <= 1 and abs(h2 - h / 2) <= 1
+    assert abs(font.measure('HI\nHI', 32, spacing=4)[1] - (h + 4)) <= 1
+
+    img = font.render('H', 64, color=(255, 0, 0, 255))
+    ref = np.frombuffer(bytes(pil_font.getmask2('H', 'L', anchor='la')[0]),
+                        np.uint8)
+    assert img.shape[:2] == (h, math.ceil(pil_font.getlength('H')))
+    assert (img[..., :3][img[..., 3] > 0] == (255, 0, 0)).all()
+    coverage = (img[..., 3] > 127).sum()
+    assert abs(coverage - (ref > 127).sum()) < 0.05 * coverage
+    small = font.render('H', 16)
+    assert 0 < (small[..., 3] > 127).sum() < coverage / 8
+    right = font.render('H\nHI', 64, align='right')
+    assert right[h // 2, -5, 3] > 0 and right[h // 2, 5, 3] == 0
+    with pytest.raises(ValueError):
+        font.render('H', 16, align='justify')
+
+    # A full atlas grows in height, glyphs keep their position
+    small_atlas = text.SdfFont(64, atlas_size=128)
+    text.add_glyphs(small_atlas, pil_font, 'H')
+    assert small_atlas.atlas_size == (128, 128)
+    chars = 'ABCDEFGHIJKLMNOPQRSTUVWXYZ'
+    text.add_glyphs(small_atlas, pil_font, chars)
+    assert small_atlas.glyph_count == len(chars)
+    width, height = small_atlas.atlas_size
+    assert width == 128 and height > 128 and height % 128 == 0
+    text.add_glyphs(font, pil_font, chars)
+    assert np.array_equal(small_atlas.render(chars, 32),
+                          font.render(chars, 32))
+    with pytest.raises(ValueError):
+        text.SdfFont(64, atlas_size=32).add_glyph('W', 40.0, 0, 0, 30, 30,
+                                                  bytes(900))
+
+
+def test_glyph_cache():
+    """Verify cached glyph bitmaps, line breaking and alignment."""
+    from PIL import ImageFont
+    path = os.path.join(os.path.dirname(__file__), '..', 'samples', 'assets',
+                        'fonts', 'SpaceMono.ttf')
+    pil_font = ImageFont.truetype(path, 20)
+    cache = text.GlyphCache(20)
+    text.add_glyphs(cache, pil_font, 'ab cd')
+    assert cache.glyph_count == 5
+    assert cache.nbytes > 0
+    ascent, descent = pil_font.getmetrics()
+    adv = pil_font.getlength('a')
+    w, h = cache.measure('ab cd')
+    assert w == math.ceil(adv * 5) and h == ascent + descent
+
+    img = cache.render('a', color=(0, 255, 0, 200))
+    mask, (x, y) = pil_font.getmask2('a', 'L', anchor='la')
+    mask = np.frombuffer(bytes(mask), np.uint8).reshape(mask.size[::-1])
+    region = img[y:y + mask.shape[0], x:x + mask.shape[1], 3]
+    assert np.array_equal(region, (mask.astype(int) * 200 + 127) // 255)
+    assert img[..., 3].sum() == region.sum()
+
+    assert cache.measure('ab cd', wrap=adv * 3) == (math.ceil(adv * 2),
+                                                   2 * (ascent + descent))
+    assert cache.measure('abcd', wrap=adv * 3)[1] == 2 * (ascent + descent)
+    assert cache.measure('ab\ncd', spacing=5)[1] == 2 * (ascent + descent) + 5
+    wrapped = cache.render('ab cd', align='right', wrap=adv * 3)
+    assert np.array_equal(wrapped, cache.render('ab\ncd', align='right'))
+    centered = cache.render('abcd\na', align='center')
+    assert centered[ascent + descent:, :int(adv * 1.5), 3].sum() == 0
+    assert centered[ascent + descent:, int(adv * 1.5):, 3].sum() > 0
+
+    # Masks offset to the right of the pen
+    offset = text.GlyphCache(8)
+    offset.set_metrics(4, 1)
+    mask = np.arange(10, 70, 10, dtype=np.uint8)
+    offset.add_glyph('x', 6.0, 2, 1, 3, 2, mask.tobytes())
+    img = offset.render('xx', color=(255, 255, 255, 255))
+    expected = np.zeros((5, 12), dtype=np.uint8)
+    expected[1:3, 2:5] = expected[1:3, 8:11] = mask.reshape(2, 3)
+    assert np.array_equal(img[..., 3], expected)
+
+
+def test_texture_cache():
+    """Verify LRU eviction, pinning and counters of TextureCache."""
+    cache = texturecache.TextureCache(budget=100)
+    sprites = {k: object() for k in 'abcde'}
+    for k in 'abc':
+        assert cache.get(k) is None
+        cache.put(k, sprites[k], 40)
+    assert cache.nbytes == 120 and len(cache) == 3
+    assert cache.get('a') is sprites['a']
+    assert cache.trim() == [sprites['b']]
+    assert 'b' not in cache and cache.nbytes == 80
+
+    cache.put('d', sprites['d'], 40)
+    cache.put('e', sprites['e'], 0)
+    cache.pin([sprites['c'], sprites['a']])
+    assert cache.trim() == [sprites['d']]
+    cache.put('b', sprites['b'], 60)
+    cache.pin([sprites['c'], sprites['a'], sprites['b']])
+    assert cache.trim() == []
+    assert cache.nbytes == 140
+    cache.pin([])
+    assert cache.trim() == [sprites['c']]
+    assert 'e' in cache and cache.peek('b') is sprites['b']
+    assert cache.stats == {'hits': 1, 'misses': 3, 'evictions': 3,
+                           'bytes': 100, 'budget': 100, 'count': 3}
+    assert cache.pop('b') is sprites['b'] and cache.nbytes == 40
+    cache.budget = 0
+    cache.put('a', sprites['a'], 1000)
+    assert cache.trim() == []
+
+
+def test_async_upload(tmp_path, monkeypatch):
+    """Verify decoding on worker threads and budgeted uploads."""
+    sdl2_ext = pytest.importorskip('sdl2.ext')
+    from PIL import Image
+    from foolysh.tools import spriteloader
+
+    uploads = []
+
+    def image2sprite(image, factory):
+        # pylint: disable=unused-argument
+        uploads.append(image.size)
+        return types.SimpleNamespace(size=image.size, texture=None, flip=0)
+
+    monkeypatch.setattr(spriteloader, '_image2sprite', image2sprite)
+    asset_dir = tmp_path / 'assets'
+    asset_dir.mkdir()
+    for i, size in enumerate(((64, 32), (32, 64), (48, 48))):
+        Image.new('RGBA', size, (i * 80, 0, 0, 128)) \
+            .save(str(asset_dir / f'img{i}.png'))
+    data = (asset_dir / 'img0.png').read_bytes()
+    (asset_dir / 'broken.png').write_bytes(data[:len(data) // 2])
+    loader = spriteloader.SpriteLoader(
+        sdl2_ext.SpriteFactory(sdl2_ext.SOFTWARE), str(asset_dir),
+        str(tmp_path / 'cache'), async_workers=2, upload_budget=1
+    )
+    executor = loader._executor  # pylint: disable=protected-access
+    submit = executor.submit
+    submitted = []
+
+    def count_submit(fn, asset, scale):
+        submitted.append(asset.relative_path)
+        return submit(fn, asset, scale)
+
+    monkeypatch.setattr(executor, 'submit', count_submit)
+    assets = [f'img{i}.png' for i in range(3)]
+
+    # Pending images already report their final size
+    sizes = [loader.imagesize(i, 0.5) for i in assets]
+    assert sizes == [(32, 16), (16, 32), (24, 24)]
+    assert loader.load_image_async(assets[0], 0.5) is None
+    assert loader.load_image_async(assets[0], 0.5) is None
+    assert loader.pending == 1
+    deadline = time.perf_counter() + 10.0
+    while not loader.upload_pending():
+        assert time.perf_counter() < deadline
+        time.sleep(0.01)
+    assert loader.pending == 0
+    assert loader.load_image_async(assets[0], 0.5).size == sizes[0]
+    assert uploads == sizes[:1]
+
+    # Each call uploads at least one image, even above the budget
+    for i in assets[1:]:
+        assert loader.load_image_async(i, 0.5) is None
+        assert loader.load_image_async(i, 0.5) is None
+    while loader.pending:
+        assert time.perf_counter() < deadline
+        uploaded = loader.upload_pending()
+        assert uploaded in (0, 1)
+        if uploaded:
+            assert len(uploads) == 3 - loader.pending
+        else:
+            time.sleep(0.01)
+    assert loader.upload_pending() == 0
+    assert sorted(uploads) == sorted(sizes)
+    assert [loader.load_image_async(i, 0.5).size for i in assets] == sizes
+    assert sorted(submitted) == assets
+
+    # Decode errors are reported per job and not scheduled again
+    assert loader.load_image_async('broken.png', 0.5) is None
+    assert loader.load_image_async(assets[2], 1.0) is None
+    with pytest.warns(UserWarning, match='broken.png'):
+        while loader.pending:
+            assert time.perf_counter() < deadline
+            loader.upload_pending()
+            time.sleep(0.01)
+    assert list(loader.failed) == [('broken.png', (32, 16))]
+    assert loader.load_image_async('broken.png', 0.5) is None
+    assert loader.pending == 0
+    assert loader.load_image_async(assets[2], 1.0).size == (48, 48)
+
+
+def test_raw_cache(tmp_path):
+    """Verify writing and mapping raw pixel cache files."""
+    from PIL import Image
+    img = Image.new('RGBA', (3, 2))
+    img.putdata([(i, 2 * i, 3 * i, 255 - i) for i in range(6)])
+    path = str(tmp_path / 'img.raw')
+    rawcache.write(path, img)
+    assert os.path.getsize(path) == rawcache.PAGE_SIZE + 3 * 2 * 4
+    raw = rawcache.read(path)
+    assert raw.size == (3, 2) and raw.pitch == 12
+    assert raw.address % rawcache.PAGE_SIZE == 0
+    assert bytes(raw.pixels) == img.tobytes()
+    assert raw.to_image().tobytes() == img.tobytes()
+    raw.close()
+    assert raw.pixels is None
+
+    rawcache.write(path, img.convert('RGB'), compress=True)
+    raw = rawcache.read(path)
+    assert bytes(raw.pixels) == img.convert('RGB').convert('RGBA').tobytes()
+    raw.close()
+
+    # Threads writing the same file don't share a temporary file
+    threads = [threading.Thread(target=rawcache.write, args=(path, img))
+               for _ in range(8)]
+    for i in threads:
+        i.start()
+    for i in threads:
+        i.join()
+    raw = rawcache.read(path)
+    assert bytes(raw.pixels) == img.tobytes()
+    raw.close()
+    assert os.listdir(str(tmp_path)) == ['img.raw']
+
+    with open(path, 'wb') as fhandle:
+        fhandle.write(b'\x89PNG' + bytes(100))
+    with pytest.raises(ValueError):
+        rawcache.read(path)
+
+
+@pytest.mark.parametrize('method', ['box', 'bilinear', 'bicubic', 'lanczos'])
+def test_resample(method):
+    """Verify native resampling against PIL and the mip chain."""
+    from PIL import Image
+    filters = {'box': Image.BOX, 'bilinear': Image.BILINEAR,
+               'bicubic': Image.BICUBIC, 'lanczos': Image.LANCZOS}
+    ys, xs = np.mgrid[0:67, 0:93]
+    src = np.empty((67, 93, 4), dtype=np.uint8)
+    src[..., 0] = xs * 255 // 92
+    src[..., 1] = ys * 255 // 66
+    src[..., 2] = (xs + ys) * 255 // 158
+    src[..., 3] = 255
+    img = Image.fromarray(src, 'RGBA')
+    for size in ((31, 20), (93, 67), (150, 101)):
+        out = resample.resize(src, size, method, threads=2)
+        assert out.shape == (size[1], size[0], 4)
+        ref = np.asarray(img.resize(size, filters[method]), dtype=np.int16)
+        assert np.abs(out.astype(np.int16) - ref).max() <= 2
+    assert np.array_equal(resample.resize(img, (93, 67), method), src)
+
+    # Transparent pixels must not bleed their color into opaque ones
+    half = np.zeros((8, 8, 4), dtype=np.uint8)
+    half[:, :4] = (255, 0, 0, 255)
+    half[:, 4:] = (0, 255, 0, 0)
+    out = resample.resize(half, (3, 3), method)
+    assert out[1, 0, 1] == 0 and out[1, 0, 0] == 255
+
+    # Upscaled constant images stay constant, also when output pixel centers
+    # land on source pixel edges
+    flat = np.full((2, 2, 4), (200, 100, 50, 255), dtype=np.uint8)
+    for size in ((3, 3), (5, 5), (3, 1), (7, 2)):
+        out = resample.resize(flat, size, method)
+        assert (out == (200, 100, 50, 255)).all()
+
+    chain = resample.MipChain(src)
+    assert chain.size == (93, 67)
+    assert chain.level(2).shape == (16, 23, 4)
+    assert chain.level(50).shape == (1, 1, 4)
+    assert chain.nbytes > src.nbytes
+    out = chain.resize((10, 7), method)
+    assert out.shape == (7, 10, 4)
+    ref = np.asarray(img.resize((10, 7), filters[method]), dtype=np.int16)
+    assert np.abs(out.astype(np.int16) - ref).mean() < 4
+
+    with pytest.raises(ValueError):
+        resample.resize(src, (0, 5))
+    with pytest.raises(ValueError):
+        resample.resize(src, (5, 5), 'nearest')
+    with pytest.raises(ValueError):
+        resample.resize(src[..., :3], (5, 5))
+
+
+def test_archive(tmp_path):
+    """Verify packing assets and reading them through the archive index."""
+    from PIL import Image
+    asset_dir = tmp_path / 'assets'
+    (asset_dir / 'images').mkdir(parents=True)
+    Image.new('RGBA', (5, 3), (1, 2, 3, 4)).save(
+        str(asset_dir / 'images' / 'a.png')
+    )
+    Image.new('RGB', (2, 7)).save(str(asset_dir / 'b.jpg'))
+    (asset_dir / 'font.ttf').write_bytes(b'not really a font')
+    (asset_dir / 'notes.txt').write_text('ignored')
+    path = str(tmp_path / 'assets.fpk')
+    assert archive.main([str(asset_dir), path]) == 0
+
+    arc = archive.Archive(path)
+    assert sorted(arc.entries) == ['b.jpg', 'font.ttf', 'images/a.png']
+    entry = arc.entries['images/a.png']
+    assert entry.size == (5, 3) and entry.format == 'PNG'
+    assert entry.offset % 16 == 0
+    assert arc.entries['b.jpg'].size == (2, 7)
+    assert arc.entries['font.ttf'].format == 'font'
+    assert arc.read('font.ttf') == b'not really a font'
+    img = arc.open_image('images/a.png')
+    assert img.size == (5, 3) and img.getpixel((4, 2)) == (1, 2, 3, 4)
+    assert 'notes.txt' not in arc and len(arc) == 3
+    arc.close()
+
+    with pytest.raises(ValueError):
+        archive.Archive(str(asset_dir / 'b.jpg'))
+    assert archive.main([str(tmp_path / 'missing'), path]) == 1